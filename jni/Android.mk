@@ -74,13 +74,24 @@ LOCAL_SRC_FILES :=  \
                     $(OPENAL_DIR)/Alc/alcRing.c              \
                     $(OPENAL_DIR)/Alc/alcThread.c            \
                     $(OPENAL_DIR)/Alc/ALu.c                  \
+                    $(OPENAL_DIR)/Alc/fpmath.c               \
                     $(OPENAL_DIR)/Alc/bs2b.c                 \
                     $(OPENAL_DIR)/Alc/null.c                 \
                     $(OPENAL_DIR)/Alc/panning.c              \
                     $(OPENAL_DIR)/Alc/mixer.c                \
+                    $(OPENAL_DIR)/Alc/mixthreads.c           \
                     $(OPENAL_DIR)/Alc/audiotrack.c           \
 
 
+# Vector mixers, picked at device open from the CPU features
+ifeq ($(TARGET_ARCH_ABI),armeabi-v7a)
+  LOCAL_SRC_FILES += $(OPENAL_DIR)/Alc/mixer_neon.c.neon
+endif
+ifeq ($(TARGET_ARCH_ABI),x86)
+  LOCAL_SRC_FILES += $(OPENAL_DIR)/Alc/mixer_sse.c
+endif
+LOCAL_STATIC_LIBRARIES += cpufeatures
+
 # If building for versions after FROYO
 ifeq ($(POST_FROYO), yes)
   LOCAL_CFLAGS +=   -DPOST_FROYO -I$(ANDROID_NDK_ROOT)/platforms/android-9/arch-arm/usr/include/
@@ -103,3 +114,4 @@ endif
 
 include $(BUILD_SHARED_LIBRARY)
 
+$(call import-module,android/cpufeatures)
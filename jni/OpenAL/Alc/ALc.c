@@ -25,6 +25,12 @@
 #include <stdio.h>
 #include <memory.h>
 #include <ctype.h>
+#ifndef _WIN32
+#include <sched.h>
+#endif
+#ifdef HAVE_MALLOC_H
+#include <malloc.h>
+#endif
 
 #include "alMain.h"
 #include "alSource.h"
@@ -183,11 +189,18 @@ static const ALCfunction alcFunctions[] = {
     { "alSourcePause",              (ALCvoid *) alSourcePause            },
     { "alSourceQueueBuffers",       (ALCvoid *) alSourceQueueBuffers     },
     { "alSourceUnqueueBuffers",     (ALCvoid *) alSourceUnqueueBuffers   },
+    { "alSourcesfvSOFT",            (ALCvoid *) alSourcesfvSOFT          },
+    { "alGetSourcesfvSOFT",         (ALCvoid *) alGetSourcesfvSOFT       },
+    { "alGetSourcesivSOFT",         (ALCvoid *) alGetSourcesivSOFT       },
     { "alGenBuffers",               (ALCvoid *) alGenBuffers             },
     { "alDeleteBuffers",            (ALCvoid *) alDeleteBuffers          },
     { "alIsBuffer",                 (ALCvoid *) alIsBuffer               },
     { "alBufferData",               (ALCvoid *) alBufferData             },
-    { "alBufferDataStatic",         (ALCvoid *) alBufferData             },
+    { "alBufferDataStatic",         (ALCvoid *) alBufferDataStatic       },
+    { "alBufferMapFileSOFT",        (ALCvoid *) alBufferMapFileSOFT      },
+    { "alBufferMapPathSOFT",        (ALCvoid *) alBufferMapPathSOFT      },
+    { "alBufferCallbackSOFT",       (ALCvoid *) alBufferCallbackSOFT     },
+    { "alBufferDataAsyncSOFT",      (ALCvoid *) alBufferDataAsyncSOFT    },
     { "alBufferf",                  (ALCvoid *) alBufferf                },
     { "alBuffer3f",                 (ALCvoid *) alBuffer3f               },
     { "alBufferfv",                 (ALCvoid *) alBufferfv               },
@@ -204,6 +217,8 @@ static const ALCfunction alcFunctions[] = {
     { "alDopplerVelocity",          (ALCvoid *) alDopplerVelocity        },
     { "alSpeedOfSound",             (ALCvoid *) alSpeedOfSound           },
     { "alDistanceModel",            (ALCvoid *) alDistanceModel          },
+    { "alDeferUpdatesSOFT",         (ALCvoid *) alDeferUpdatesSOFT       },
+    { "alProcessUpdatesSOFT",       (ALCvoid *) alProcessUpdatesSOFT     },
 
     { "alGenFilters",               (ALCvoid *) alGenFilters             },
     { "alDeleteFilters",            (ALCvoid *) alDeleteFilters          },
@@ -365,8 +380,15 @@ static ALCenum g_eLastNullDeviceError = ALC_NO_ERROR;
 static const ALchar alExtList[] =
     "AL_EXT_DOUBLE AL_EXT_EXPONENT_DISTANCE AL_EXT_FLOAT32 AL_EXT_IMA4 "
     "AL_EXT_LINEAR_DISTANCE AL_EXT_MCFORMATS AL_EXT_MULAW "
-    "AL_EXT_MULAW_MCFORMATS AL_EXT_OFFSET AL_EXT_source_distance_model "
-    "AL_LOKI_quadriphonic AL_SOFT_buffer_sub_data AL_SOFT_loop_points";
+    "AL_EXT_MULAW_MCFORMATS AL_EXT_OFFSET AL_EXT_STATIC_BUFFER "
+    "AL_EXT_source_distance_model AL_LOKI_quadriphonic AL_SOFT_async_buffer "
+    "AL_SOFT_buffer_preresample AL_SOFT_buffer_sub_data "
+    "AL_SOFT_callback_buffer AL_SOFT_deferred_updates AL_SOFT_loop_points "
+    "AL_SOFT_source_arrays"
+#ifdef HAVE_MMAP
+    " AL_SOFT_mapped_buffer"
+#endif
+    ;
 
 // Mixing Priority Level
 static ALint RTPrioLevel;
@@ -430,6 +452,7 @@ static void alc_init(void)
     ReadALConfig();
 
     tls_create(&LocalContext);
+    InitBufferResampler();
 
     RTPrioLevel = GetConfigValueInt(NULL, "rt-prio", 0);
 
@@ -548,6 +571,8 @@ static void alc_deinit(void)
 
     tls_delete(LocalContext);
 
+    ReleaseBufferLoader();
+
     FreeALConfig();
     ALTHUNK_EXIT();
     DeleteCriticalSection(&g_csMutex);
@@ -682,112 +707,181 @@ void SetRTPriority(void)
 }
 
 
+/*
+    al_calloc
+
+    Allocates zeroed memory with the given power-of-2 alignment. Must be
+    released with al_free.
+*/
+void *al_calloc(size_t alignment, size_t size)
+{
+    void *ret;
+
+#if defined(_WIN32)
+    ret = _aligned_malloc(size, alignment);
+#elif defined(HAVE_POSIX_MEMALIGN)
+    if(posix_memalign(&ret, alignment, size) != 0)
+        ret = NULL;
+#elif defined(HAVE_MALLOC_H)
+    ret = memalign(alignment, size);
+#else
+    ret = malloc(size);
+#endif
+    if(ret)
+        memset(ret, 0, size);
+    return ret;
+}
+
+void al_free(void *ptr)
+{
+#if defined(_WIN32)
+    _aligned_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+
 void InitUIntMap(UIntMap *map)
 {
     map->array = NULL;
     map->size = 0;
     map->maxsize = 0;
+    map->index = NULL;
+    map->indexmask = 0;
 }
 
 void ResetUIntMap(UIntMap *map)
 {
     free(map->array);
-    map->array = NULL;
-    map->size = 0;
-    map->maxsize = 0;
+    free(map->index);
+    InitUIntMap(map);
+}
+
+static __inline ALuint HashUIntKey(ALuint key)
+{
+    // Keys are object pointers or thunk names; spread the bits that differ
+    key ^= key >> 16;
+    key *= 0x45d9f3b;
+    key ^= key >> 16;
+    return key;
+}
+
+/* Returns the index slot holding the key, or the empty one it would go in */
+static ALuint FindUIntMapSlot(const UIntMap *map, ALuint key)
+{
+    ALuint slot = HashUIntKey(key) & map->indexmask;
+
+    while(map->index[slot] >= 0 && map->array[map->index[slot]].key != key)
+        slot = (slot+1) & map->indexmask;
+    return slot;
 }
 
 ALenum InsertUIntMapEntry(UIntMap *map, ALuint key, ALvoid *value)
 {
-    ALsizei pos = 0;
+    ALuint slot;
 
     if(map->size > 0)
     {
-        ALsizei low = 0;
-        ALsizei high = map->size - 1;
-        while(low < high)
+        slot = FindUIntMapSlot(map, key);
+        if(map->index[slot] >= 0)
         {
-            ALsizei mid = low + (high-low)/2;
-            if(map->array[mid].key < key)
-                low = mid + 1;
-            else
-                high = mid;
+            map->array[map->index[slot]].value = value;
+            return AL_NO_ERROR;
         }
-        if(map->array[low].key < key)
-            low++;
-        pos = low;
     }
 
-    if(pos == map->size || map->array[pos].key != key)
+    if(map->size == map->maxsize)
     {
-        if(map->size == map->maxsize)
+        ALvoid *temp;
+        ALint *index;
+        ALsizei newsize;
+        ALsizei i;
+
+        newsize = (map->maxsize ? (map->maxsize<<1) : 4);
+        if(newsize < map->maxsize || (ALuint)newsize > 0x3fffffff)
+            return AL_OUT_OF_MEMORY;
+
+        index = malloc(newsize*2 * sizeof(map->index[0]));
+        if(!index) return AL_OUT_OF_MEMORY;
+        temp = realloc(map->array, newsize*sizeof(map->array[0]));
+        if(!temp)
         {
-            ALvoid *temp;
-            ALsizei newsize;
-
-            newsize = (map->maxsize ? (map->maxsize<<1) : 4);
-            if(newsize < map->maxsize)
-                return AL_OUT_OF_MEMORY;
-
-            temp = realloc(map->array, newsize*sizeof(map->array[0]));
-            if(!temp) return AL_OUT_OF_MEMORY;
-            map->array = temp;
-            map->maxsize = newsize;
+            free(index);
+            return AL_OUT_OF_MEMORY;
         }
-
-        map->size++;
-        if(pos < map->size-1)
-            memmove(&map->array[pos+1], &map->array[pos],
-                    (map->size-1-pos)*sizeof(map->array[0]));
+        map->array = temp;
+        map->maxsize = newsize;
+
+        free(map->index);
+        map->index = index;
+        map->indexmask = newsize*2 - 1;
+        for(i = 0;i < newsize*2;i++)
+            map->index[i] = -1;
+        for(i = 0;i < map->size;i++)
+            map->index[FindUIntMapSlot(map, map->array[i].key)] = i;
     }
-    map->array[pos].key = key;
-    map->array[pos].value = value;
+
+    slot = FindUIntMapSlot(map, key);
+    map->index[slot] = map->size;
+    map->array[map->size].key = key;
+    map->array[map->size].value = value;
+    map->size++;
 
     return AL_NO_ERROR;
 }
 
 void RemoveUIntMapKey(UIntMap *map, ALuint key)
 {
-    if(map->size > 0)
+    ALuint slot, next, home;
+    ALsizei pos, last;
+
+    if(map->size == 0)
+        return;
+
+    slot = FindUIntMapSlot(map, key);
+    pos = map->index[slot];
+    if(pos < 0)
+        return;
+
+    // Close the gap in the index by pulling back any entries that probed
+    // past it
+    next = slot;
+    while(1)
     {
-        ALsizei low = 0;
-        ALsizei high = map->size - 1;
-        while(low < high)
-        {
-            ALsizei mid = low + (high-low)/2;
-            if(map->array[mid].key < key)
-                low = mid + 1;
-            else
-                high = mid;
-        }
-        if(map->array[low].key == key)
-        {
-            if(low < map->size-1)
-                memmove(&map->array[low], &map->array[low+1],
-                        (map->size-1-low)*sizeof(map->array[0]));
-            map->size--;
-        }
+        next = (next+1) & map->indexmask;
+        if(map->index[next] < 0)
+            break;
+
+        home = HashUIntKey(map->array[map->index[next]].key) & map->indexmask;
+        if((slot <= next) ? (slot < home && home <= next) :
+                            (slot < home || home <= next))
+            continue;
+
+        map->index[slot] = map->index[next];
+        slot = next;
+    }
+    map->index[slot] = -1;
+
+    // Move the last entry into the hole left in the array
+    last = map->size-1;
+    if(pos != last)
+    {
+        map->index[FindUIntMapSlot(map, map->array[last].key)] = pos;
+        map->array[pos] = map->array[last];
     }
+    map->size--;
 }
 
 ALvoid *LookupUIntMapKey(UIntMap *map, ALuint key)
 {
-    if(map->size > 0)
-    {
-        ALsizei low = 0;
-        ALsizei high = map->size - 1;
-        while(low < high)
-        {
-            ALsizei mid = low + (high-low)/2;
-            if(map->array[mid].key < key)
-                low = mid + 1;
-            else
-                high = mid;
-        }
-        if(map->array[low].key == key)
-            return map->array[low].value;
-    }
-    return NULL;
+    ALint pos;
+
+    if(map->size == 0)
+        return NULL;
+
+    pos = map->index[FindUIntMapSlot(map, key)];
+    return ((pos >= 0) ? map->array[pos].value : NULL);
 }
 
 
@@ -954,7 +1048,8 @@ ALCvoid alcSetError(ALCdevice *device, ALenum errorCode)
 
 /* UpdateDeviceParams:
  *
- * Updates device parameters according to the attribute list.
+ * Updates device parameters according to the attribute list. Called with the
+ * device locked.
  */
 static ALCboolean UpdateDeviceParams(ALCdevice *device, const ALCint *attrList)
 {
@@ -971,12 +1066,13 @@ static ALCboolean UpdateDeviceParams(ALCdevice *device, const ALCint *attrList)
     if(attrList && attrList[0])
     {
         // If a context is already running on the device, stop playback so the
-        // device attributes can be updated
+        // device attributes can be updated. The mixer needs the device lock
+        // to finish its update, so let go of it meanwhile.
         if(running)
         {
-            ProcessContext(NULL);
+            UnlockDevice(device);
             ALCdevice_StopPlayback(device);
-            SuspendContext(NULL);
+            LockDevice(device);
             running = AL_FALSE;
         }
 
@@ -1039,21 +1135,20 @@ static ALCboolean UpdateDeviceParams(ALCdevice *device, const ALCint *attrList)
         device->PendingClicks[i] = int2ALfp(0);
     }
 
+    // The effect slots and the sources' sends are only changed with the
+    // device held as well, so the contexts don't need locking. Waiting on
+    // them here could deadlock with an app thread waiting on the mixer.
     for(i = 0;i < device->NumContexts;i++)
     {
         ALCcontext *context = device->Contexts[i];
         ALsizei pos;
 
-        SuspendContext(context);
         for(pos = 0;pos < context->EffectSlotMap.size;pos++)
         {
             ALeffectslot *slot = context->EffectSlotMap.array[pos].value;
 
             if(ALEffect_DeviceUpdate(slot->EffectState, device) == AL_FALSE)
-            {
-                ProcessContext(context);
                 return ALC_FALSE;
-            }
             ALEffect_Update(slot->EffectState, context, &slot->effect);
         }
 
@@ -1072,7 +1167,6 @@ static ALCboolean UpdateDeviceParams(ALCdevice *device, const ALCint *attrList)
             }
             source->NeedsUpdate = AL_TRUE;
         }
-        ProcessContext(context);
     }
 
     if(device->Bs2bLevel > 0 && device->Bs2bLevel <= 6)
@@ -1107,12 +1201,15 @@ static ALCboolean UpdateDeviceParams(ALCdevice *device, const ALCint *attrList)
 /*
     SuspendContext
 
-    Thread-safe entry
+    Thread-safe entry. With no context, locks the global device and context
+    lists; nothing may be waited on while holding that.
 */
 ALCvoid SuspendContext(ALCcontext *pContext)
 {
-    (void)pContext;
-    EnterCriticalSection(&g_csMutex);
+    if(pContext)
+        EnterCriticalSection(&pContext->Mutex);
+    else
+        EnterCriticalSection(&g_csMutex);
 }
 
 
@@ -1123,21 +1220,31 @@ ALCvoid SuspendContext(ALCcontext *pContext)
 */
 ALCvoid ProcessContext(ALCcontext *pContext)
 {
-    (void)pContext;
-    LeaveCriticalSection(&g_csMutex);
+    if(pContext)
+        LeaveCriticalSection(&pContext->Mutex);
+    else
+        LeaveCriticalSection(&g_csMutex);
 }
 
 
+static __inline void YieldThread(void)
+{
+#ifdef _WIN32
+    Sleep(0);
+#else
+    sched_yield();
+#endif
+}
+
 /*
-    GetContextSuspended
+    GetCurrentContext
 
-    Returns the currently active Context, in a locked state
+    Returns the calling thread's context, or the global one. Must be called
+    with the lists locked.
 */
-ALCcontext *GetContextSuspended(void)
+static ALCcontext *GetCurrentContext(void)
 {
-    ALCcontext *pContext = NULL;
-
-    SuspendContext(NULL);
+    ALCcontext *pContext;
 
     pContext = tls_get(LocalContext);
     if(pContext && !IsContext(pContext))
@@ -1148,15 +1255,84 @@ ALCcontext *GetContextSuspended(void)
     if(!pContext)
         pContext = GlobalContext;
 
-    if(pContext)
-        SuspendContext(pContext);
+    return pContext;
+}
+
+/*
+    GetContextSuspended
+
+    Returns the currently active Context, in a locked state. The context's
+    lock is only tried while the lists are held, which keeps it from being
+    destroyed underneath us; if someone else has it, back off and retry.
+*/
+ALCcontext *GetContextSuspended(void)
+{
+    ALCcontext *pContext;
 
+    while(1)
+    {
+        SuspendContext(NULL);
+        pContext = GetCurrentContext();
+        if(!pContext || TryEnterCriticalSection(&pContext->Mutex))
+            break;
+        ProcessContext(NULL);
+        YieldThread();
+    }
     ProcessContext(NULL);
 
     return pContext;
 }
 
 
+/*
+    GetContextLocked
+
+    Like GetContextSuspended, but also holds the context's device so the
+    mixer is kept out. For calls that change what the mixer is reading, or
+    the objects shared across the device. Release with UnlockContext.
+*/
+ALCcontext *GetContextLocked(void)
+{
+    ALCcontext *pContext;
+    ALCdevice *pDevice;
+
+    while(1)
+    {
+        SuspendContext(NULL);
+        pContext = GetCurrentContext();
+        pDevice = (pContext ? pContext->Device : NULL);
+        ProcessContext(NULL);
+        if(!pContext)
+            return NULL;
+
+        // The device outlives its contexts, and is only closed once the app
+        // is done with them. It's let go again while waiting on the context,
+        // since whoever has that may need the device to finish.
+        LockDevice(pDevice);
+        SuspendContext(NULL);
+        if(GetCurrentContext() == pContext && pContext->Device == pDevice &&
+           TryEnterCriticalSection(&pContext->Mutex))
+        {
+            ProcessContext(NULL);
+            // Anything queued for the mixer happened before this call
+            ProcessSourceCommands(pContext);
+            return pContext;
+        }
+        ProcessContext(NULL);
+        UnlockDevice(pDevice);
+        YieldThread();
+    }
+}
+
+ALCvoid UnlockContext(ALCcontext *pContext)
+{
+    ALCdevice *pDevice = pContext->Device;
+
+    ProcessContext(pContext);
+    UnlockDevice(pDevice);
+}
+
+
 /*
     InitContext
 
@@ -1164,6 +1340,8 @@ ALCcontext *GetContextSuspended(void)
 */
 static ALvoid InitContext(ALCcontext *pContext)
 {
+    InitializeCriticalSection(&pContext->Mutex);
+
     //Initialise listener
     pContext->Listener.Gain = int2ALfp(1);
     pContext->Listener.MetersPerUnit = int2ALfp(1);
@@ -1193,6 +1371,9 @@ static ALvoid InitContext(ALCcontext *pContext)
     pContext->DopplerFactor = int2ALfp(1);
     pContext->DopplerVelocity = int2ALfp(1);
     pContext->flSpeedOfSound = float2ALfp(SPEEDOFSOUNDMETRESPERSEC);
+    pContext->UpdateGen = 0;
+    pContext->ListenerGen = 0;
+    pContext->DeferUpdates = AL_FALSE;
     pContext->PrioritySlots = 0;
 
     pContext->ExtensionList = alExtList;
@@ -1208,6 +1389,8 @@ static ALCvoid ExitContext(ALCcontext *pContext)
 {
     //Invalidate context
     pContext->LastError = AL_NO_ERROR;
+
+    DeleteCriticalSection(&pContext->Mutex);
 }
 
 ///////////////////////////////////////////////////////
@@ -1750,12 +1933,17 @@ ALC_API ALCcontext* ALC_APIENTRY alcCreateContext(ALCdevice *device, const ALCin
     ALCcontext *ALContext;
     void *temp;
 
-    SuspendContext(NULL);
+    if(!IsDevice(device) || device->IsCaptureDevice)
+    {
+        alcSetError(device, ALC_INVALID_DEVICE);
+        return NULL;
+    }
 
-    if(!IsDevice(device) || device->IsCaptureDevice || !device->Connected)
+    LockDevice(device);
+    if(!device->Connected)
     {
         alcSetError(device, ALC_INVALID_DEVICE);
-        ProcessContext(NULL);
+        UnlockDevice(device);
         return NULL;
     }
 
@@ -1766,7 +1954,7 @@ ALC_API ALCcontext* ALC_APIENTRY alcCreateContext(ALCdevice *device, const ALCin
     {
         alcSetError(device, ALC_INVALID_DEVICE);
         aluHandleDisconnect(device);
-        ProcessContext(NULL);
+        UnlockDevice(device);
         ALCdevice_StopPlayback(device);
         return NULL;
     }
@@ -1789,7 +1977,7 @@ ALC_API ALCcontext* ALC_APIENTRY alcCreateContext(ALCdevice *device, const ALCin
     {
         free(ALContext);
         alcSetError(device, ALC_OUT_OF_MEMORY);
-        ProcessContext(NULL);
+        UnlockDevice(device);
         if(device->NumContexts == 0)
             ALCdevice_StopPlayback(device);
         return NULL;
@@ -1800,12 +1988,14 @@ ALC_API ALCcontext* ALC_APIENTRY alcCreateContext(ALCdevice *device, const ALCin
 
     InitContext(ALContext);
 
+    SuspendContext(NULL);
     ALContext->next = g_pContextList;
     g_pContextList = ALContext;
     g_ulContextCount++;
-
     ProcessContext(NULL);
 
+    UnlockDevice(device);
+
     return ALContext;
 }
 
@@ -1832,11 +2022,31 @@ ALC_API ALCvoid ALC_APIENTRY alcDestroyContext(ALCcontext *context)
     if(Device->NumContexts == 1)
         ALCdevice_StopPlayback(Device);
 
-    SuspendContext(NULL);
+    // Lock the device, then the context. Whoever has the context may be
+    // waiting on the device, so let it go again until the context is free.
+    while(1)
+    {
+        LockDevice(Device);
+        if(TryEnterCriticalSection(&context->Mutex))
+            break;
+        UnlockDevice(Device);
+        Sleep(1);
+    }
 
+    // Unlisted while its lock is held, so anyone still trying for it will
+    // notice it's gone
+    SuspendContext(NULL);
     if(context == GlobalContext)
         GlobalContext = NULL;
 
+    list = &g_pContextList;
+    while(*list != context)
+        list = &(*list)->next;
+
+    *list = (*list)->next;
+    g_ulContextCount--;
+    ProcessContext(NULL);
+
     for(i = 0;i < Device->NumContexts;i++)
     {
         if(Device->Contexts[i] == context)
@@ -1847,9 +2057,6 @@ ALC_API ALCvoid ALC_APIENTRY alcDestroyContext(ALCcontext *context)
         }
     }
 
-    // Lock context
-    SuspendContext(context);
-
     if(context->SourceMap.size > 0)
     {
 #ifdef _DEBUG
@@ -1873,16 +2080,9 @@ ALC_API ALCvoid ALC_APIENTRY alcDestroyContext(ALCcontext *context)
     context->MaxActiveSources = 0;
     context->ActiveSourceCount = 0;
 
-    list = &g_pContextList;
-    while(*list != context)
-        list = &(*list)->next;
-
-    *list = (*list)->next;
-    g_ulContextCount--;
-
     // Unlock context
     ProcessContext(context);
-    ProcessContext(NULL);
+    UnlockDevice(Device);
 
     ExitContext(context);
 
@@ -1901,8 +2101,9 @@ ALC_API ALCcontext* ALC_APIENTRY alcGetCurrentContext(ALCvoid)
 {
     ALCcontext *pContext;
 
-    if((pContext=GetContextSuspended()) != NULL)
-        ProcessContext(pContext);
+    SuspendContext(NULL);
+    pContext = GetCurrentContext();
+    ProcessContext(NULL);
 
     return pContext;
 }
@@ -2147,7 +2348,7 @@ ALC_API ALCdevice* ALC_APIENTRY alcOpenDevice(const ALCchar *deviceName)
     if(deviceName && !deviceName[0])
         deviceName = NULL;
 
-    device = calloc(1, sizeof(ALCdevice));
+    device = al_calloc(MIX_ALIGN, sizeof(ALCdevice));
     if(!device)
     {
         alcSetError(NULL, ALC_OUT_OF_MEMORY);
@@ -2158,6 +2359,7 @@ ALC_API ALCdevice* ALC_APIENTRY alcOpenDevice(const ALCchar *deviceName)
     device->Connected = ALC_TRUE;
     device->IsCaptureDevice = AL_FALSE;
     device->LastError = ALC_NO_ERROR;
+    InitializeCriticalSection(&device->Mutex);
 
     device->Bs2b = NULL;
     device->szDeviceName = NULL;
@@ -2213,6 +2415,12 @@ ALC_API ALCdevice* ALC_APIENTRY alcOpenDevice(const ALCchar *deviceName)
 
     device->HeadDampen = int2ALfp(0);
 
+    device->MixBudget = MAX_SOURCES_START*VOICE_BASE_COST;
+    device->MixedCost = 0;
+
+    aluInitMixer(device);
+    aluStartMixThreads(device);
+
     // Find a playback device to open
     SuspendContext(NULL);
     for(i = 0;BackendList[i].Init;i++)
@@ -2241,7 +2449,9 @@ ALC_API ALCdevice* ALC_APIENTRY alcOpenDevice(const ALCchar *deviceName)
     {
         // No suitable output device found
         alcSetError(NULL, ALC_INVALID_VALUE);
-        free(device);
+        aluStopMixThreads(device);
+        DeleteCriticalSection(&device->Mutex);
+        al_free(device);
         device = NULL;
     }
 
@@ -2330,9 +2540,12 @@ ALC_API ALCboolean ALC_APIENTRY alcCloseDevice(ALCdevice *pDevice)
     free(pDevice->Contexts);
     pDevice->Contexts = NULL;
 
+    aluStopMixThreads(pDevice);
+    DeleteCriticalSection(&pDevice->Mutex);
+
     //Release device structure
     memset(pDevice, 0, sizeof(ALCdevice));
-    free(pDevice);
+    al_free(pDevice);
 
     return ALC_TRUE;
 }
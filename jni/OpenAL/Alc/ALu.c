@@ -36,53 +36,12 @@
 #include "alAuxEffectSlot.h"
 #include "alu.h"
 #include "bs2b.h"
+#include "mixer_defs.h"
 
 #ifdef MAX_SOURCES_LOW
-// For throttling AlSource.c
-int alc_max_sources = MAX_SOURCES_LOW;
-int alc_active_sources = 0;
 int alc_num_cores = 0;
 #endif
 
-static __inline ALvoid aluCrossproduct(const ALfp *inVector1, const ALfp *inVector2, ALfp *outVector)
-{
-    outVector[0] = (ALfpMult(inVector1[1],inVector2[2]) - ALfpMult(inVector1[2],inVector2[1]));
-    outVector[1] = (ALfpMult(inVector1[2],inVector2[0]) - ALfpMult(inVector1[0],inVector2[2]));
-    outVector[2] = (ALfpMult(inVector1[0],inVector2[1]) - ALfpMult(inVector1[1],inVector2[0]));
-}
-
-static __inline ALfp aluDotproduct(const ALfp *inVector1, const ALfp *inVector2)
-{
-	return (ALfpMult(inVector1[0],inVector2[0]) + ALfpMult(inVector1[1],inVector2[1]) +
-            ALfpMult(inVector1[2],inVector2[2]));
-}
-
-static __inline ALvoid aluNormalize(ALfp *inVector)
-{
-    ALfp length, inverse_length;
-
-    length = aluSqrt(aluDotproduct(inVector, inVector));
-    if(length != int2ALfp(0))
-    {
-        inverse_length = ALfpDiv(int2ALfp(1),length);
-        inVector[0] = ALfpMult(inVector[0], inverse_length);
-        inVector[1] = ALfpMult(inVector[1], inverse_length);
-        inVector[2] = ALfpMult(inVector[2], inverse_length);
-    }
-}
-
-static __inline ALvoid aluMatrixVector(ALfp *vector,ALfp w,ALfp matrix[4][4])
-{
-    ALfp temp[4] = {
-        vector[0], vector[1], vector[2], w
-    };
-
-    vector[0] = ALfpMult(temp[0],matrix[0][0]) + ALfpMult(temp[1],matrix[1][0]) + ALfpMult(temp[2],matrix[2][0]) + ALfpMult(temp[3],matrix[3][0]);
-    vector[1] = ALfpMult(temp[0],matrix[0][1]) + ALfpMult(temp[1],matrix[1][1]) + ALfpMult(temp[2],matrix[2][1]) + ALfpMult(temp[3],matrix[3][1]);
-    vector[2] = ALfpMult(temp[0],matrix[0][2]) + ALfpMult(temp[1],matrix[1][2]) + ALfpMult(temp[2],matrix[2][2]) + ALfpMult(temp[3],matrix[3][2]);
-}
-
-
 ALvoid CalcNonAttnSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
 {
     ALfp SourceVolume,ListenerGain,MinVolume,MaxVolume;
@@ -146,7 +105,7 @@ ALvoid CalcNonAttnSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
     /* Calculate gains */
     DryGain = SourceVolume;
     DryGain = __min(DryGain,MaxVolume);
-    DryGain = __max(DryGain,MinVolume);
+    DryGain = max(DryGain,MinVolume);
     DryGainHF = int2ALfp(1);
 
     switch(ALSource->DirectFilter.type)
@@ -280,7 +239,7 @@ ALvoid CalcNonAttnSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
     {
         WetGain[i] = SourceVolume;
         WetGain[i] = __min(WetGain[i],MaxVolume);
-        WetGain[i] = __max(WetGain[i],MinVolume);
+        WetGain[i] = max(WetGain[i],MinVolume);
         WetGainHF[i] = int2ALfp(1);
 
         switch(ALSource->Send[i].WetFilter.type)
@@ -311,12 +270,53 @@ ALvoid CalcNonAttnSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
     }
 }
 
-ALvoid CalcSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
+/* Builds the matrix that takes world coordinates into listener space, and
+ * gets the listener's velocity in that space */
+static ALvoid CalcListenerFrame(const ALCcontext *ALContext, ALfp Matrix[4][4],
+                                ALfp *ListenerVel)
+{
+    ALfp U[3],V[3],N[3];
+
+    // Build transform matrix
+    memcpy(N, ALContext->Listener.Forward, sizeof(N));  // At-vector
+    aluNormalize(N);  // Normalized At-vector
+    memcpy(V, ALContext->Listener.Up, sizeof(V));  // Up-vector
+    aluNormalize(V);  // Normalized Up-vector
+    aluCrossproduct(N, V, U); // Right-vector
+    aluNormalize(U);  // Normalized Right-vector
+    Matrix[0][0] = U[0]; Matrix[0][1] = V[0]; Matrix[0][2] = -1*N[0]; Matrix[0][3] = int2ALfp(0);
+    Matrix[1][0] = U[1]; Matrix[1][1] = V[1]; Matrix[1][2] = -1*N[1]; Matrix[1][3] = int2ALfp(0);
+    Matrix[2][0] = U[2]; Matrix[2][1] = V[2]; Matrix[2][2] = -1*N[2]; Matrix[2][3] = int2ALfp(0);
+    Matrix[3][0] = int2ALfp(0); Matrix[3][1] = int2ALfp(0); Matrix[3][2] = int2ALfp(0); Matrix[3][3] = int2ALfp(1);
+
+    // Transform listener velocity into listener space
+    memcpy(ListenerVel, ALContext->Listener.Velocity, sizeof(ALContext->Listener.Velocity));
+    aluMatrixVector(ListenerVel, int2ALfp(0), Matrix);
+}
+
+/* Puts a source's position, orientation and velocity in entry i of a geometry
+ * block. Head-relative sources are already relative to the listener. */
+static __inline ALvoid GatherGeometry(SourceGeometry *geom, ALuint i,
+                                      const ALsource *ALSource,
+                                      const ALCcontext *ALContext)
+{
+    ALuint c;
+    for(c = 0;c < 3;c++)
+    {
+        geom->Pos[c][i] = ALSource->vPosition[c];
+        if(ALSource->bHeadRelative == AL_FALSE)
+            geom->Pos[c][i] -= ALContext->Listener.Position[c];
+        geom->Dir[c][i] = ALSource->vOrientation[c];
+        geom->Vel[c][i] = ALSource->vVelocity[c];
+    }
+}
+
+static ALvoid CalcAttnSourceParams(ALsource *ALSource, const ALCcontext *ALContext,
+                                   const SourceGeometry *geom, ALuint idx)
 {
     const ALCdevice *Device = ALContext->Device;
     ALfp InnerAngle,OuterAngle,Angle,Distance,OrigDist;
-    ALfp Direction[3],Position[3],SourceToListener[3];
-    ALfp Velocity[3],ListenerVel[3];
+    ALfp Position[3];
     ALfp MinVolume,MaxVolume,MinDist,MaxDist,Rolloff,OuterGainHF;
     ALfp ConeVolume,ConeHF,SourceVolume,ListenerGain;
     ALfp DopplerFactor, DopplerVelocity, SpeedOfSound;
@@ -353,13 +353,9 @@ ALvoid CalcSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
     //Get listener properties
     ListenerGain = ALContext->Listener.Gain;
     MetersPerUnit = ALContext->Listener.MetersPerUnit;
-    memcpy(ListenerVel, ALContext->Listener.Velocity, sizeof(ALContext->Listener.Velocity));
 
     //Get source properties
     SourceVolume = ALSource->flGain;
-    memcpy(Position,  ALSource->vPosition,    sizeof(ALSource->vPosition));
-    memcpy(Direction, ALSource->vOrientation, sizeof(ALSource->vOrientation));
-    memcpy(Velocity,  ALSource->vVelocity,    sizeof(ALSource->vVelocity));
     MinVolume    = ALSource->flMinGain;
     MaxVolume    = ALSource->flMaxGain;
     MinDist      = ALSource->flRefDistance;
@@ -370,47 +366,13 @@ ALvoid CalcSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
     OuterGainHF  = ALSource->OuterGainHF;
     AirAbsorptionFactor = ALSource->AirAbsorptionFactor;
 
-    //1. Translate Listener to origin (convert to head relative)
-    if(ALSource->bHeadRelative == AL_FALSE)
-    {
-        ALfp U[3],V[3],N[3];
-        ALfp Matrix[4][4];
-
-        // Build transform matrix
-        memcpy(N, ALContext->Listener.Forward, sizeof(N));  // At-vector
-        aluNormalize(N);  // Normalized At-vector
-        memcpy(V, ALContext->Listener.Up, sizeof(V));  // Up-vector
-        aluNormalize(V);  // Normalized Up-vector
-        aluCrossproduct(N, V, U); // Right-vector
-        aluNormalize(U);  // Normalized Right-vector
-        Matrix[0][0] = U[0]; Matrix[0][1] = V[0]; Matrix[0][2] = -1*N[0]; Matrix[0][3] = int2ALfp(0);
-        Matrix[1][0] = U[1]; Matrix[1][1] = V[1]; Matrix[1][2] = -1*N[1]; Matrix[1][3] = int2ALfp(0);
-        Matrix[2][0] = U[2]; Matrix[2][1] = V[2]; Matrix[2][2] = -1*N[2]; Matrix[2][3] = int2ALfp(0);
-        Matrix[3][0] = int2ALfp(0); Matrix[3][1] = int2ALfp(0); Matrix[3][2] = int2ALfp(0); Matrix[3][3] = int2ALfp(1);
-
-        // Translate position
-        Position[0] -= ALContext->Listener.Position[0];
-        Position[1] -= ALContext->Listener.Position[1];
-        Position[2] -= ALContext->Listener.Position[2];
-
-        // Transform source position and direction into listener space
-        aluMatrixVector(Position, int2ALfp(1), Matrix);
-        aluMatrixVector(Direction, int2ALfp(0), Matrix);
-        // Transform source and listener velocity into listener space
-        aluMatrixVector(Velocity, int2ALfp(0), Matrix);
-        aluMatrixVector(ListenerVel, int2ALfp(0), Matrix);
-    }
-    else
-        ListenerVel[0] = ListenerVel[1] = ListenerVel[2] = int2ALfp(0);
-
-    SourceToListener[0] = -1*Position[0];
-    SourceToListener[1] = -1*Position[1];
-    SourceToListener[2] = -1*Position[2];
-    aluNormalize(SourceToListener);
-    aluNormalize(Direction);
+    //Get the listener space geometry
+    Position[0] = geom->Pos[0][idx];
+    Position[1] = geom->Pos[1][idx];
+    Position[2] = geom->Pos[2][idx];
 
     //2. Calculate distance attenuation
-    Distance = aluSqrt(aluDotproduct(Position, Position));
+    Distance = geom->Dist[idx];
     OrigDist = Distance;
 
     Attenuation = int2ALfp(1);
@@ -429,7 +391,7 @@ ALvoid CalcSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
                                             ALContext->DistanceModel)
     {
         case AL_INVERSE_DISTANCE_CLAMPED:
-            Distance=__max(Distance,MinDist);
+            Distance=max(Distance,MinDist);
             Distance=__min(Distance,MaxDist);
             if(MaxDist < MinDist)
                 break;
@@ -448,7 +410,7 @@ ALvoid CalcSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
             break;
 
         case AL_LINEAR_DISTANCE_CLAMPED:
-            Distance=__max(Distance,MinDist);
+            Distance=max(Distance,MinDist);
             Distance=__min(Distance,MaxDist);
             if(MaxDist < MinDist)
                 break;
@@ -457,17 +419,17 @@ ALvoid CalcSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
             if(MaxDist != MinDist)
             {
                 Attenuation = int2ALfp(1) - ALfpDiv(ALfpMult(Rolloff,(Distance-MinDist)), (MaxDist - MinDist));
-                Attenuation = __max(Attenuation, int2ALfp(0));
+                Attenuation = max(Attenuation, int2ALfp(0));
                 for(i = 0;i < NumSends;i++)
                 {
                     RoomAttenuation[i] = int2ALfp(1) - ALfpDiv(ALfpMult(RoomRolloff[i],(Distance-MinDist)),(MaxDist - MinDist));
-                    RoomAttenuation[i] = __max(RoomAttenuation[i], int2ALfp(0));
+                    RoomAttenuation[i] = max(RoomAttenuation[i], int2ALfp(0));
                 }
             }
             break;
 
         case AL_EXPONENT_DISTANCE_CLAMPED:
-            Distance=__max(Distance,MinDist);
+            Distance=max(Distance,MinDist);
             Distance=__min(Distance,MaxDist);
             if(MaxDist < MinDist)
                 break;
@@ -509,7 +471,7 @@ ALvoid CalcSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
     }
 
     //3. Apply directional soundcones
-    Angle = ALfpMult(aluAcos(aluDotproduct(Direction,SourceToListener)), float2ALfp(180.0f/M_PI));
+    Angle = ALfpMult(aluAcos(geom->ConeCos[idx]), float2ALfp(180.0f/M_PI));
     if(Angle >= InnerAngle && Angle <= OuterAngle)
     {
 		ALfp scale; scale = ALfpDiv((Angle-InnerAngle), (OuterAngle-InnerAngle));
@@ -531,7 +493,7 @@ ALvoid CalcSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
     // NOTE: This should be aluDotproduct({0,0,-1}, ListenerToSource), however
     // that is equivalent to aluDotproduct({0,0,1}, SourceToListener), which is
     // the same as SourceToListener[2]
-    Angle = ALfpMult(aluAcos(SourceToListener[2]), float2ALfp(180.0f/M_PI));
+    Angle = ALfpMult(aluAcos(geom->BackCos[idx]), float2ALfp(180.0f/M_PI));
     // Sources within the minimum distance attenuate less
     if(OrigDist < MinDist)
         Angle = ALfpMult(Angle, ALfpDiv(OrigDist,MinDist));
@@ -547,7 +509,7 @@ ALvoid CalcSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
 
     // Clamp to Min/Max Gain
     DryGain = __min(DryGain,MaxVolume);
-    DryGain = __max(DryGain,MinVolume);
+    DryGain = max(DryGain,MinVolume);
 
     for(i = 0;i < NumSends;i++)
     {
@@ -569,7 +531,7 @@ ALvoid CalcSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
 
             // Clamp to Min/Max Gain
             WetGain[i] = __min(WetGain[i],MaxVolume);
-            WetGain[i] = __max(WetGain[i],MinVolume);
+            WetGain[i] = max(WetGain[i],MinVolume);
 
             if(Slot->effect.type == AL_EFFECT_REVERB ||
                Slot->effect.type == AL_EFFECT_EAXREVERB)
@@ -629,13 +591,13 @@ ALvoid CalcSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
 		ALfp MaxVelocity; MaxVelocity = ALfpDiv(ALfpMult(SpeedOfSound,DopplerVelocity),
                                                 DopplerFactor);
 
-        VSS = aluDotproduct(Velocity, SourceToListener);
+        VSS = geom->SrcSpeed[idx];
         if(VSS >= MaxVelocity)
             VSS = (MaxVelocity - int2ALfp(1));
         else if(VSS <= -MaxVelocity)
             VSS = (-MaxVelocity + int2ALfp(1));
 
-        VLS = aluDotproduct(ListenerVel, SourceToListener);
+        VLS = geom->LisSpeed[idx];
         if(VLS >= MaxVelocity)
             VLS = (MaxVelocity - int2ALfp(1));
         else if(VLS <= -MaxVelocity)
@@ -673,7 +635,7 @@ ALvoid CalcSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
     }
 
     // Use energy-preserving panning algorithm for multi-speaker playback
-    length = __max(OrigDist, MinDist);
+    length = max(OrigDist, MinDist);
     if(length > int2ALfp(0))
     {
         ALfp invlen = ALfpDiv(int2ALfp(1), length);
@@ -703,7 +665,7 @@ ALvoid CalcSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
     }
 
     /* Update filter coefficients. */
-    cw = __cos(ALfpDiv(float2ALfp(2.0*M_PI*LOWPASSFREQCUTOFF), int2ALfp(Frequency)));
+    cw = aluCos(ALfpDiv(float2ALfp(2.0*M_PI*LOWPASSFREQCUTOFF), int2ALfp(Frequency)));
 
     /* Spatialized sources use four chained one-pole filters, so we need to
      * take the fourth root of the squared gain, which is the same as the
@@ -719,33 +681,97 @@ ALvoid CalcSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
 }
 
 
-static __inline ALfloat aluF2F(ALfp val)
+/* Spatializes count sources at once, which must all be head-relative or all
+ * not. The geometry kernels work on groups of four, so the block is padded
+ * out by repeating the last source. */
+static ALvoid CalcGeometryParams(ALsource **sources, SourceGeometry *geom,
+                                 ALuint count, const ALCcontext *ALContext)
 {
-	return ALfp2float(val);
-}
-static __inline ALushort aluF2US(ALfp val)
-{
-    if(val > int2ALfp(1)) return 65535;
-    if(val < int2ALfp(-1)) return 0;
-    return (ALushort)(ALfp2int(ALfpMult(val,int2ALfp(32767))) + 32768);
+    ALfp Matrix[4][4], ListenerVel[3];
+    ALuint i, c;
+
+    if(count == 0)
+        return;
+
+    for(i = count;(i&3);i++)
+    {
+        for(c = 0;c < 3;c++)
+        {
+            geom->Pos[c][i] = geom->Pos[c][count-1];
+            geom->Dir[c][i] = geom->Dir[c][count-1];
+            geom->Vel[c][i] = geom->Vel[c][count-1];
+        }
+    }
+
+    //1. Translate Listener to origin (convert to head relative)
+    if(sources[0]->bHeadRelative == AL_FALSE)
+    {
+        CalcListenerFrame(ALContext, Matrix, ListenerVel);
+        ALContext->Device->Mixer->Geometry(geom, Matrix, ListenerVel, count);
+    }
+    else
+    {
+        ListenerVel[0] = ListenerVel[1] = ListenerVel[2] = int2ALfp(0);
+        ALContext->Device->Mixer->Geometry(geom, NULL, ListenerVel, count);
+    }
+
+    for(i = 0;i < count;i++)
+        CalcAttnSourceParams(sources[i], ALContext, geom, i);
 }
-static __inline ALshort aluF2S(ALfp val)
+
+ALvoid CalcSourceParams(ALsource *ALSource, const ALCcontext *ALContext)
 {
-    if(val > int2ALfp(1)) return 32767;
-    if(val < int2ALfp(-1)) return -32768;
-    return (ALshort)(ALfp2int(ALfpMult(val,int2ALfp(32767))));
+    SourceGeometry geom;
+
+    GatherGeometry(&geom, 0, ALSource, ALContext);
+    CalcGeometryParams(&ALSource, &geom, 1, ALContext);
 }
-static __inline ALubyte aluF2UB(ALfp val)
+
+/* A source is dirty when its own properties changed, or when the context's
+ * have since it was last updated. */
+static __inline ALboolean SourceIsDirty(const ALsource *Source, const ALCcontext *ALContext)
 {
-    ALushort i = aluF2US(val);
-    return i>>8;
+    return (Source->NeedsUpdate || Source->UpdateGen != ALContext->UpdateGen ||
+            (!Source->bHeadRelative && Source->ListenerGen != ALContext->ListenerGen));
 }
-static __inline ALbyte aluF2B(ALfp val)
+
+/* Brings the dirty sources up to date. Spatialized sources are collected so
+ * their geometry can be worked out a block at a time. */
+static ALvoid UpdateSources(ALCcontext *ALContext, ALsource **src, ALsource **src_end)
 {
-    ALshort i = aluF2S(val);
-    return i>>8;
+    ALsource *batch[2][GEOMETRY_BLOCK];
+    SourceGeometry geom[2];
+    ALuint count[2] = { 0, 0 };
+    ALuint rel;
+
+    for(;src != src_end;src++)
+    {
+        if(!SourceIsDirty(*src, ALContext))
+            continue;
+        (*src)->NeedsUpdate = AL_FALSE;
+        (*src)->UpdateGen = ALContext->UpdateGen;
+        (*src)->ListenerGen = ALContext->ListenerGen;
+
+        if((*src)->Update != CalcSourceParams)
+        {
+            ALsource_Update(*src, ALContext);
+            continue;
+        }
+
+        rel = ((*src)->bHeadRelative != AL_FALSE);
+        batch[rel][count[rel]] = *src;
+        GatherGeometry(&geom[rel], count[rel], *src, ALContext);
+        if(++count[rel] == GEOMETRY_BLOCK)
+        {
+            CalcGeometryParams(batch[rel], &geom[rel], count[rel], ALContext);
+            count[rel] = 0;
+        }
+    }
+    for(rel = 0;rel < 2;rel++)
+        CalcGeometryParams(batch[rel], &geom[rel], count[rel], ALContext);
 }
 
+
 static const Channel MonoChans[] = { FRONT_CENTER };
 static const Channel StereoChans[] = { FRONT_LEFT, FRONT_RIGHT };
 static const Channel QuadChans[] = { FRONT_LEFT, FRONT_RIGHT,
@@ -761,143 +787,215 @@ static const Channel X71Chans[] = { FRONT_LEFT, FRONT_RIGHT,
                                     BACK_LEFT, BACK_RIGHT,
                                     SIDE_LEFT, SIDE_RIGHT };
 
-#define DECL_TEMPLATE(T, chans,N, func)                                       \
-static void Write_##T##_##chans(ALCdevice *device, T *buffer, ALuint SamplesToDo)\
-{                                                                             \
-    ALfp (*DryBuffer)[MAXCHANNELS] = device->DryBuffer;                       \
-    ALfp (*Matrix)[MAXCHANNELS] = device->ChannelMatrix;                      \
-    const ALuint *ChanMap = device->DevChannels;                              \
-    ALuint i, j, c;                                                           \
-                                                                              \
-    for(i = 0;i < SamplesToDo;i++)                                            \
-    {                                                                         \
-        for(j = 0;j < N;j++)                                                  \
-        {                                                                     \
-			ALfp samp; samp = int2ALfp(0);                                    \
-            for(c = 0;c < MAXCHANNELS;c++) {                                  \
-				ALfp m = Matrix[c][chans[j]];                                 \
-                if (m != 0)                                                   \
-                    samp += ALfpMult(DryBuffer[i][c], m);                     \
-            }                                                                 \
-            ((T*)buffer)[ChanMap[chans[j]]] = func(samp);                     \
-        }                                                                     \
-        buffer = ((T*)buffer) + N;                                            \
-    }                                                                         \
+/* Writes the dry mix out in the device's format. Each output channel is
+ * summed from the mix channels feeding it, then converted into place. */
+static ALvoid WriteSamples(ALCdevice *device, ALvoid *buffer, ALuint SamplesToDo)
+{
+    ALsample (*DryBuffer)[BUFFERSIZE] = device->DryBuffer;
+    ALfp (*Matrix)[MAXCHANNELS] = device->ChannelMatrix;
+    const ALuint *ChanMap = device->DevChannels;
+    const MixerFuncs *Mixer = device->Mixer;
+    StoreFunc Store = Mixer->Store[device->FmtType];
+    ALuint Bytes = BytesFromDevFmt(device->FmtType);
+    ALsample mixed[BUFFERSIZE];
+    const Channel *chans;
+    ALuint N, j, c;
+
+    switch(device->FmtChans)
+    {
+        case DevFmtMono: chans = MonoChans; N = 1; break;
+        case DevFmtStereo: chans = StereoChans; N = 2; break;
+        case DevFmtQuad: chans = QuadChans; N = 4; break;
+        case DevFmtX51: chans = X51Chans; N = 6; break;
+        case DevFmtX61: chans = X61Chans; N = 7; break;
+        case DevFmtX71: chans = X71Chans; N = 8; break;
+        default: return;
+    }
+
+    for(j = 0;j < N;j++)
+    {
+        const ALsample *in[MAXCHANNELS];
+        ALsample gain[MAXCHANNELS];
+        ALuint count = 0;
+
+        /* Only walk the mix channels that feed this output */
+        for(c = 0;c < MAXCHANNELS;c++)
+        {
+            ALfp m = Matrix[c][chans[j]];
+            if(m != 0)
+            {
+                in[count] = DryBuffer[c];
+                gain[count] = m;
+                count++;
+            }
+        }
+
+        Mixer->MatrixMix(mixed, in, gain, count, SamplesToDo);
+        Store((ALubyte*)buffer + ChanMap[chans[j]]*Bytes, N, mixed, SamplesToDo);
+    }
 }
 
-DECL_TEMPLATE(ALfloat, MonoChans,1, aluF2F)
-DECL_TEMPLATE(ALfloat, QuadChans,4, aluF2F)
-DECL_TEMPLATE(ALfloat, X51Chans,6, aluF2F)
-DECL_TEMPLATE(ALfloat, X61Chans,7, aluF2F)
-DECL_TEMPLATE(ALfloat, X71Chans,8, aluF2F)
-
-DECL_TEMPLATE(ALushort, MonoChans,1, aluF2US)
-DECL_TEMPLATE(ALushort, QuadChans,4, aluF2US)
-DECL_TEMPLATE(ALushort, X51Chans,6, aluF2US)
-DECL_TEMPLATE(ALushort, X61Chans,7, aluF2US)
-DECL_TEMPLATE(ALushort, X71Chans,8, aluF2US)
-
-DECL_TEMPLATE(ALshort, MonoChans,1, aluF2S)
-DECL_TEMPLATE(ALshort, QuadChans,4, aluF2S)
-DECL_TEMPLATE(ALshort, X51Chans,6, aluF2S)
-DECL_TEMPLATE(ALshort, X61Chans,7, aluF2S)
-DECL_TEMPLATE(ALshort, X71Chans,8, aluF2S)
-
-DECL_TEMPLATE(ALubyte, MonoChans,1, aluF2UB)
-DECL_TEMPLATE(ALubyte, QuadChans,4, aluF2UB)
-DECL_TEMPLATE(ALubyte, X51Chans,6, aluF2UB)
-DECL_TEMPLATE(ALubyte, X61Chans,7, aluF2UB)
-DECL_TEMPLATE(ALubyte, X71Chans,8, aluF2UB)
-
-DECL_TEMPLATE(ALbyte, MonoChans,1, aluF2B)
-DECL_TEMPLATE(ALbyte, QuadChans,4, aluF2B)
-DECL_TEMPLATE(ALbyte, X51Chans,6, aluF2B)
-DECL_TEMPLATE(ALbyte, X61Chans,7, aluF2B)
-DECL_TEMPLATE(ALbyte, X71Chans,8, aluF2B)
-
-#undef DECL_TEMPLATE
-
-#define DECL_TEMPLATE(T, chans,N, func)                                       \
-static void Write_##T##_##chans(ALCdevice *device, T *buffer, ALuint SamplesToDo)\
-{                                                                             \
-    ALfp (*DryBuffer)[MAXCHANNELS] = device->DryBuffer;                       \
-    ALfp (*Matrix)[MAXCHANNELS] = device->ChannelMatrix;                      \
-    const ALuint *ChanMap = device->DevChannels;                              \
-    ALuint i, j, c;                                                           \
-                                                                              \
-    if(device->Bs2b)                                                          \
-    {                                                                         \
-        for(i = 0;i < SamplesToDo;i++)                                        \
-        {                                                                     \
-            ALfp samples[2] = { int2ALfp(0), int2ALfp(0) };                   \
-            for(c = 0;c < MAXCHANNELS;c++)                                    \
-            {                                                                 \
-                samples[0] += ALfpMult(DryBuffer[i][c],Matrix[c][FRONT_LEFT]); \
-                samples[1] += ALfpMult(DryBuffer[i][c],Matrix[c][FRONT_RIGHT]); \
-            }                                                                 \
-            bs2b_cross_feed(device->Bs2b, samples);                           \
-            ((T*)buffer)[ChanMap[FRONT_LEFT]]  = func(samples[0]);            \
-            ((T*)buffer)[ChanMap[FRONT_RIGHT]] = func(samples[1]);            \
-            buffer = ((T*)buffer) + 2;                                        \
-        }                                                                     \
-    }                                                                         \
-    else                                                                      \
-    {                                                                         \
-        for(i = 0;i < SamplesToDo;i++)                                        \
-        {                                                                     \
-            for(j = 0;j < N;j++)                                              \
-            {                                                                 \
-                ALfp samp = int2ALfp(0);                                      \
-                for(c = 0;c < MAXCHANNELS;c++)                                \
-                    samp += ALfpMult(DryBuffer[i][c], Matrix[c][chans[j]]);   \
-                ((T*)buffer)[ChanMap[chans[j]]] = func(samp);                 \
-            }                                                                 \
-            buffer = ((T*)buffer) + N;                                        \
-        }                                                                     \
-    }                                                                         \
+/* As WriteSamples, for stereo output through the bs2b crossfeed. That goes a
+ * frame at a time, so it's done in blocks ahead of the conversion. */
+static ALvoid WriteSamplesBs2b(ALCdevice *device, ALvoid *buffer, ALuint SamplesToDo)
+{
+    ALsample (*DryBuffer)[BUFFERSIZE] = device->DryBuffer;
+    ALfp (*Matrix)[MAXCHANNELS] = device->ChannelMatrix;
+    const ALuint *ChanMap = device->DevChannels;
+    StoreFunc Store = device->Mixer->Store[device->FmtType];
+    ALuint Bytes = BytesFromDevFmt(device->FmtType);
+    ALsample mixed[2][1024];
+    ALuint base, todo, i, c;
+
+    for(base = 0;base < SamplesToDo;base += todo)
+    {
+        todo = min(SamplesToDo-base, 1024);
+        for(i = 0;i < todo;i++)
+        {
+            ALfp samples[2] = { int2ALfp(0), int2ALfp(0) };
+            for(c = 0;c < MAXCHANNELS;c++)
+            {
+                samples[0] += ALsampleMult(DryBuffer[c][base+i],Matrix[c][FRONT_LEFT]);
+                samples[1] += ALsampleMult(DryBuffer[c][base+i],Matrix[c][FRONT_RIGHT]);
+            }
+            bs2b_cross_feed(device->Bs2b, samples);
+            mixed[0][i] = samples[0];
+            mixed[1][i] = samples[1];
+        }
+        Store((ALubyte*)buffer + (base*2 + ChanMap[FRONT_LEFT])*Bytes, 2,
+              mixed[0], todo);
+        Store((ALubyte*)buffer + (base*2 + ChanMap[FRONT_RIGHT])*Bytes, 2,
+              mixed[1], todo);
+    }
+}
+
+#ifdef MAX_SOURCES_LOW
+/* Relative cost of mixing a source for one sample: resampling (or a plain
+ * conversion for integer formats at the device rate), then the dry filter
+ * and panning, for each channel, plus one unit per active send. */
+static ALint VoiceCost(const ALsource *Source, const ALCdevice *Device,
+                       ALuint Channels, enum FmtType FmtType)
+{
+    ALint cost;
+    ALuint i;
+
+    if(Source->Params.Step == FRACTIONONE)
+        cost = ((FmtType == FmtFloat) ? 0 : 1);
+    else switch(Source->Resampler)
+    {
+        case POINT_RESAMPLER: cost = 2; break;
+        case CUBIC_RESAMPLER: cost = 5; break;
+        default:              cost = 3; break;
+    }
+    cost += 2;
+    if(FmtType == FmtIMA4)
+        cost++;
+    for(i = 0;i < Device->NumAuxSends;i++)
+    {
+        if(Source->Send[i].Slot &&
+           Source->Send[i].Slot->effect.type != AL_EFFECT_NULL)
+            cost++;
+    }
+    return cost * Channels;
 }
 
-DECL_TEMPLATE(ALfloat, StereoChans,2, aluF2F)
-DECL_TEMPLATE(ALushort, StereoChans,2, aluF2US)
-DECL_TEMPLATE(ALshort, StereoChans,2, aluF2S)
-DECL_TEMPLATE(ALubyte, StereoChans,2, aluF2UB)
-DECL_TEMPLATE(ALbyte, StereoChans,2, aluF2B)
-
-#undef DECL_TEMPLATE
-
-#define DECL_TEMPLATE(T, func)                                                \
-static void Write_##T(ALCdevice *device, T *buffer, ALuint SamplesToDo)       \
-{                                                                             \
-    switch(device->FmtChans)                                                  \
-    {                                                                         \
-        case DevFmtMono:                                                      \
-            Write_##T##_MonoChans(device, buffer, SamplesToDo);               \
-            break;                                                            \
-        case DevFmtStereo:                                                    \
-            Write_##T##_StereoChans(device, buffer, SamplesToDo);             \
-            break;                                                            \
-        case DevFmtQuad:                                                      \
-            Write_##T##_QuadChans(device, buffer, SamplesToDo);               \
-            break;                                                            \
-        case DevFmtX51:                                                       \
-            Write_##T##_X51Chans(device, buffer, SamplesToDo);                \
-            break;                                                            \
-        case DevFmtX61:                                                       \
-            Write_##T##_X61Chans(device, buffer, SamplesToDo);                \
-            break;                                                            \
-        case DevFmtX71:                                                       \
-            Write_##T##_X71Chans(device, buffer, SamplesToDo);                \
-            break;                                                            \
-    }                                                                         \
+/* Loudest output gain of the source, dry or wet */
+static ALfp VoiceGain(const ALsource *Source, const ALCdevice *Device,
+                      ALuint Channels)
+{
+    ALfp gain = int2ALfp(0);
+    ALuint i, c;
+
+    Channels = min(Channels, MAXCHANNELS);
+    for(i = 0;i < Channels;i++)
+    {
+        for(c = 0;c < MAXCHANNELS;c++)
+            gain = max(gain, Source->Params.DryGains[i][c]);
+    }
+    for(i = 0;i < Device->NumAuxSends;i++)
+    {
+        if(Source->Send[i].Slot &&
+           Source->Send[i].Slot->effect.type != AL_EFFECT_NULL)
+            gain = max(gain, Source->Params.Send[i].WetGain);
+    }
+    return gain;
 }
 
-DECL_TEMPLATE(ALfloat, aluF2F)
-DECL_TEMPLATE(ALushort, aluF2US)
-DECL_TEMPLATE(ALshort, aluF2S)
-DECL_TEMPLATE(ALubyte, aluF2UB)
-DECL_TEMPLATE(ALbyte, aluF2B)
+/* Picks which of the context's active sources get mixed this update. They
+ * are ranked by loudness weighted with their priority, and mixed in that
+ * order until the budget runs out; the rest are culled, which makes
+ * MixSource only advance them. Sources with priority 127 and up are always
+ * mixed, and take from the PrioritySlots reserve first. Returns the cost of
+ * what will be mixed. */
+static ALint ScheduleSources(ALCcontext *Context, ALCdevice *Device)
+{
+    ALsource **src = Context->ActiveSources;
+    ALsizei count = Context->ActiveSourceCount;
+    ALint reserved = Context->PrioritySlots*VOICE_BASE_COST;
+    ALint used = 0, mixed;
+    ALsizei i, j;
+
+    for(i = 0;i < count;i++)
+    {
+        ALsource *Source = src[i];
+        enum FmtChannels FmtChannels = FmtMono;
+        enum FmtType FmtType = FmtShort;
+        ALbufferlistitem *BufferList;
+        ALuint Channels;
+        ALfp gain;
+
+        for(BufferList = Source->queue;BufferList;BufferList = BufferList->next)
+        {
+            if(BufferList->buffer)
+            {
+                FmtChannels = BufferList->buffer->FmtChannels;
+                FmtType = BufferList->buffer->FmtType;
+                break;
+            }
+        }
+        Channels = ChannelsFromFmt(FmtChannels);
+
+        gain = VoiceGain(Source, Device, Channels);
+        Source->Audibility = ALfpMult(gain, int2ALfp(Source->priority+1));
+        /* Inaudible sources are only advanced anyway, and held ones not even
+         * that */
+        Source->MixCost = ((gain < VIRTUAL_GAIN_THRESHOLD || Source->Starting) ? 0 :
+                           VoiceCost(Source, Device, Channels, FmtType));
+        if(Source->priority >= 127)
+        {
+            Source->Culled = AL_FALSE;
+            used += Source->MixCost;
+        }
+    }
+
+    /* Loudest first. The order barely changes from one update to the next,
+     * so an insertion sort is close to linear. */
+    for(i = 1;i < count;i++)
+    {
+        ALsource *Source = src[i];
+        for(j = i;j > 0 && src[j-1]->Audibility < Source->Audibility;j--)
+            src[j] = src[j-1];
+        src[j] = Source;
+    }
 
-#undef DECL_TEMPLATE
+    mixed = used;
+    used = max(used, reserved);
+    for(i = 0;i < count;i++)
+    {
+        ALsource *Source = src[i];
+        if(Source->priority >= 127)
+            continue;
+
+        Source->Culled = (used+Source->MixCost > Device->MixBudget);
+        if(!Source->Culled)
+        {
+            used += Source->MixCost;
+            mixed += Source->MixCost;
+        }
+    }
+    return mixed;
+}
+#endif
 
 static __inline ALvoid aluMixDataPrivate(ALCdevice *device, ALvoid *buffer, ALsizei size)
 {
@@ -924,14 +1022,15 @@ static __inline ALvoid aluMixDataPrivate(ALCdevice *device, ALvoid *buffer, ALsi
         SamplesToDo = min(size, BUFFERSIZE);
 
         /* Clear mixing buffer */
-        memset(device->DryBuffer, 0, SamplesToDo*MAXCHANNELS*sizeof(ALfp));
+        for(c = 0;c < MAXCHANNELS;c++)
+            memset(device->DryBuffer[c], 0, SamplesToDo*sizeof(ALsample));
 
-        SuspendContext(NULL);
+        LockDevice(device);
         ctx = device->Contexts;
         ctx_end = ctx + device->NumContexts;
         while(ctx != ctx_end)
         {
-            SuspendContext(*ctx);
+            ProcessSourceCommands(*ctx);
 
             src = (*ctx)->ActiveSources;
             src_end = src + (*ctx)->ActiveSourceCount;
@@ -943,17 +1042,36 @@ static __inline ALvoid aluMixDataPrivate(ALCdevice *device, ALvoid *buffer, ALsi
                     *src = *(--src_end);
                     continue;
                 }
+                src++;
+            }
 
-                if((*src)->NeedsUpdate)
-                {
-                    ALsource_Update(*src, *ctx);
-                    (*src)->NeedsUpdate = AL_FALSE;
-                }
+            /* Pick up property changes, unless an API call has the context
+             * right now. Then the sources keep their current parameters for
+             * another update rather than have the mixer wait on it. */
+            if(TryEnterCriticalSection(&(*ctx)->Mutex))
+            {
+                src = (*ctx)->ActiveSources;
+                src_end = src + (*ctx)->ActiveSourceCount;
+                if(!(*ctx)->DeferUpdates)
+                    UpdateSources(*ctx, src, src_end);
+                ProcessContext(*ctx);
+            }
 
-                MixSource(*src, device, SamplesToDo);
-                src++;
+            /* A source that just started goes once its parameters are up to
+             * date. Until then it's held, neither mixed nor advanced. */
+            src = (*ctx)->ActiveSources;
+            src_end = src + (*ctx)->ActiveSourceCount;
+            for(;src != src_end;src++)
+            {
+                if((*src)->Starting && !SourceIsDirty(*src, *ctx))
+                    (*src)->Starting = AL_FALSE;
             }
 
+#ifdef MAX_SOURCES_LOW
+            device->MixedCost += (ALint64)ScheduleSources(*ctx, device) * SamplesToDo;
+#endif
+            aluMixSources(device, *ctx, SamplesToDo);
+
             /* effect slot processing */
             for(e = 0;e < (*ctx)->EffectSlotMap.size;e++)
             {
@@ -961,7 +1079,7 @@ static __inline ALvoid aluMixDataPrivate(ALCdevice *device, ALvoid *buffer, ALsi
 
                 for(i = 0;i < SamplesToDo;i++)
                 {
-                    ALEffectSlot->ClickRemoval[0] -= ALfpDiv(ALEffectSlot->ClickRemoval[0], int2ALfp(256));
+                    ALEffectSlot->ClickRemoval[0] -= ALEffectSlot->ClickRemoval[0] / 256;
                     ALEffectSlot->WetBuffer[i] += ALEffectSlot->ClickRemoval[0];
                 }
                 for(i = 0;i < 1;i++)
@@ -978,19 +1096,22 @@ static __inline ALvoid aluMixDataPrivate(ALCdevice *device, ALvoid *buffer, ALsi
                     ALEffectSlot->WetBuffer[i] = int2ALfp(0);
             }
 
-            ProcessContext(*ctx);
             ctx++;
         }
-        ProcessContext(NULL);
+        UnlockDevice(device);
 
         //Post processing loop
-        for(i = 0;i < SamplesToDo;i++)
+        for(c = 0;c < MAXCHANNELS;c++)
         {
-            for(c = 0;c < MAXCHANNELS;c++)
+            ALsample *DryBuffer = device->DryBuffer[c];
+            ALsample offset = device->ClickRemoval[c];
+
+            for(i = 0;i < SamplesToDo;i++)
             {
-                device->ClickRemoval[c] -= ALfpDiv(device->ClickRemoval[c], int2ALfp(256));
-                device->DryBuffer[i][c] += device->ClickRemoval[c];
+                offset -= offset / 256;
+                DryBuffer[i] += offset;
             }
+            device->ClickRemoval[c] = offset;
         }
         for(i = 0;i < MAXCHANNELS;i++)
         {
@@ -998,24 +1119,12 @@ static __inline ALvoid aluMixDataPrivate(ALCdevice *device, ALvoid *buffer, ALsi
             device->PendingClicks[i] = int2ALfp(0);
         }
 
-        switch(device->FmtType)
-        {
-            case DevFmtByte:
-                Write_ALbyte(device, buffer, SamplesToDo);
-                break;
-            case DevFmtUByte:
-                Write_ALubyte(device, buffer, SamplesToDo);
-                break;
-            case DevFmtShort:
-                Write_ALshort(device, buffer, SamplesToDo);
-                break;
-            case DevFmtUShort:
-                Write_ALushort(device, buffer, SamplesToDo);
-                break;
-            case DevFmtFloat:
-                Write_ALfloat(device, buffer, SamplesToDo);
-                break;
-        }
+        if(device->Bs2b && device->FmtChans == DevFmtStereo)
+            WriteSamplesBs2b(device, buffer, SamplesToDo);
+        else
+            WriteSamples(device, buffer, SamplesToDo);
+        buffer = (ALubyte*)buffer + SamplesToDo*FrameSizeFromDevFmt(device->FmtChans,
+                                                                    device->FmtType);
 
         size -= SamplesToDo;
     }
@@ -1038,14 +1147,12 @@ static inline long timespecdiff(struct timespec *starttime, struct timespec *fin
 ALvoid aluMixData(ALCdevice *device, ALvoid *buffer, ALsizei size)
 {
 #ifdef MAX_SOURCES_LOW
-    // Profile aluMixDataPrivate to set admission control parameters
-    static struct timespec ts_start;
-    static struct timespec ts_end;
+    // Profile aluMixDataPrivate to size the voice budget
+    struct timespec ts_start;
+    struct timespec ts_end;
     long ts_diff;
-    int time_per_source;
-    int max_sources_within_deadline;
+    ALint64 budget;
 	int mix_deadline_usec;
-	int max;
 	
 	if (alc_num_cores == 0) {
 		// FIXME(Apportable) this is Linux specific
@@ -1061,6 +1168,7 @@ ALvoid aluMixData(ALCdevice *device, ALvoid *buffer, ALsizei size)
 		mix_deadline_usec = ((size*1000000) / device->Frequency) / 5;
 	}
 
+    device->MixedCost = 0;
     clock_gettime(CLOCK_MONOTONIC, &ts_start);
 	aluMixDataPrivate(device, buffer,  size);
     clock_gettime(CLOCK_MONOTONIC, &ts_end);
@@ -1068,18 +1176,20 @@ ALvoid aluMixData(ALCdevice *device, ALvoid *buffer, ALsizei size)
     // Time in micro-seconds that aluMixData has taken to run
     ts_diff = timespecdiff(&ts_start, &ts_end);
 
-    // Try to adjust the max sources limit adaptively, within a range
-    if (alc_active_sources > 0) {
-		time_per_source = max(1, ts_diff / alc_active_sources);
-		max_sources_within_deadline = mix_deadline_usec / time_per_source;
-		max = min(max(max_sources_within_deadline, MAX_SOURCES_LOW), MAX_SOURCES_HIGH);
-		if (max > alc_max_sources) {
-			alc_max_sources++;
-		} else if (max < alc_max_sources) {
-			alc_max_sources = max;
+    // Scale what was mixed by how far off the deadline it came in, and move
+    // the budget toward that: down right away, up one voice at a time
+    if (device->MixedCost > 0 && size > 0) {
+		budget = (ALint64)mix_deadline_usec * device->MixedCost /
+		         ((ALint64)max(ts_diff, 1) * size);
+		budget = min(max(budget, MAX_SOURCES_LOW*VOICE_BASE_COST),
+		             MAX_SOURCES_HIGH*VOICE_BASE_COST);
+		if (budget > device->MixBudget) {
+			device->MixBudget = min(device->MixBudget+VOICE_BASE_COST, budget);
+		} else if (budget < device->MixBudget) {
+			device->MixBudget = budget;
 		}
     } else {
-    	alc_max_sources = MAX_SOURCES_START;
+    	device->MixBudget = MAX_SOURCES_START*VOICE_BASE_COST;
     }
 #else
 	aluMixDataPrivate(device, buffer,  size);
@@ -1090,15 +1200,15 @@ ALvoid aluHandleDisconnect(ALCdevice *device)
 {
     ALuint i;
 
-    SuspendContext(NULL);
+    // Sources are only added and removed, and their state changed, with the
+    // device held, so the contexts don't need locking too
+    LockDevice(device);
     for(i = 0;i < device->NumContexts;i++)
     {
         ALCcontext *Context = device->Contexts[i];
         ALsource *source;
         ALsizei pos;
 
-        SuspendContext(Context);
-
         for(pos = 0;pos < Context->SourceMap.size;pos++)
         {
             source = Context->SourceMap.array[pos].value;
@@ -1110,9 +1220,8 @@ ALvoid aluHandleDisconnect(ALCdevice *device)
                 source->position_fraction = 0;
             }
         }
-        ProcessContext(Context);
     }
 
     device->Connected = ALC_FALSE;
-    ProcessContext(NULL);
+    UnlockDevice(device);
 }
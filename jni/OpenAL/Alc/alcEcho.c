@@ -34,7 +34,7 @@ typedef struct ALechoState {
     // Must be first in all effects!
     ALeffectState state;
 
-    ALfp *SampleBuffer;
+    ALsample *SampleBuffer;
     ALuint BufferLength;
 
     // The echo is two tap. The delay is the number of samples from before the
@@ -44,15 +44,15 @@ typedef struct ALechoState {
     } Tap[2];
     ALuint Offset;
     // The LR gains for the first tap. The second tap uses the reverse
-    ALfp GainL;
-    ALfp GainR;
+    ALsample GainL;
+    ALsample GainR;
 
-    ALfp FeedGain;
+    ALsample FeedGain;
 
-    ALfp Gain[MAXCHANNELS];
+    ALsample Gain[MAXCHANNELS];
 
     FILTER iirFilter;
-    ALfp history[2];
+    ALsample history[2];
 } ALechoState;
 
 static ALvoid EchoDestroy(ALeffectState *effect)
@@ -81,7 +81,7 @@ static ALboolean EchoDeviceUpdate(ALeffectState *effect, ALCdevice *Device)
     {
         void *temp;
 
-        temp = realloc(state->SampleBuffer, maxlen * sizeof(ALfp));
+        temp = realloc(state->SampleBuffer, maxlen * sizeof(ALsample));
         if(!temp)
             return AL_FALSE;
         state->SampleBuffer = temp;
@@ -117,7 +117,7 @@ static ALvoid EchoUpdate(ALeffectState *effect, ALCcontext *Context, const ALeff
 
     state->FeedGain = Effect->Echo.Feedback;
 
-    cw = __cos(ALfpDiv(float2ALfp(2.0*M_PI * LOWPASSFREQCUTOFF), int2ALfp(frequency)));
+    cw = aluCos(ALfpDiv(float2ALfp(2.0*M_PI * LOWPASSFREQCUTOFF), int2ALfp(frequency)));
     g = (int2ALfp(1) - Effect->Echo.Damping);
     a = int2ALfp(0);
     if(g < float2ALfp(0.9999f)) /* 1-epsilon */ {
@@ -129,44 +129,44 @@ static ALvoid EchoUpdate(ALeffectState *effect, ALCcontext *Context, const ALeff
     state->iirFilter.coeff = a;
 }
 
-static ALvoid EchoProcess(ALeffectState *effect, const ALeffectslot *Slot, ALuint SamplesToDo, const ALfp *SamplesIn, ALfp (*SamplesOut)[MAXCHANNELS])
+static ALvoid EchoProcess(ALeffectState *effect, const ALeffectslot *Slot, ALuint SamplesToDo, const ALsample *SamplesIn, ALsample (*SamplesOut)[BUFFERSIZE])
 {
     ALechoState *state = (ALechoState*)effect;
     const ALuint mask = state->BufferLength-1;
     const ALuint tap1 = state->Tap[0].delay;
     const ALuint tap2 = state->Tap[1].delay;
     ALuint offset = state->Offset;
-    const ALfp gain = Slot->Gain;
-    ALfp samp[2], smp;
+    const ALsample gain = Slot->Gain;
+    ALsample samp[2], smp;
     ALuint i;
 
     for(i = 0;i < SamplesToDo;i++,offset++)
     {
         // Sample first tap
         smp = state->SampleBuffer[(offset-tap1) & mask];
-        samp[0] = ALfpMult(smp, state->GainL);
-        samp[1] = ALfpMult(smp, state->GainR);
+        samp[0] = ALsampleMult(smp, state->GainL);
+        samp[1] = ALsampleMult(smp, state->GainR);
         // Sample second tap. Reverse LR panning
         smp = state->SampleBuffer[(offset-tap2) & mask];
-        samp[0] += ALfpMult(smp, state->GainR);
-        samp[1] += ALfpMult(smp, state->GainL);
+        samp[0] += ALsampleMult(smp, state->GainR);
+        samp[1] += ALsampleMult(smp, state->GainL);
 
         // Apply damping and feedback gain to the second tap, and mix in the
         // new sample
         smp = lpFilter2P(&state->iirFilter, 0, (smp+SamplesIn[i]));
-        state->SampleBuffer[offset&mask] = ALfpMult(smp, state->FeedGain);
+        state->SampleBuffer[offset&mask] = ALsampleMult(smp, state->FeedGain);
 
         // Apply slot gain
-        samp[0] = ALfpMult(samp[0], gain);
-        samp[1] = ALfpMult(samp[1], gain);
+        samp[0] = ALsampleMult(samp[0], gain);
+        samp[1] = ALsampleMult(samp[1], gain);
 
-        SamplesOut[i][FRONT_LEFT]  += ALfpMult(state->Gain[FRONT_LEFT],  samp[0]);
-        SamplesOut[i][FRONT_RIGHT] += ALfpMult(state->Gain[FRONT_RIGHT], samp[1]);
+        SamplesOut[FRONT_LEFT][i]  += ALsampleMult(state->Gain[FRONT_LEFT],  samp[0]);
+        SamplesOut[FRONT_RIGHT][i] += ALsampleMult(state->Gain[FRONT_RIGHT], samp[1]);
 #ifdef APPORTABLE_OPTIMIZED_OUT
-        SamplesOut[i][SIDE_LEFT]   += ALfpMult(state->Gain[SIDE_LEFT],   samp[0]);
-        SamplesOut[i][SIDE_RIGHT]  += ALfpMult(state->Gain[SIDE_RIGHT],  samp[1]);
-        SamplesOut[i][BACK_LEFT]   += ALfpMult(state->Gain[BACK_LEFT],   samp[0]);
-        SamplesOut[i][BACK_RIGHT]  += ALfpMult(state->Gain[BACK_RIGHT],  samp[1]);
+        SamplesOut[SIDE_LEFT][i]   += ALfpMult(state->Gain[SIDE_LEFT],   samp[0]);
+        SamplesOut[SIDE_RIGHT][i]  += ALfpMult(state->Gain[SIDE_RIGHT],  samp[1]);
+        SamplesOut[BACK_LEFT][i]   += ALfpMult(state->Gain[BACK_LEFT],   samp[0]);
+        SamplesOut[BACK_RIGHT][i]  += ALfpMult(state->Gain[BACK_RIGHT],  samp[1]);
 #endif
 
     }
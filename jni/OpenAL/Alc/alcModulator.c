@@ -43,10 +43,10 @@ typedef struct ALmodulatorState {
     ALuint index;
     ALuint step;
 
-    ALfp Gain[MAXCHANNELS];
+    ALsample Gain[MAXCHANNELS];
 
     FILTER iirFilter;
-    ALfp history[1];
+    ALsample history[1];
 } ALmodulatorState;
 
 #define WAVEFORM_FRACBITS  16
@@ -54,7 +54,7 @@ typedef struct ALmodulatorState {
 
 static __inline ALfp sin_func(ALuint index)
 {
-    return __sin(ALdfpMult(ALdfpDiv(int2ALdfp(index),double2ALdfp(1<<WAVEFORM_FRACBITS)), double2ALdfp(M_PI * 2.0f)));
+    return aluSin(ALdfpMult(ALdfpDiv(int2ALdfp(index),double2ALdfp(1<<WAVEFORM_FRACBITS)), double2ALdfp(M_PI * 2.0f)));
 }
 
 static __inline ALfp saw_func(ALuint index)
@@ -68,13 +68,13 @@ static __inline ALfp square_func(ALuint index)
 }
 
 
-static __inline ALfp hpFilter1P(FILTER *iir, ALuint offset, ALfp input)
+static __inline ALsample hpFilter1P(FILTER *iir, ALuint offset, ALsample input)
 {
-    ALfp *history = &iir->history[offset];
-    ALfp a = iir->coeff;
-    ALfp output = input;
+    ALsample *history = &iir->history[offset];
+    ALsample a = iir->coeff;
+    ALsample output = input;
 
-    output = (output + ALfpMult((history[0]-output),a));
+    output = (output + ALsampleMult((history[0]-output),a));
     history[0] = output;
 
     return (input - output);
@@ -122,7 +122,7 @@ static ALvoid ModulatorUpdate(ALeffectState *effect, ALCcontext *Context, const
     if(!state->step)
         state->step = 1;
 
-    cw = __cos(ALfpDiv(ALfpMult(float2ALfp(2.0*M_PI),
+    cw = aluCos(ALfpDiv(ALfpMult(float2ALfp(2.0*M_PI),
                                 Effect->Modulator.HighPassCutoff),
                        int2ALfp(Context->Device->Frequency)));
     a = ((int2ALfp(2)-cw) -
@@ -130,13 +130,13 @@ static ALvoid ModulatorUpdate(ALeffectState *effect, ALCcontext *Context, const
     state->iirFilter.coeff = a;
 }
 
-static ALvoid ModulatorProcess(ALeffectState *effect, const ALeffectslot *Slot, ALuint SamplesToDo, const ALfp *SamplesIn, ALfp (*SamplesOut)[MAXCHANNELS])
+static ALvoid ModulatorProcess(ALeffectState *effect, const ALeffectslot *Slot, ALuint SamplesToDo, const ALsample *SamplesIn, ALsample (*SamplesOut)[BUFFERSIZE])
 {
     ALmodulatorState *state = (ALmodulatorState*)effect;
-    const ALfp gain = Slot->Gain;
+    const ALsample gain = Slot->Gain;
     const ALuint step = state->step;
     ALuint index = state->index;
-    ALfp samp;
+    ALsample samp;
     ALuint i;
 
     switch(state->Waveform)
@@ -157,14 +157,14 @@ static ALvoid ModulatorProcess(ALeffectState *effect, const ALeffectslot *Slot,
     /* Apply slot gain */                                                     \
     samp *= gain;                                                             \
                                                                               \
-    SamplesOut[i][FRONT_LEFT]   += state->Gain[FRONT_LEFT]   * samp;          \
-    SamplesOut[i][FRONT_RIGHT]  += state->Gain[FRONT_RIGHT]  * samp;          \
-    SamplesOut[i][FRONT_CENTER] += state->Gain[FRONT_CENTER] * samp;          \
-    SamplesOut[i][SIDE_LEFT]    += state->Gain[SIDE_LEFT]    * samp;          \
-    SamplesOut[i][SIDE_RIGHT]   += state->Gain[SIDE_RIGHT]   * samp;          \
-    SamplesOut[i][BACK_LEFT]    += state->Gain[BACK_LEFT]    * samp;          \
-    SamplesOut[i][BACK_RIGHT]   += state->Gain[BACK_RIGHT]   * samp;          \
-    SamplesOut[i][BACK_CENTER]  += state->Gain[BACK_CENTER]  * samp;          \
+    SamplesOut[FRONT_LEFT][i]   += state->Gain[FRONT_LEFT]   * samp;          \
+    SamplesOut[FRONT_RIGHT][i]  += state->Gain[FRONT_RIGHT]  * samp;          \
+    SamplesOut[FRONT_CENTER][i] += state->Gain[FRONT_CENTER] * samp;          \
+    SamplesOut[SIDE_LEFT][i]    += state->Gain[SIDE_LEFT]    * samp;          \
+    SamplesOut[SIDE_RIGHT][i]   += state->Gain[SIDE_RIGHT]   * samp;          \
+    SamplesOut[BACK_LEFT][i]    += state->Gain[BACK_LEFT]    * samp;          \
+    SamplesOut[BACK_RIGHT][i]   += state->Gain[BACK_RIGHT]   * samp;          \
+    SamplesOut[BACK_CENTER][i]  += state->Gain[BACK_CENTER]  * samp;          \
 } while(0)
 #else      	
 //Apportable optimized version
@@ -173,15 +173,15 @@ static ALvoid ModulatorProcess(ALeffectState *effect, const ALeffectslot *Slot,
                                                                               \
     index += step;                                                            \
     index &= WAVEFORM_FRACMASK;                                               \
-    samp = ALfpMult(samp, func(index));                                       \
+    samp = ALsampleMult(samp, func(index));                                   \
                                                                               \
     samp = hpFilter1P(&state->iirFilter, 0, samp);                            \
                                                                               \
     /* Apply slot gain */                                                     \
-    samp = ALfpMult(samp, gain);                                              \
+    samp = ALsampleMult(samp, gain);                                          \
                                                                               \
-    SamplesOut[i][FRONT_LEFT]   += ALfpMult(state->Gain[FRONT_LEFT], samp);   \
-    SamplesOut[i][FRONT_RIGHT]  += ALfpMult(state->Gain[FRONT_RIGHT], samp);  \
+    SamplesOut[FRONT_LEFT][i]   += ALsampleMult(state->Gain[FRONT_LEFT], samp); \
+    SamplesOut[FRONT_RIGHT][i]  += ALsampleMult(state->Gain[FRONT_RIGHT], samp); \
 } while(0)
 #endif	
             FILTER_OUT(sin_func);
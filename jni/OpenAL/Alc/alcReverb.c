@@ -329,14 +329,14 @@ static __inline ALfp CalcDecayCoeff(ALfp length, ALfp decayTime)
 // reaches -60 dB.
 static __inline ALfp CalcDecayLength(ALfp coeff, ALfp decayTime)
 {
-    return ALfpMult(ALfpMult(ALfpDiv(__log10(coeff), int2ALfp(-60)), int2ALfp(20)), decayTime);
+    return ALfpMult(ALfpMult(ALfpDiv(aluLog10(coeff), int2ALfp(-60)), int2ALfp(20)), decayTime);
 }
 
 // Calculate the high frequency parameter for the I3DL2 coefficient
 // calculation.
 static __inline ALfp CalcI3DL2HFreq(ALfp hfRef, ALuint frequency)
 {
-    return __cos(ALfpDiv(ALfpMult(float2ALfp(2.0f * M_PI), hfRef), int2ALfp(frequency)));
+    return aluCos(ALfpDiv(ALfpMult(float2ALfp(2.0f * M_PI), hfRef), int2ALfp(frequency)));
 }
 
 // Calculate an attenuation to be applied to the input of any echo models to
@@ -366,12 +366,12 @@ static __inline ALvoid CalcMatrixCoeffs(ALfp diffusion, ALfp *x, ALfp *y)
 
     // The matrix is of order 4, so n is sqrt (4 - 1).
     n = aluSqrt(int2ALfp(3));
-    t = ALfpMult(diffusion, __atan(n));
+    t = ALfpMult(diffusion, aluAtan(n));
 
     // Calculate the first mixing matrix coefficient.
-    *x = __cos(t);
+    *x = aluCos(t);
     // Calculate the second mixing matrix coefficient.
-    *y = ALfpDiv(__sin(t), n);
+    *y = ALfpDiv(aluSin(t), n);
 }
 
 // Calculate the limited HF ratio for use with the late reverb low-pass
@@ -711,7 +711,7 @@ static __inline ALfp EAXModulation(ALverbState *State, ALfp in)
     // Calculate the sinus rythm (dependent on modulation time and the
     // sampling rate).  The center of the sinus is moved to reduce the delay
     // of the effect when the time or depth are low.
-    sinus = (int2ALfp(1) - __cos(ALfpDiv(ALfpMult(float2ALfp(2.0f * M_PI), int2ALfp(State->Mod.Index)), int2ALfp(State->Mod.Range))));
+    sinus = (int2ALfp(1) - aluCos(ALfpDiv(ALfpMult(float2ALfp(2.0f * M_PI), int2ALfp(State->Mod.Index)), int2ALfp(State->Mod.Range))));
 
     // The depth determines the range over which to read the input samples
     // from, so it must be filtered to reduce the distortion caused by even
@@ -1177,7 +1177,7 @@ static ALvoid EAXVerbUpdate(ALeffectState *effect, ALCcontext *Context, const AL
 
 // This processes the reverb state, given the input samples and an output
 // buffer.
-static ALvoid VerbProcess(ALeffectState *effect, const ALeffectslot *Slot, ALuint SamplesToDo, const ALfp *SamplesIn, ALfp (*SamplesOut)[MAXCHANNELS])
+static ALvoid VerbProcess(ALeffectState *effect, const ALeffectslot *Slot, ALuint SamplesToDo, const ALsample *SamplesIn, ALsample (*SamplesOut)[BUFFERSIZE])
 {
     ALverbState *State = (ALverbState*)effect;
     ALuint index;
@@ -1199,22 +1199,22 @@ static ALvoid VerbProcess(ALeffectState *effect, const ALeffectslot *Slot, ALuin
 #endif
 
         // Output the results.
-        SamplesOut[index][FRONT_LEFT]   = (SamplesOut[index][FRONT_LEFT]   + ALfpMult(panGain[FRONT_LEFT]   , out[0]));
-        SamplesOut[index][FRONT_RIGHT]  = (SamplesOut[index][FRONT_RIGHT]  + ALfpMult(panGain[FRONT_RIGHT]  , out[1]));
+        SamplesOut[FRONT_LEFT][index]   = (SamplesOut[FRONT_LEFT][index]   + ALfpMult(panGain[FRONT_LEFT]   , out[0]));
+        SamplesOut[FRONT_RIGHT][index]  = (SamplesOut[FRONT_RIGHT][index]  + ALfpMult(panGain[FRONT_RIGHT]  , out[1]));
 #ifdef APPORTABLE_OPTIMIZED_OUT
-        SamplesOut[index][FRONT_CENTER] = (SamplesOut[index][FRONT_CENTER] + ALfpMult(panGain[FRONT_CENTER] , out[3]));
-        SamplesOut[index][SIDE_LEFT]    = (SamplesOut[index][SIDE_LEFT]    + ALfpMult(panGain[SIDE_LEFT]    , out[0]));
-        SamplesOut[index][SIDE_RIGHT]   = (SamplesOut[index][SIDE_RIGHT]   + ALfpMult(panGain[SIDE_RIGHT]   , out[1]));
-        SamplesOut[index][BACK_LEFT]    = (SamplesOut[index][BACK_LEFT]    + ALfpMult(panGain[BACK_LEFT]    , out[0]));
-        SamplesOut[index][BACK_RIGHT]   = (SamplesOut[index][BACK_RIGHT]   + ALfpMult(panGain[BACK_RIGHT]   , out[1]));
-        SamplesOut[index][BACK_CENTER]  = (SamplesOut[index][BACK_CENTER]  + ALfpMult(panGain[BACK_CENTER]  , out[2]));
+        SamplesOut[FRONT_CENTER][index] = (SamplesOut[FRONT_CENTER][index] + ALfpMult(panGain[FRONT_CENTER] , out[3]));
+        SamplesOut[SIDE_LEFT][index]    = (SamplesOut[SIDE_LEFT][index]    + ALfpMult(panGain[SIDE_LEFT]    , out[0]));
+        SamplesOut[SIDE_RIGHT][index]   = (SamplesOut[SIDE_RIGHT][index]   + ALfpMult(panGain[SIDE_RIGHT]   , out[1]));
+        SamplesOut[BACK_LEFT][index]    = (SamplesOut[BACK_LEFT][index]    + ALfpMult(panGain[BACK_LEFT]    , out[0]));
+        SamplesOut[BACK_RIGHT][index]   = (SamplesOut[BACK_RIGHT][index]   + ALfpMult(panGain[BACK_RIGHT]   , out[1]));
+        SamplesOut[BACK_CENTER][index]  = (SamplesOut[BACK_CENTER][index]  + ALfpMult(panGain[BACK_CENTER]  , out[2]));
 #endif
     }
 }
 
 // This processes the EAX reverb state, given the input samples and an output
 // buffer.
-static ALvoid EAXVerbProcess(ALeffectState *effect, const ALeffectslot *Slot, ALuint SamplesToDo, const ALfp *SamplesIn, ALfp (*SamplesOut)[MAXCHANNELS])
+static ALvoid EAXVerbProcess(ALeffectState *effect, const ALeffectslot *Slot, ALuint SamplesToDo, const ALsample *SamplesIn, ALsample (*SamplesOut)[BUFFERSIZE])
 {
     ALverbState *State = (ALverbState*)effect;
     ALuint index;
@@ -1229,29 +1229,29 @@ static ALvoid EAXVerbProcess(ALeffectState *effect, const ALeffectslot *Slot, AL
         // Unfortunately, while the number and configuration of gains for
         // panning adjust according to MAXCHANNELS, the output from the
         // reverb engine is not so scalable.
-        SamplesOut[index][FRONT_LEFT] = (SamplesOut[index][FRONT_LEFT] +
+        SamplesOut[FRONT_LEFT][index] = (SamplesOut[FRONT_LEFT][index] +
            ALfpMult((ALfpMult(State->Early.PanGain[FRONT_LEFT],early[0]) +
             ALfpMult(State->Late.PanGain[FRONT_LEFT],late[0])), gain));
-        SamplesOut[index][FRONT_RIGHT] = (SamplesOut[index][FRONT_RIGHT] +
+        SamplesOut[FRONT_RIGHT][index] = (SamplesOut[FRONT_RIGHT][index] +
            ALfpMult((ALfpMult(State->Early.PanGain[FRONT_RIGHT],early[1]) +
             ALfpMult(State->Late.PanGain[FRONT_RIGHT],late[1])), gain));
 #ifdef APPORTABLE_OPTIMIZED_OUT
-        SamplesOut[index][FRONT_CENTER] = (SamplesOut[index][FRONT_CENTER] +
+        SamplesOut[FRONT_CENTER][index] = (SamplesOut[FRONT_CENTER][index] +
            ALfpMult((ALfpMult(State->Early.PanGain[FRONT_LEFT],early[3]) +
             ALfpMult(State->Late.PanGain[FRONT_CENTER],late[3])), gain));
-        SamplesOut[index][SIDE_LEFT] = (SamplesOut[index][SIDE_LEFT] +
+        SamplesOut[SIDE_LEFT][index] = (SamplesOut[SIDE_LEFT][index] +
            ALfpMult((ALfpMult(State->Early.PanGain[SIDE_LEFT],early[0]) +
             ALfpMult(State->Late.PanGain[SIDE_LEFT],late[0])), gain));
-        SamplesOut[index][SIDE_RIGHT] = (SamplesOut[index][SIDE_RIGHT] +
+        SamplesOut[SIDE_RIGHT][index] = (SamplesOut[SIDE_RIGHT][index] +
            ALfpMult((ALfpMult(State->Early.PanGain[SIDE_RIGHT],early[1]) +
             ALfpMult(State->Late.PanGain[SIDE_RIGHT],late[1])), gain));
-        SamplesOut[index][BACK_LEFT] = (SamplesOut[index][BACK_LEFT] +
+        SamplesOut[BACK_LEFT][index] = (SamplesOut[BACK_LEFT][index] +
            ALfpMult((ALfpMult(State->Early.PanGain[BACK_LEFT],early[0]) +
             ALfpMult(State->Late.PanGain[BACK_LEFT],late[0])), gain));
-        SamplesOut[index][BACK_RIGHT] = (SamplesOut[index][BACK_RIGHT] +
+        SamplesOut[BACK_RIGHT][index] = (SamplesOut[BACK_RIGHT][index] +
            ALfpMult((ALfpMult(State->Early.PanGain[BACK_RIGHT],early[1]) +
             ALfpMult(State->Late.PanGain[BACK_RIGHT],late[1])), gain));
-        SamplesOut[index][BACK_CENTER] = (SamplesOut[index][BACK_CENTER] +
+        SamplesOut[BACK_CENTER][index] = (SamplesOut[BACK_CENTER][index] +
            ALfpMult((ALfpMult(State->Early.PanGain[BACK_CENTER],early[2]) +
             ALfpMult(State->Late.PanGain[BACK_CENTER],late[2])), gain));
 #endif
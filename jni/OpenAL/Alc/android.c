@@ -1,4 +1,6 @@
 #ifdef ANDROID
+#include "config.h"
+
 #include <jni.h>
 #include "alMain.h"
 #include "apportable_openal_funcs.h"
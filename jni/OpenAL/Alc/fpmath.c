@@ -0,0 +1,336 @@
+/**
+ * OpenAL cross platform audio library
+ * Copyright (C) 2011 by authors.
+ * This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ *  License along with this library; if not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ *  Boston, MA  02111-1307, USA.
+ * Or go to http://www.gnu.org/copyleft/lgpl.html
+ */
+
+#include "config.h"
+
+#include "alMain.h"
+#include "AL/al.h"
+#include "AL/alc.h"
+#include "alu.h"
+
+#ifdef OPENAL_FIXED_POINT
+
+/* Math functions for fixed-point builds, which otherwise go through soft-float
+ * libm calls on armeabi. The work is done in 2.30 fixed-point with 32x32->64
+ * bit multiplies, and the results are rounded to ALfp. Checked against libm
+ * over the ranges OpenAL uses them for, they are within one unit of the last
+ * ALfp bit (relative to the result, for pow and exp over 1). */
+
+#define Q30_ONE     ((ALint)1<<30)
+#define Q30_LN2     744261118
+#define Q30_INV_LN2 1549082005
+#define Q30_LOG10_2 323228497
+#define Q30_PI      ((int64_t)3373259426LL)
+#define Q30_PI_2    1686629713
+
+/* Turns per radian in 16.16, times 2^32 */
+#define TURNS_PER_RAD 683565276
+
+#define FP_SHIFT OPENAL_FIXED_POINT_SHIFT
+
+/* log2(1 + i/32) and 1/(1 + i/32) */
+static const ALint Log2Tab[32] = {
+             0,   47667823,   93912511,  138816582,  182455581,  224898839,
+     266210141,  306448299,  345667660,  383918542,  421247625,  457698295,
+     493310944,  528123241,  562170370,  595485245,  628098702,  660039669,
+     691335320,  722011213,  752091421,  781598637,  810554283,  838978604,
+     866890747,  894308843,  921250079,  947730758,  973766362,  999371606,
+    1024560487, 1049346328
+};
+static const ALint Log2InvTab[32] = {
+    1073741824, 1041204193, 1010580540,  981706811,  954437177,  928641578,
+     904203641,  881018933,  858993459,  838042399,  818089009,  799063683,
+     780903145,  763549742,  746950834,  731058263,  715827883,  701219150,
+     687194767,  673720360,  660764199,  648296950,  636291451,  624722516,
+     613566757,  602802428,  592409282,  582368447,  572662306,  563274399,
+     554189329,  545392673
+};
+
+/* 2^(i/32) */
+static const ALuint Exp2Tab[32] = {
+    1073741824, 1097253708, 1121280436, 1145833280, 1170923762, 1196563654,
+    1222764986, 1249540052, 1276901417, 1304861917, 1333434672, 1362633090,
+    1392470869, 1422962010, 1454120821, 1485961921, 1518500250, 1551751076,
+    1585730000, 1620452965, 1655936265, 1692196547, 1729250827, 1767116489,
+    1805811301, 1845353420, 1885761398, 1927054196, 1969251188, 2012372174,
+    2056437387, 2101467502
+};
+
+/* acos(x) = sqrt(1-x) * P(x) for x in [0,1] (Abramowitz & Stegun 4.4.46) */
+static const ALint AcosPoly[8] = {
+    1686629690, -230423709, 95540460, -53874249, 33169905, -18348235,
+    7161955, -1355589
+};
+
+/* atan(x) = x * P(x^2) for x in [0,1] (Abramowitz & Stegun 4.4.49) */
+static const ALint AtanPoly[9] = {
+    1073741824, -357911922, 214679118, -152566896, 114420763, -80841635,
+    46073847, -17357828, 3077586
+};
+
+/* sin(x*pi/2) = x * P(x^2) for x in [0,1] (Taylor series) */
+static const ALint SinPoly[6] = {
+    1686629713, -693598668, 85569306, -5026995, 172272, -3864
+};
+
+
+static __inline ALint MulQ30(ALint a, ALint b)
+{
+    return (ALint)(((int64_t)a*b) >> 30);
+}
+
+static __inline ALint PolyQ30(const ALint *coeffs, ALuint count, ALint x)
+{
+    ALint r = coeffs[--count];
+    while(count > 0)
+        r = MulQ30(r, x) + coeffs[--count];
+    return r;
+}
+
+/* Rounds a 2.30 value to ALfp */
+static __inline ALfp Q30ToFp(int64_t x)
+{
+    return (x + ((int64_t)1<<(29-FP_SHIFT))) >> (30-FP_SHIFT);
+}
+
+static __inline ALuint HighBit64(uint64_t x)
+{
+    ALuint bit = 0;
+    if(x >= ((uint64_t)1<<32)) { x >>= 32; bit += 32; }
+    if(x >= (1<<16)) { x >>= 16; bit += 16; }
+    if(x >= (1<<8))  { x >>= 8;  bit += 8; }
+    if(x >= (1<<4))  { x >>= 4;  bit += 4; }
+    if(x >= (1<<2))  { x >>= 2;  bit += 2; }
+    if(x >= (1<<1))  { bit += 1; }
+    return bit;
+}
+
+/* Integer square roots, rounded to nearest */
+static ALuint ISqrt32(ALuint x)
+{
+    ALuint res = 0;
+    ALuint bit;
+
+    if(x == 0)
+        return 0;
+    bit = (ALuint)1 << (HighBit64(x)&~1);
+    while(bit != 0)
+    {
+        if(x >= res+bit)
+        {
+            x -= res+bit;
+            res = (res>>1) + bit;
+        }
+        else
+            res >>= 1;
+        bit >>= 2;
+    }
+    if(x > res)
+        res++;
+    return res;
+}
+
+static uint64_t ISqrt64(uint64_t x)
+{
+    uint64_t res = 0;
+    uint64_t bit;
+
+    /* Most values (eg. gains) fit in 32 bits, which is a lot quicker on 32-bit
+     * targets */
+    if(x <= 0xffffffffu)
+        return ISqrt32((ALuint)x);
+    bit = (uint64_t)1 << (HighBit64(x)&~1);
+    while(bit != 0)
+    {
+        if(x >= res+bit)
+        {
+            x -= res+bit;
+            res = (res>>1) + bit;
+        }
+        else
+            res >>= 1;
+        bit >>= 2;
+    }
+    if(x > res)
+        res++;
+    return res;
+}
+
+/* log2(x), for x > 0, in 2.30 */
+static int64_t Log2Q30(ALfp x)
+{
+    ALuint bit = HighBit64(x);
+    ALint m, r;
+    ALuint i;
+
+    /* Normalize to [1,2), then split off the table entry below it, leaving
+     * m = (1 + i/32) * (1 + r) with r under 1/32 */
+    if(bit >= 30) m = (ALint)(x >> (bit-30));
+    else          m = (ALint)(x << (30-bit));
+    i = (m>>25) & 31;
+    r = (ALint)(((int64_t)m*Log2InvTab[i]) >> 30) - Q30_ONE;
+
+    /* log2(1+r) = (r - r^2/2 + r^3/3) / ln(2) */
+    r = MulQ30(r, Q30_ONE - MulQ30(r, Q30_ONE/2 - MulQ30(r, Q30_ONE/3)));
+    r = MulQ30(r, Q30_INV_LN2);
+
+    return ((int64_t)((ALint)bit-FP_SHIFT)<<30) + Log2Tab[i] + r;
+}
+
+/* 2^x, for x in 2.30 */
+static ALfp Exp2Q30(int64_t x)
+{
+    ALint k, f, a;
+    ALuint i;
+    int64_t v;
+
+    /* Past either end of the ALfp range */
+    if(x >= ((int64_t)(62-FP_SHIFT)<<30))
+        return INT64_MAX;
+    if(x < -((int64_t)(FP_SHIFT+2)<<30))
+        return 0;
+    k = (ALint)(x >> 30);
+    f = (ALint)(x & (Q30_ONE-1));
+    i = f >> 25;
+
+    /* 2^f = 2^(i/32) * e^a with a = (f - i/32)*ln(2), under 1/46 */
+    a = MulQ30(f & ((1<<25)-1), Q30_LN2);
+    a = Q30_ONE + a + MulQ30(a, MulQ30(a, Q30_ONE/2 + MulQ30(a, Q30_ONE/6)));
+    v = ((int64_t)Exp2Tab[i]*a) >> 30;
+
+    k += FP_SHIFT - 30;
+    if(k >= 0)
+        return v << k;
+    return (v + ((int64_t)1<<(-k-1))) >> -k;
+}
+
+ALfp aluFpSqrt(ALfp x)
+{
+    ALuint shift;
+
+    if(x <= 0)
+        return 0;
+    /* sqrt(x * 2^FP_SHIFT), with what precision fits for huge values */
+    shift = (62 - HighBit64(x)) & ~1;
+    if(shift >= FP_SHIFT)
+        return (ALfp)ISqrt64((uint64_t)x << FP_SHIFT);
+    return (ALfp)ISqrt64((uint64_t)x << shift) << ((FP_SHIFT-shift)/2);
+}
+
+ALfp aluFpPow(ALfp x, ALfp y)
+{
+    int64_t l;
+
+    if(y == 0)
+        return int2ALfp(1);
+    if(x <= 0)
+        return 0;
+
+    /* 2^(y*log2(x)). log2(x) is under 48, so the product only needs
+     * dropping some precision to fit for large exponents, and exponents past
+     * 2^24 over- or underflow anyway. */
+    l = Log2Q30(x);
+    if(y > -((ALfp)1<<(FP_SHIFT+8)) && y < ((ALfp)1<<(FP_SHIFT+8)))
+        return Exp2Q30((l*y) >> FP_SHIFT);
+    if(y > ((ALfp)1<<(FP_SHIFT+24)))
+        y = (ALfp)1<<(FP_SHIFT+24);
+    else if(y < -((ALfp)1<<(FP_SHIFT+24)))
+        y = -((ALfp)1<<(FP_SHIFT+24));
+    return Exp2Q30((l>>4) * (y>>(FP_SHIFT-4)));
+}
+
+ALfp aluFpExp(ALfp x)
+{
+    /* e^x = 2^(x/ln(2)) */
+    return Exp2Q30((x*Q30_INV_LN2) >> FP_SHIFT);
+}
+
+ALfp aluFpLog10(ALfp x)
+{
+    /* There's no -inf, so clamp to the smallest value instead */
+    if(x <= 0)
+        x = 1;
+    return Q30ToFp((Log2Q30(x) * Q30_LOG10_2) >> 30);
+}
+
+ALfp aluFpAcos(ALfp x)
+{
+    ALfp a = (x < 0) ? -x : x;
+    ALint s, r;
+
+    /* acos(-x) = pi - acos(x) */
+    if(a >= int2ALfp(1))
+        r = 0;
+    else
+    {
+        a <<= 30-FP_SHIFT;
+        s = (ALint)ISqrt64((uint64_t)(Q30_ONE-a) << 30);
+        r = MulQ30(s, PolyQ30(AcosPoly, 8, (ALint)a));
+    }
+    if(x < 0)
+        return Q30ToFp(Q30_PI - r);
+    return Q30ToFp(r);
+}
+
+ALfp aluFpAtan(ALfp x)
+{
+    int64_t a = (x < 0) ? -x : x;
+    ALint t, r;
+
+    /* atan(x) = pi/2 - atan(1/x), for x > 1 */
+    if(a > int2ALfp(1))
+        t = (ALint)(((int64_t)1<<(30+FP_SHIFT)) / a);
+    else
+        t = (ALint)(a << (30-FP_SHIFT));
+
+    r = MulQ30(t, PolyQ30(AtanPoly, 9, MulQ30(t, t)));
+    if(a > int2ALfp(1))
+        r = Q30_PI_2 - r;
+    return Q30ToFp((x < 0) ? -r : r);
+}
+
+/* sin of a phase in 0.32 turns */
+static ALfp SinTurns(ALuint phase)
+{
+    ALuint quadrant = phase >> 30;
+    ALint t = (ALint)(phase & (Q30_ONE-1));
+    ALint r;
+
+    /* sin is symmetric about each quarter turn */
+    if((quadrant&1))
+        t = Q30_ONE - t;
+    r = MulQ30(t, PolyQ30(SinPoly, 6, MulQ30(t, t)));
+    if((quadrant&2))
+        r = -r;
+    return Q30ToFp(r);
+}
+
+ALfp aluFpSin(ALfp x)
+{
+    return SinTurns((ALuint)((x*TURNS_PER_RAD) >> FP_SHIFT));
+}
+
+ALfp aluFpCos(ALfp x)
+{
+    /* cos(x) = sin(x + a quarter turn) */
+    return SinTurns((ALuint)((x*TURNS_PER_RAD) >> FP_SHIFT) + (1u<<30));
+}
+
+#endif
@@ -35,6 +35,14 @@
 #include "alAuxEffectSlot.h"
 #include "alu.h"
 #include "bs2b.h"
+#include "mixer_defs.h"
+
+#if defined(HAVE_NEON) && defined(ANDROID)
+#include <cpu-features.h>
+#endif
+#if defined(HAVE_SSE2) && !defined(__x86_64__)
+#include <cpuid.h>
+#endif
 
 
 static __inline ALdfp point32(const ALfp *vals, ALint step, ALint frac)
@@ -45,15 +53,34 @@ static __inline ALdfp cubic32(const ALfp *vals, ALint step, ALint frac)
 { return cubic(vals[-step], vals[0], vals[step], vals[step+step],
                ALfpMult(int2ALfp(frac), ALfpDiv(int2ALfp(1),int2ALfp(FRACTIONONE)))); }
 
+#ifdef OPENAL_FIXED_POINT
+/* Interpolates two integer samples into a 16.16 value. Integer formats stay
+ * well inside 32 bits here, so these avoid the 64-bit ALfp math entirely and
+ * still match the generic versions bit for bit. */
+static __inline ALsample lerpi(ALint val1, ALint val2, ALint frac)
+{ return (val1*FRACTIONONE + (val2-val1)*frac) << (OPENAL_FIXED_POINT_SHIFT-FRACTIONBITS); }
+
+static __inline ALsample point16(const ALshort *vals, ALint step, ALint frac)
+{ return ALsampleMult((ALsample)vals[0] << OPENAL_FIXED_POINT_SHIFT, float2ALfp(1.0/32767.0)); (void)step; (void)frac; }
+static __inline ALsample lerp16(const ALshort *vals, ALint step, ALint frac)
+{ return ALsampleMult(lerpi(vals[0], vals[step], frac), float2ALfp(1.0/32767.0)); }
+#else
 static __inline ALdfp point16(const ALshort *vals, ALint step, ALint frac)
 { return ALfpMult(int2ALfp(vals[0]), float2ALfp(1.0/32767.0)); (void)step; (void)frac; }
 static __inline ALdfp lerp16(const ALshort *vals, ALint step, ALint frac)
 { return ALfpMult(lerp(int2ALfp(vals[0]), int2ALfp(vals[step]), ALfpMult(int2ALfp(frac), ALfpDiv(int2ALfp(1),int2ALfp(FRACTIONONE)))),
 	                     float2ALfp(1.0/32767.0)); }
+#endif
 static __inline ALdfp cubic16(const ALshort *vals, ALint step, ALint frac)
 { return ALfpMult(cubic(int2ALfp(vals[-step]), int2ALfp(vals[0]), int2ALfp(vals[step]), int2ALfp(vals[step+step]),
                ALfpMult(int2ALfp(frac), ALfpDiv(int2ALfp(1),int2ALfp(FRACTIONONE)))), float2ALfp(1.0/32767.0)); }
 
+#ifdef OPENAL_FIXED_POINT
+static __inline ALsample point8(const ALubyte *vals, ALint step, ALint frac)
+{ return ALsampleMult(((ALsample)vals[0]-128) << OPENAL_FIXED_POINT_SHIFT, float2ALfp(1.0/127.0)); (void)step; (void)frac; }
+static __inline ALsample lerp8(const ALubyte *vals, ALint step, ALint frac)
+{ return ALsampleMult(lerpi((ALint)vals[0]-128, (ALint)vals[step]-128, frac), float2ALfp(1.0/127.0)); }
+#else
 static __inline ALdfp point8(const ALubyte *vals, ALint step, ALint frac)
 { return ALfpMult(int2ALfp((int)vals[0]-128), float2ALfp(1.0/127.0)); (void)step; (void)frac; }
 static __inline ALdfp lerp8(const ALubyte *vals, ALint step, ALint frac)
@@ -61,6 +88,7 @@ static __inline ALdfp lerp8(const ALubyte *vals, ALint step, ALint frac)
                                               ALfpMult(int2ALfp(frac), ALfpDiv(int2ALfp(1),int2ALfp(FRACTIONONE))))-
                                          int2ALfp(128)),
                          float2ALfp(1.0/127.0)); }
+#endif
 static __inline ALdfp cubic8(const ALubyte *vals, ALint step, ALint frac)
 { return ALfpMult((cubic(int2ALfp(vals[-step]), int2ALfp(vals[0]), int2ALfp(vals[step]), int2ALfp(vals[step+step]),
                                                ALfpMult(int2ALfp(frac), ALfpDiv(int2ALfp(1),int2ALfp(FRACTIONONE))))-
@@ -69,117 +97,21 @@ static __inline ALdfp cubic8(const ALubyte *vals, ALint step, ALint frac)
 
 
 #define DECL_TEMPLATE(T, sampler)                                             \
-static void Mix_##T##_1_##sampler(ALsource *Source, ALCdevice *Device,        \
-  const T *data, ALuint *DataPosInt, ALuint *DataPosFrac,                     \
-  ALuint OutPos, ALuint SamplesToDo, ALuint BufferSize)                       \
+static ALvoid Resample_##T##_##sampler(const ALvoid *src, ALuint chan,        \
+  ALuint chans, ALuint frac, ALuint increment, ALsample *dst, ALuint dstlen)  \
 {                                                                             \
-    ALfp (*DryBuffer)[MAXCHANNELS];                                           \
-    ALfp *ClickRemoval, *PendingClicks;                                       \
-    ALuint pos, frac;                                                         \
-    ALfp DrySend[MAXCHANNELS];                                                \
-    FILTER *DryFilter;                                                        \
-    ALuint BufferIdx;                                                         \
-    ALuint increment;                                                         \
-    ALuint out, c;                                                            \
-    ALfp value;                                                               \
-                                                                              \
-    increment = Source->Params.Step;                                          \
-                                                                              \
-    DryBuffer = Device->DryBuffer;                                            \
-    ClickRemoval = Device->ClickRemoval;                                      \
-    PendingClicks = Device->PendingClicks;                                    \
-    DryFilter = &Source->Params.iirFilter;                                    \
-    for(c = 0;c < MAXCHANNELS;c++)                                            \
-        DrySend[c] = Source->Params.DryGains[0][c];                           \
-                                                                              \
-    pos = 0;                                                                  \
-    frac = *DataPosFrac;                                                      \
-                                                                              \
-    if(OutPos == 0)                                                           \
-    {                                                                         \
-        value = sampler(data+pos, 1, frac);                                   \
+    const T *data = (const T*)src + chan;                                     \
+    ALuint pos = 0;                                                           \
+    ALuint i;                                                                 \
                                                                               \
-        value = lpFilter4PC(DryFilter, 0, value);                             \
-        for(c = 0;c < MAXCHANNELS;c++)                                        \
-            ClickRemoval[c] = (ClickRemoval[c] - ALfpMult(value,DrySend[c])); \
-    }                                                                         \
-    for(BufferIdx = 0;BufferIdx < BufferSize;BufferIdx++)                     \
+    for(i = 0;i < dstlen;i++)                                                 \
     {                                                                         \
-        /* First order interpolator */                                        \
-        value = sampler(data+pos, 1, frac);                                   \
-                                                                              \
-        /* Direct path final mix buffer and panning */                        \
-        value = lpFilter4P(DryFilter, 0, value);                              \
-        for(c = 0;c < MAXCHANNELS;c++)                                        \
-            DryBuffer[OutPos][c] = (DryBuffer[OutPos][c] + ALfpMult(value,DrySend[c])); \
+        dst[i] = sampler(data + pos*chans, chans, frac);                      \
                                                                               \
         frac += increment;                                                    \
         pos  += frac>>FRACTIONBITS;                                           \
         frac &= FRACTIONMASK;                                                 \
-        OutPos++;                                                             \
-    }                                                                         \
-    if(OutPos == SamplesToDo)                                                 \
-    {                                                                         \
-        value = sampler(data+pos, 1, frac);                                   \
-                                                                              \
-        value = lpFilter4PC(DryFilter, 0, value);                             \
-        for(c = 0;c < MAXCHANNELS;c++)                                        \
-            PendingClicks[c] = (PendingClicks[c] + ALfpMult(value,DrySend[c])); \
     }                                                                         \
-                                                                              \
-    for(out = 0;out < Device->NumAuxSends;out++)                              \
-    {                                                                         \
-        ALfp  WetSend;                                                        \
-        ALfp *WetBuffer;                                                      \
-        ALfp *WetClickRemoval;                                                \
-        ALfp *WetPendingClicks;                                               \
-        FILTER  *WetFilter;                                                   \
-                                                                              \
-        if(!Source->Send[out].Slot ||                                         \
-           Source->Send[out].Slot->effect.type == AL_EFFECT_NULL)             \
-            continue;                                                         \
-                                                                              \
-        WetBuffer = Source->Send[out].Slot->WetBuffer;                        \
-        WetClickRemoval = Source->Send[out].Slot->ClickRemoval;               \
-        WetPendingClicks = Source->Send[out].Slot->PendingClicks;             \
-        WetFilter = &Source->Params.Send[out].iirFilter;                      \
-        WetSend = Source->Params.Send[out].WetGain;                           \
-                                                                              \
-        pos = 0;                                                              \
-        frac = *DataPosFrac;                                                  \
-        OutPos -= BufferSize;                                                 \
-                                                                              \
-        if(OutPos == 0)                                                       \
-        {                                                                     \
-            value = sampler(data+pos, 1, frac);                               \
-                                                                              \
-            value = lpFilter2PC(WetFilter, 0, value);                         \
-            WetClickRemoval[0] = (WetClickRemoval[0] - ALfpMult(value,WetSend)); \
-        }                                                                     \
-        for(BufferIdx = 0;BufferIdx < BufferSize;BufferIdx++)                 \
-        {                                                                     \
-            /* First order interpolator */                                    \
-            value = sampler(data+pos, 1, frac);                               \
-                                                                              \
-            /* Room path final mix buffer and panning */                      \
-            value = lpFilter2P(WetFilter, 0, value);                          \
-            WetBuffer[OutPos] = (WetBuffer[OutPos] + ALfpMult(value,WetSend)); \
-                                                                              \
-            frac += increment;                                                \
-            pos  += frac>>FRACTIONBITS;                                       \
-            frac &= FRACTIONMASK;                                             \
-            OutPos++;                                                         \
-        }                                                                     \
-        if(OutPos == SamplesToDo)                                             \
-        {                                                                     \
-            value = sampler(data+pos, 1, frac);                               \
-                                                                              \
-            value = lpFilter2PC(WetFilter, 0, value);                         \
-            WetPendingClicks[0] = (WetPendingClicks[0] + ALfpMult(value,WetSend)); \
-        }                                                                     \
-    }                                                                         \
-    *DataPosInt += pos;                                                       \
-    *DataPosFrac = frac;                                                      \
 }
 
 DECL_TEMPLATE(ALfp, point32)
@@ -196,29 +128,396 @@ DECL_TEMPLATE(ALubyte, cubic8)
 
 #undef DECL_TEMPLATE
 
+#define DECL_TEMPLATE(T, sampler)                                             \
+static ALvoid Copy_##T(const ALvoid *src, ALuint chan, ALuint chans,          \
+  ALuint frac, ALuint increment, ALsample *dst, ALuint dstlen)                \
+{                                                                             \
+    const T *data = (const T*)src + chan;                                     \
+    ALuint i;                                                                 \
+                                                                              \
+    for(i = 0;i < dstlen;i++)                                                 \
+        dst[i] = sampler(data + i*chans, chans, 0);                           \
+    (void)frac;                                                               \
+    (void)increment;                                                          \
+}
+
+DECL_TEMPLATE(ALfp, point32)
+DECL_TEMPLATE(ALshort, point16)
+DECL_TEMPLATE(ALubyte, point8)
+
+#undef DECL_TEMPLATE
+
+static ALvoid Accumulate_C(ALsample *dst, const ALsample *src, ALuint len)
+{
+    ALuint i;
+    for(i = 0;i < len;i++)
+        dst[i] += src[i];
+}
+
+static ALvoid MatrixMix_C(ALsample *dst, const ALsample *const *in,
+  const ALsample *gain, ALuint count, ALuint len)
+{
+    ALuint i, c;
+    for(i = 0;i < len;i++)
+    {
+        ALsample samp = int2ALfp(0);
+        for(c = 0;c < count;c++)
+            samp += ALsampleMult(in[c][i], gain[c]);
+        dst[i] = samp;
+    }
+}
+
+#define DECL_TEMPLATE(T, func)                                                \
+static ALvoid Store_##T(ALvoid *dst, ALuint stride, const ALsample *src,      \
+  ALuint len)                                                                 \
+{                                                                             \
+    T *out = (T*)dst;                                                         \
+    ALuint i;                                                                 \
+    for(i = 0;i < len;i++)                                                    \
+        out[i*stride] = func(src[i]);                                         \
+}
+
+DECL_TEMPLATE(ALbyte, aluF2B)
+DECL_TEMPLATE(ALubyte, aluF2UB)
+DECL_TEMPLATE(ALshort, aluF2S)
+DECL_TEMPLATE(ALushort, aluF2US)
+DECL_TEMPLATE(ALfloat, aluF2F)
+
+#undef DECL_TEMPLATE
+
+static ALvoid NarrowDouble_C(ALfp *dst, const ALdfp *src, ALuint len)
+{
+    ALuint i;
+    for(i = 0;i < len;i++)
+        dst[i] = (ALfp)src[i];
+}
+
+static ALvoid Geometry_C(SourceGeometry *geom, ALfp matrix[4][4],
+  const ALfp *listenerVel, ALuint count)
+{
+    ALfp Position[3], Direction[3], Velocity[3], SourceToListener[3];
+    ALfp length, invlen;
+    ALuint i, c;
+
+    for(i = 0;i < count;i++)
+    {
+        for(c = 0;c < 3;c++)
+        {
+            Position[c]  = geom->Pos[c][i];
+            Direction[c] = geom->Dir[c][i];
+            Velocity[c]  = geom->Vel[c][i];
+        }
+        if(matrix)
+        {
+            aluMatrixVector(Position, int2ALfp(1), matrix);
+            aluMatrixVector(Direction, int2ALfp(0), matrix);
+            aluMatrixVector(Velocity, int2ALfp(0), matrix);
+        }
+        aluNormalize(Direction);
+
+        SourceToListener[0] = -1*Position[0];
+        SourceToListener[1] = -1*Position[1];
+        SourceToListener[2] = -1*Position[2];
+        length = aluSqrt(aluDotproduct(SourceToListener, SourceToListener));
+        if(length != int2ALfp(0))
+        {
+            invlen = ALfpDiv(int2ALfp(1), length);
+            SourceToListener[0] = ALfpMult(SourceToListener[0], invlen);
+            SourceToListener[1] = ALfpMult(SourceToListener[1], invlen);
+            SourceToListener[2] = ALfpMult(SourceToListener[2], invlen);
+        }
+
+        for(c = 0;c < 3;c++)
+        {
+            geom->Pos[c][i] = Position[c];
+            geom->Dir[c][i] = Direction[c];
+            geom->Vel[c][i] = Velocity[c];
+        }
+        geom->Dist[i]     = length;
+        geom->ConeCos[i]  = aluDotproduct(Direction, SourceToListener);
+        geom->BackCos[i]  = SourceToListener[2];
+        geom->SrcSpeed[i] = aluDotproduct(Velocity, SourceToListener);
+        geom->LisSpeed[i] = aluDotproduct(listenerVel, SourceToListener);
+    }
+}
+
+static const MixerFuncs MixerFuncs_C = {
+    "C",
+    { Resample_ALubyte_point8, Resample_ALubyte_lerp8, Resample_ALubyte_cubic8 },
+    { Resample_ALshort_point16, Resample_ALshort_lerp16, Resample_ALshort_cubic16 },
+    { Resample_ALfp_point32, Resample_ALfp_lerp32, Resample_ALfp_cubic32 },
+    Copy_ALubyte, Copy_ALshort, Copy_ALfp,
+    Accumulate_C,
+    MatrixMix_C,
+    { Store_ALbyte, Store_ALubyte, Store_ALshort, Store_ALushort, Store_ALfloat },
+    NarrowDouble_C,
+    Geometry_C
+};
+
+
+#ifdef HAVE_NEON
+static ALboolean HasNEON(void)
+{
+#ifdef ANDROID
+    return (android_getCpuFamily() == ANDROID_CPU_FAMILY_ARM &&
+            (android_getCpuFeatures()&ANDROID_CPU_ARM_FEATURE_NEON));
+#else
+    return AL_TRUE;
+#endif
+}
+#endif
+
+#ifdef HAVE_SSE2
+static ALboolean HasSSE2(void)
+{
+#if defined(__x86_64__)
+    return AL_TRUE;
+#else
+    unsigned int eax, ebx, ecx, edx;
+    if(!__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+        return AL_FALSE;
+    return ((edx&bit_SSE2) ? AL_TRUE : AL_FALSE);
+#endif
+}
+#endif
+
+/* The best functions this CPU runs, unless the "simd" option says not to */
+static const MixerFuncs *SelectMixerFuncs(void)
+{
+    if(!GetConfigValueBool(NULL, "simd", 1))
+        return &MixerFuncs_C;
+
+#ifdef HAVE_NEON
+    if(HasNEON())
+        return &MixerFuncs_NEON;
+#endif
+#ifdef HAVE_SSE2
+    if(HasSSE2())
+        return &MixerFuncs_SSE2;
+#endif
+    return &MixerFuncs_C;
+}
+
+/* For buffer uploads, which have no device to go by. Set along with the
+ * first device's, which comes before any buffer can. */
+static const MixerFuncs *UploadMixer = NULL;
 
-#define DECL_TEMPLATE(T, chnct, sampler)                                      \
-static void Mix_##T##_##chnct##_##sampler(ALsource *Source, ALCdevice *Device,\
-  const T *data, ALuint *DataPosInt, ALuint *DataPosFrac,                     \
+ALvoid aluInitMixer(ALCdevice *Device)
+{
+    Device->Mixer = SelectMixerFuncs();
+    UploadMixer = Device->Mixer;
+}
+
+ALvoid aluNarrowDoubles(ALfp *dst, const ALdfp *src, ALuint len)
+{
+    const MixerFuncs *Mixer = UploadMixer;
+
+    if(!Mixer)
+        UploadMixer = Mixer = SelectMixerFuncs();
+    Mixer->NarrowDouble(dst, src, len);
+}
+
+static ResamplerFunc SelectResampler(const MixerFuncs *Mixer,
+                                     resampler_t Resampler,
+                                     enum FmtType FmtType,
+                                     ALuint increment)
+{
+    if(increment == FRACTIONONE)
+    {
+        /* Playing at the device rate, so the samples only need converting */
+        switch(FmtType)
+        {
+        case FmtUByte:
+            return Mixer->CopyUByte;
+        case FmtShort:
+        case FmtIMA4:
+            return Mixer->CopyShort;
+        case FmtFloat:
+            return Mixer->CopyFloat;
+        }
+        return NULL;
+    }
+
+    switch(FmtType)
+    {
+    case FmtUByte:
+        return Mixer->UByte[Resampler];
+    case FmtShort:
+    case FmtIMA4:
+        return Mixer->Short[Resampler];
+    case FmtFloat:
+        return Mixer->Float[Resampler];
+    }
+    return NULL;
+}
+
+
+/* Adds a block of filtered samples to each dry output channel. The channels
+ * are stored planar, so every pass is a plain multiply-accumulate over a
+ * contiguous run. */
+static __inline ALvoid MixDry(ALsample (*DryBuffer)[BUFFERSIZE],
+  const ALsample *DrySend, const ALsample *data, ALuint OutPos, ALuint todo)
+{
+    ALuint c, i;
+
+    for(c = 0;c < MAXCHANNELS;c++)
+    {
+        const ALsample gain = DrySend[c];
+        ALsample *dst = &DryBuffer[c][OutPos];
+
+        if(gain == int2ALfp(0))
+            continue;
+        for(i = 0;i < todo;i++)
+            dst[i] = (dst[i] + ALsampleMult(data[i], gain));
+    }
+}
+
+/* Worker 0 mixes straight into the device and effect slot buffers, the others
+ * into their own accumulation buffers. */
+static __inline ALsample (*GetDryTarget(ALCdevice *Device, ALuint Worker,
+  ALsample **ClickRemoval, ALsample **PendingClicks))[BUFFERSIZE]
+{
+    ALmixaccum *Accum;
+
+    if(Worker == 0)
+    {
+        *ClickRemoval = Device->ClickRemoval;
+        *PendingClicks = Device->PendingClicks;
+        return Device->DryBuffer;
+    }
+    Accum = &Device->MixAccum[Worker-1];
+    Accum->Used = AL_TRUE;
+    *ClickRemoval = Accum->ClickRemoval;
+    *PendingClicks = Accum->PendingClicks;
+    return Accum->DryBuffer;
+}
+
+static __inline ALsample *GetWetTarget(ALeffectslot *Slot, ALuint Worker,
+  ALsample **ClickRemoval, ALsample **PendingClicks)
+{
+    ALwetaccum *Accum;
+
+    if(Worker == 0)
+    {
+        *ClickRemoval = Slot->ClickRemoval;
+        *PendingClicks = Slot->PendingClicks;
+        return Slot->WetBuffer;
+    }
+    Accum = &Slot->WorkerWet[Worker-1];
+    Accum->Used = AL_TRUE;
+    *ClickRemoval = Accum->ClickRemoval;
+    *PendingClicks = Accum->PendingClicks;
+    return Accum->WetBuffer;
+}
+
+static void Mix_1(ALsource *Source, ALCdevice *Device, ALuint Worker,
+  ResamplerFunc Resample,
+  const ALvoid *data, ALuint *DataPosInt, ALuint *DataPosFrac,
+  ALuint OutPos, ALuint SamplesToDo, ALuint BufferSize)
+{
+    ALsample (*DryBuffer)[BUFFERSIZE];
+    ALsample *ClickRemoval, *PendingClicks;
+    ALsample Samples[BUFFERSIZE+1];
+    ALsample DrySend[MAXCHANNELS];
+    FILTER *DryFilter;
+    ALuint BufferIdx;
+    ALuint increment;
+    ALuint out, c;
+    ALuint64 step;
+    ALsample value;
+
+    increment = Source->Params.Step;
+
+    DryBuffer = GetDryTarget(Device, Worker, &ClickRemoval, &PendingClicks);
+    DryFilter = &Source->Params.iirFilter;
+    for(c = 0;c < MAXCHANNELS;c++)
+        DrySend[c] = Source->Params.DryGains[0][c];
+
+    /* One extra sample for the click removal at the end */
+    Resample(data, 0, 1, *DataPosFrac, increment, Samples, BufferSize+1);
+
+    /* The sends go first, since the dry path filters the block in place */
+    for(out = 0;out < Device->NumAuxSends;out++)
+    {
+        ALsample WetSend;
+        ALsample *WetBuffer;
+        ALsample *WetClickRemoval;
+        ALsample *WetPendingClicks;
+        FILTER  *WetFilter;
+
+        if(!Source->Send[out].Slot ||
+           Source->Send[out].Slot->effect.type == AL_EFFECT_NULL)
+            continue;
+
+        WetBuffer = GetWetTarget(Source->Send[out].Slot, Worker,
+                                 &WetClickRemoval, &WetPendingClicks);
+        WetFilter = &Source->Params.Send[out].iirFilter;
+        WetSend = Source->Params.Send[out].WetGain;
+
+        if(OutPos == 0)
+        {
+            value = lpFilter2PC(WetFilter, 0, Samples[0]);
+            WetClickRemoval[0] = (WetClickRemoval[0] - ALsampleMult(value,WetSend));
+        }
+        for(BufferIdx = 0;BufferIdx < BufferSize;BufferIdx++)
+        {
+            /* Room path final mix buffer and panning */
+            value = lpFilter2P(WetFilter, 0, Samples[BufferIdx]);
+            WetBuffer[OutPos+BufferIdx] = (WetBuffer[OutPos+BufferIdx] + ALsampleMult(value,WetSend));
+        }
+        if(OutPos+BufferSize == SamplesToDo)
+        {
+            value = lpFilter2PC(WetFilter, 0, Samples[BufferIdx]);
+            WetPendingClicks[0] = (WetPendingClicks[0] + ALsampleMult(value,WetSend));
+        }
+    }
+
+    if(OutPos == 0)
+    {
+        value = lpFilter4PC(DryFilter, 0, Samples[0]);
+        for(c = 0;c < MAXCHANNELS;c++)
+            ClickRemoval[c] = (ClickRemoval[c] - ALsampleMult(value,DrySend[c]));
+    }
+    /* Direct path final mix buffer and panning */
+    for(BufferIdx = 0;BufferIdx < BufferSize;BufferIdx++)
+        Samples[BufferIdx] = lpFilter4P(DryFilter, 0, Samples[BufferIdx]);
+    MixDry(DryBuffer, DrySend, Samples, OutPos, BufferSize);
+    if(OutPos+BufferSize == SamplesToDo)
+    {
+        value = lpFilter4PC(DryFilter, 0, Samples[BufferSize]);
+        for(c = 0;c < MAXCHANNELS;c++)
+            PendingClicks[c] = (PendingClicks[c] + ALsampleMult(value,DrySend[c]));
+    }
+
+    step  = (ALuint64)BufferSize * increment;
+    step += *DataPosFrac;
+    *DataPosInt += (ALuint)(step>>FRACTIONBITS);
+    *DataPosFrac = (ALuint)(step&FRACTIONMASK);
+}
+
+
+#define DECL_TEMPLATE(chnct)                                                  \
+static void Mix_##chnct(ALsource *Source, ALCdevice *Device, ALuint Worker,   \
+  ResamplerFunc Resample,                                                     \
+  const ALvoid *data, ALuint *DataPosInt, ALuint *DataPosFrac,                \
   ALuint OutPos, ALuint SamplesToDo, ALuint BufferSize)                       \
 {                                                                             \
     const ALuint Channels = chnct;                                            \
-    const ALfp scaler = ALfpDiv(int2ALfp(1),int2ALfp(chnct));                 \
-    ALfp (*DryBuffer)[MAXCHANNELS];                                           \
-    ALfp *ClickRemoval, *PendingClicks;                                       \
-    ALuint pos, frac;                                                         \
-    ALfp DrySend[chnct][MAXCHANNELS];                                         \
+    const ALsample scaler = ALfpDiv(int2ALfp(1),int2ALfp(chnct));             \
+    ALsample (*DryBuffer)[BUFFERSIZE];                                        \
+    ALsample *ClickRemoval, *PendingClicks;                                   \
+    ALsample Samples[BUFFERSIZE+1];                                           \
+    ALsample DrySend[chnct][MAXCHANNELS];                                     \
     FILTER *DryFilter;                                                        \
     ALuint BufferIdx;                                                         \
     ALuint increment;                                                         \
     ALuint i, out, c;                                                         \
-    ALfp value;                                                               \
+    ALuint64 step;                                                            \
+    ALsample value;                                                           \
                                                                               \
     increment = Source->Params.Step;                                          \
                                                                               \
-    DryBuffer = Device->DryBuffer;                                            \
-    ClickRemoval = Device->ClickRemoval;                                      \
-    PendingClicks = Device->PendingClicks;                                    \
+    DryBuffer = GetDryTarget(Device, Worker, &ClickRemoval, &PendingClicks);  \
     DryFilter = &Source->Params.iirFilter;                                    \
     for(i = 0;i < Channels;i++)                                               \
     {                                                                         \
@@ -226,266 +525,390 @@ static void Mix_##T##_##chnct##_##sampler(ALsource *Source, ALCdevice *Device,\
             DrySend[i][c] = Source->Params.DryGains[i][c];                    \
     }                                                                         \
                                                                               \
-    pos = 0;                                                                  \
-    frac = *DataPosFrac;                                                      \
-                                                                              \
-    if(OutPos == 0)                                                           \
-    {                                                                         \
-        for(i = 0;i < Channels;i++)                                           \
-        {                                                                     \
-            value = sampler(data + pos*Channels + i, Channels, frac);         \
-                                                                              \
-            value = lpFilter2PC(DryFilter, i*2, value);                       \
-            for(c = 0;c < MAXCHANNELS;c++)                                    \
-                ClickRemoval[c] = (ClickRemoval[c] - ALfpMult(value,DrySend[i][c])); \
-        }                                                                     \
-    }                                                                         \
-    for(BufferIdx = 0;BufferIdx < BufferSize;BufferIdx++)                     \
+    for(i = 0;i < Channels;i++)                                               \
     {                                                                         \
-        for(i = 0;i < Channels;i++)                                           \
-        {                                                                     \
-            value = sampler(data + pos*Channels + i, Channels, frac);         \
-                                                                              \
-            value = lpFilter2P(DryFilter, i*2, value);                        \
-            for(c = 0;c < MAXCHANNELS;c++)                                    \
-                DryBuffer[OutPos][c] = (DryBuffer[OutPos][c] + ALfpMult(value,DrySend[i][c])); \
-        }                                                                     \
+        Resample(data, i, Channels, *DataPosFrac, increment,                  \
+                 Samples, BufferSize+1);                                      \
                                                                               \
-        frac += increment;                                                    \
-        pos  += frac>>FRACTIONBITS;                                           \
-        frac &= FRACTIONMASK;                                                 \
-        OutPos++;                                                             \
-    }                                                                         \
-    if(OutPos == SamplesToDo)                                                 \
-    {                                                                         \
-        for(i = 0;i < Channels;i++)                                           \
+        /* The aux sends are fed from the same resampled block, and go       \
+         * first since the dry path filters it in place */                    \
+        for(out = 0;out < Device->NumAuxSends;out++)                          \
         {                                                                     \
-            value = sampler(data + pos*Channels + i, Channels, frac);         \
-                                                                              \
-            value = lpFilter2PC(DryFilter, i*2, value);                       \
-            for(c = 0;c < MAXCHANNELS;c++)                                    \
-                PendingClicks[c] = (PendingClicks[c] + ALfpMult(value,DrySend[i][c])); \
-        }                                                                     \
-    }                                                                         \
+            ALsample WetSend;                                                 \
+            ALsample *WetBuffer;                                              \
+            ALsample *WetClickRemoval;                                        \
+            ALsample *WetPendingClicks;                                       \
+            FILTER  *WetFilter;                                               \
                                                                               \
-    for(out = 0;out < Device->NumAuxSends;out++)                              \
-    {                                                                         \
-        ALfp  WetSend;                                                        \
-        ALfp *WetBuffer;                                                      \
-        ALfp *WetClickRemoval;                                                \
-        ALfp *WetPendingClicks;                                               \
-        FILTER  *WetFilter;                                                   \
+            if(!Source->Send[out].Slot ||                                     \
+               Source->Send[out].Slot->effect.type == AL_EFFECT_NULL)         \
+                continue;                                                     \
                                                                               \
-        if(!Source->Send[out].Slot ||                                         \
-           Source->Send[out].Slot->effect.type == AL_EFFECT_NULL)             \
-            continue;                                                         \
+            WetBuffer = GetWetTarget(Source->Send[out].Slot, Worker,          \
+                                     &WetClickRemoval, &WetPendingClicks);    \
+            WetFilter = &Source->Params.Send[out].iirFilter;                  \
+            WetSend = ALsampleMult(Source->Params.Send[out].WetGain, scaler); \
                                                                               \
-        WetBuffer = Source->Send[out].Slot->WetBuffer;                        \
-        WetClickRemoval = Source->Send[out].Slot->ClickRemoval;               \
-        WetPendingClicks = Source->Send[out].Slot->PendingClicks;             \
-        WetFilter = &Source->Params.Send[out].iirFilter;                      \
-        WetSend = Source->Params.Send[out].WetGain;                           \
-                                                                              \
-        pos = 0;                                                              \
-        frac = *DataPosFrac;                                                  \
-        OutPos -= BufferSize;                                                 \
-                                                                              \
-        if(OutPos == 0)                                                       \
-        {                                                                     \
-            for(i = 0;i < Channels;i++)                                       \
+            if(OutPos == 0)                                                   \
             {                                                                 \
-                value = sampler(data + pos*Channels + i, Channels, frac);     \
-                                                                              \
-                value = lpFilter1PC(WetFilter, i, value);                     \
-                WetClickRemoval[0] = (WetClickRemoval[0] - ALfpMult(ALfpMult(value,WetSend), scaler)); \
+                value = lpFilter1PC(WetFilter, i, Samples[0]);                \
+                WetClickRemoval[0] = (WetClickRemoval[0] - ALsampleMult(value,WetSend)); \
             }                                                                 \
-        }                                                                     \
-        for(BufferIdx = 0;BufferIdx < BufferSize;BufferIdx++)                 \
-        {                                                                     \
-            for(i = 0;i < Channels;i++)                                       \
+            for(BufferIdx = 0;BufferIdx < BufferSize;BufferIdx++)             \
             {                                                                 \
-                value = sampler(data + pos*Channels + i, Channels, frac);     \
-                                                                              \
-                value = lpFilter1P(WetFilter, i, value);                      \
-                WetBuffer[OutPos] = (WetBuffer[OutPos] + ALfpMult(ALfpMult(value,WetSend), scaler)); \
+                value = lpFilter1P(WetFilter, i, Samples[BufferIdx]);         \
+                WetBuffer[OutPos+BufferIdx] = (WetBuffer[OutPos+BufferIdx] + ALsampleMult(value,WetSend)); \
+            }                                                                 \
+            if(OutPos+BufferSize == SamplesToDo)                              \
+            {                                                                 \
+                value = lpFilter1PC(WetFilter, i, Samples[BufferIdx]);        \
+                WetPendingClicks[0] = (WetPendingClicks[0] + ALsampleMult(value,WetSend)); \
             }                                                                 \
+        }                                                                     \
                                                                               \
-            frac += increment;                                                \
-            pos  += frac>>FRACTIONBITS;                                       \
-            frac &= FRACTIONMASK;                                             \
-            OutPos++;                                                         \
+        if(OutPos == 0)                                                       \
+        {                                                                     \
+            value = lpFilter2PC(DryFilter, i*2, Samples[0]);                  \
+            for(c = 0;c < MAXCHANNELS;c++)                                    \
+                ClickRemoval[c] = (ClickRemoval[c] - ALsampleMult(value,DrySend[i][c])); \
         }                                                                     \
-        if(OutPos == SamplesToDo)                                             \
+        for(BufferIdx = 0;BufferIdx < BufferSize;BufferIdx++)                 \
+            Samples[BufferIdx] = lpFilter2P(DryFilter, i*2, Samples[BufferIdx]); \
+        MixDry(DryBuffer, DrySend[i], Samples, OutPos, BufferSize);           \
+        if(OutPos+BufferSize == SamplesToDo)                                  \
         {                                                                     \
-            for(i = 0;i < Channels;i++)                                       \
-            {                                                                 \
-                value = sampler(data + pos*Channels + i, Channels, frac);     \
-                                                                              \
-                value = lpFilter1PC(WetFilter, i, value);                     \
-                WetPendingClicks[0] = (WetPendingClicks[0] + ALfpMult(ALfpMult(value,WetSend), scaler)); \
-            }                                                                 \
+            value = lpFilter2PC(DryFilter, i*2, Samples[BufferSize]);         \
+            for(c = 0;c < MAXCHANNELS;c++)                                    \
+                PendingClicks[c] = (PendingClicks[c] + ALsampleMult(value,DrySend[i][c])); \
         }                                                                     \
     }                                                                         \
-    *DataPosInt += pos;                                                       \
-    *DataPosFrac = frac;                                                      \
+                                                                              \
+    step  = (ALuint64)BufferSize * increment;                                 \
+    step += *DataPosFrac;                                                     \
+    *DataPosInt += (ALuint)(step>>FRACTIONBITS);                              \
+    *DataPosFrac = (ALuint)(step&FRACTIONMASK);                               \
 }
 
-DECL_TEMPLATE(ALfp, 2, point32)
-DECL_TEMPLATE(ALfp, 2, lerp32)
-DECL_TEMPLATE(ALfp, 2, cubic32)
+DECL_TEMPLATE(2)
+DECL_TEMPLATE(4)
+DECL_TEMPLATE(6)
+DECL_TEMPLATE(7)
+DECL_TEMPLATE(8)
 
-DECL_TEMPLATE(ALshort, 2, point16)
-DECL_TEMPLATE(ALshort, 2, lerp16)
-DECL_TEMPLATE(ALshort, 2, cubic16)
+#undef DECL_TEMPLATE
 
-DECL_TEMPLATE(ALubyte, 2, point8)
-DECL_TEMPLATE(ALubyte, 2, lerp8)
-DECL_TEMPLATE(ALubyte, 2, cubic8)
 
+static void Mix(ALsource *Source, ALCdevice *Device, ALuint Worker,
+  enum FmtChannels FmtChannels, ResamplerFunc Resample,
+  const ALvoid *Data, ALuint *DataPosInt, ALuint *DataPosFrac,
+  ALuint OutPos, ALuint SamplesToDo, ALuint BufferSize)
+{
+    switch(FmtChannels)
+    {
+    case FmtMono:
+        Mix_1(Source, Device, Worker, Resample, Data, DataPosInt, DataPosFrac,
+              OutPos, SamplesToDo, BufferSize);
+        break;
+    case FmtStereo:
+    case FmtRear:
+        Mix_2(Source, Device, Worker, Resample, Data, DataPosInt, DataPosFrac,
+              OutPos, SamplesToDo, BufferSize);
+        break;
+    case FmtQuad:
+        Mix_4(Source, Device, Worker, Resample, Data, DataPosInt, DataPosFrac,
+              OutPos, SamplesToDo, BufferSize);
+        break;
+    case FmtX51:
+        Mix_6(Source, Device, Worker, Resample, Data, DataPosInt, DataPosFrac,
+              OutPos, SamplesToDo, BufferSize);
+        break;
+    case FmtX61:
+        Mix_7(Source, Device, Worker, Resample, Data, DataPosInt, DataPosFrac,
+              OutPos, SamplesToDo, BufferSize);
+        break;
+    case FmtX71:
+        Mix_8(Source, Device, Worker, Resample, Data, DataPosInt, DataPosFrac,
+              OutPos, SamplesToDo, BufferSize);
+        break;
+    }
+}
 
-DECL_TEMPLATE(ALfp, 4, point32)
-DECL_TEMPLATE(ALfp, 4, lerp32)
-DECL_TEMPLATE(ALfp, 4, cubic32)
 
-DECL_TEMPLATE(ALshort, 4, point16)
-DECL_TEMPLATE(ALshort, 4, lerp16)
-DECL_TEMPLATE(ALshort, 4, cubic16)
+static ALboolean IsSourceInaudible(const ALsource *Source,
+                                   const ALCdevice *Device, ALuint Channels)
+{
+    ALuint i, c;
 
-DECL_TEMPLATE(ALubyte, 4, point8)
-DECL_TEMPLATE(ALubyte, 4, lerp8)
-DECL_TEMPLATE(ALubyte, 4, cubic8)
+    Channels = min(Channels, MAXCHANNELS);
+    for(i = 0;i < Channels;i++)
+    {
+        for(c = 0;c < MAXCHANNELS;c++)
+        {
+            if(Source->Params.DryGains[i][c] >= VIRTUAL_GAIN_THRESHOLD)
+                return AL_FALSE;
+        }
+    }
+    for(i = 0;i < Device->NumAuxSends;i++)
+    {
+        if(!Source->Send[i].Slot ||
+           Source->Send[i].Slot->effect.type == AL_EFFECT_NULL)
+            continue;
+        if(Source->Params.Send[i].WetGain >= VIRTUAL_GAIN_THRESHOLD)
+            return AL_FALSE;
+    }
+    return AL_TRUE;
+}
 
+/* Returns the decoded samples of the given IMA4 block, from the source's
+ * cache when it was the last one decoded */
+static const ALshort *GetIMA4Block(ALsource *Source, const ALbuffer *ALBuffer,
+                                   ALuint Block)
+{
+    ALuint Channels = ChannelsFromFmt(ALBuffer->FmtChannels);
 
-DECL_TEMPLATE(ALfp, 6, point32)
-DECL_TEMPLATE(ALfp, 6, lerp32)
-DECL_TEMPLATE(ALfp, 6, cubic32)
+    if(Source->IMA4Cache.DataId != ALBuffer->DataId ||
+       Source->IMA4Cache.Block != Block)
+    {
+        const ALubyte *Data = ALBuffer->data;
 
-DECL_TEMPLATE(ALshort, 6, point16)
-DECL_TEMPLATE(ALshort, 6, lerp16)
-DECL_TEMPLATE(ALshort, 6, cubic16)
+        DecodeIMA4Block(Source->IMA4Cache.Samples,
+                        &Data[Block*IMA4_BLOCK_SIZE*Channels], Channels);
+        Source->IMA4Cache.DataId = ALBuffer->DataId;
+        Source->IMA4Cache.Block = Block;
+    }
+    return Source->IMA4Cache.Samples;
+}
 
-DECL_TEMPLATE(ALubyte, 6, point8)
-DECL_TEMPLATE(ALubyte, 6, lerp8)
-DECL_TEMPLATE(ALubyte, 6, cubic8)
+/* Copies len bytes of the buffer's samples, as the mixer sees them, from byte
+ * offset pos on. IMA4 data is decoded a block at a time. */
+static __inline ALvoid LoadBufferData(ALsource *Source, const ALbuffer *ALBuffer,
+                                      ALubyte *dst, ALuint pos, ALuint len)
+{
+    ALuint FrameSize, Frame, Count;
 
+    /* Data still being loaded plays as silence */
+    if(!BufferDataReady(ALBuffer))
+    {
+        memset(dst, (ALBuffer->FmtType==FmtUByte)?0x80:0, len);
+        return;
+    }
 
-DECL_TEMPLATE(ALfp, 7, point32)
-DECL_TEMPLATE(ALfp, 7, lerp32)
-DECL_TEMPLATE(ALfp, 7, cubic32)
+    if(ALBuffer->FmtType != FmtIMA4)
+    {
+        memcpy(dst, (const ALubyte*)ALBuffer->data + pos, len);
+        return;
+    }
 
-DECL_TEMPLATE(ALshort, 7, point16)
-DECL_TEMPLATE(ALshort, 7, lerp16)
-DECL_TEMPLATE(ALshort, 7, cubic16)
+    FrameSize = FrameSizeFromFmt(ALBuffer->FmtChannels, ALBuffer->FmtType);
+    Frame = pos / FrameSize;
+    Count = len / FrameSize;
+    while(Count > 0)
+    {
+        ALuint Offset = Frame % IMA4_BLOCK_FRAMES;
+        ALuint todo = min(Count, IMA4_BLOCK_FRAMES-Offset);
+        const ALshort *Samples = GetIMA4Block(Source, ALBuffer,
+                                              Frame / IMA4_BLOCK_FRAMES);
+
+        memcpy(dst, (const ALubyte*)Samples + Offset*FrameSize, todo*FrameSize);
+        dst += todo*FrameSize;
+        Frame += todo;
+        Count -= todo;
+    }
+}
 
-DECL_TEMPLATE(ALubyte, 7, point8)
-DECL_TEMPLATE(ALubyte, 7, lerp8)
-DECL_TEMPLATE(ALubyte, 7, cubic8)
+/* Has the buffer's callback fill in frames from stream frame pos on. Once the
+ * stream has ended, or ends partway, the rest are silence. */
+static ALvoid PullCallbackData(ALsource *Source, const ALbuffer *ALBuffer,
+                               ALuint FrameSize, ALint64 pos, ALubyte *dst,
+                               ALuint frames)
+{
+    ALsizei got = 0;
 
+    if(!Source->CallbackEnded)
+    {
+        got = ALBuffer->Callback(ALBuffer->UserData, dst, frames*FrameSize);
+        got = max(0, min(got, (ALsizei)(frames*FrameSize))) / FrameSize;
+        if((ALuint)got < frames)
+        {
+            Source->CallbackEnded = AL_TRUE;
+            Source->CallbackEnd = pos + got;
+        }
+    }
+    memset(&dst[got*FrameSize], (ALBuffer->FmtType==FmtUByte)?0x80:0,
+           (frames-got)*FrameSize);
+}
 
-DECL_TEMPLATE(ALfp, 8, point32)
-DECL_TEMPLATE(ALfp, 8, lerp32)
-DECL_TEMPLATE(ALfp, 8, cubic32)
+/* Returns the callback stream's frames from start on, frames of them,
+ * pulling in whatever isn't held yet. What precedes the stream is silence,
+ * and anything skipped over is pulled and dropped so the stream keeps time
+ * with the source. */
+static const ALubyte *FetchCallbackData(ALsource *Source,
+  const ALbuffer *ALBuffer, ALuint FrameSize, ALint64 start, ALuint frames)
+{
+    const ALuint MaxFrames = STACK_DATA_SIZE / FrameSize;
+    ALubyte *Data = Source->CallbackData;
+    ALint64 skip = start - Source->CallbackBase;
 
-DECL_TEMPLATE(ALshort, 8, point16)
-DECL_TEMPLATE(ALshort, 8, lerp16)
-DECL_TEMPLATE(ALshort, 8, cubic16)
+    if(skip < 0)
+    {
+        ALuint pad = (ALuint)-skip;
 
-DECL_TEMPLATE(ALubyte, 8, point8)
-DECL_TEMPLATE(ALubyte, 8, lerp8)
-DECL_TEMPLATE(ALubyte, 8, cubic8)
+        Source->CallbackCount = min(Source->CallbackCount, MaxFrames-pad);
+        memmove(&Data[pad*FrameSize], Data, Source->CallbackCount*FrameSize);
+        memset(Data, (ALBuffer->FmtType==FmtUByte)?0x80:0, pad*FrameSize);
+        Source->CallbackCount += pad;
+    }
+    else if(skip < Source->CallbackCount)
+    {
+        Source->CallbackCount -= (ALuint)skip;
+        memmove(Data, &Data[skip*FrameSize], Source->CallbackCount*FrameSize);
+    }
+    else
+    {
+        ALint64 pos = Source->CallbackBase + Source->CallbackCount;
 
-#undef DECL_TEMPLATE
+        while(pos < start && !Source->CallbackEnded)
+        {
+            ALuint todo = (ALuint)min(start-pos, MaxFrames);
+            PullCallbackData(Source, ALBuffer, FrameSize, pos, Data, todo);
+            pos += todo;
+        }
+        Source->CallbackCount = 0;
+    }
+    Source->CallbackBase = start;
 
+    if(Source->CallbackCount < frames)
+    {
+        PullCallbackData(Source, ALBuffer, FrameSize,
+                         start + Source->CallbackCount,
+                         &Data[Source->CallbackCount*FrameSize],
+                         frames - Source->CallbackCount);
+        Source->CallbackCount = frames;
+    }
+    return Data;
+}
 
-#define DECL_TEMPLATE(T, sampler)                                             \
-static void Mix_##T##_##sampler(ALsource *Source, ALCdevice *Device,          \
-  enum FmtChannels FmtChannels,                                               \
-  const ALvoid *Data, ALuint *DataPosInt, ALuint *DataPosFrac,                \
-  ALuint OutPos, ALuint SamplesToDo, ALuint BufferSize)                       \
-{                                                                             \
-    switch(FmtChannels)                                                       \
-    {                                                                         \
-    case FmtMono:                                                             \
-        Mix_##T##_1_##sampler(Source, Device, Data, DataPosInt, DataPosFrac,  \
-                              OutPos, SamplesToDo, BufferSize);               \
-        break;                                                                \
-    case FmtStereo:                                                           \
-    case FmtRear:                                                             \
-        Mix_##T##_2_##sampler(Source, Device, Data, DataPosInt, DataPosFrac,  \
-                              OutPos, SamplesToDo, BufferSize);               \
-        break;                                                                \
-    case FmtQuad:                                                             \
-        Mix_##T##_4_##sampler(Source, Device, Data, DataPosInt, DataPosFrac,  \
-                              OutPos, SamplesToDo, BufferSize);               \
-        break;                                                                \
-    case FmtX51:                                                              \
-        Mix_##T##_6_##sampler(Source, Device, Data, DataPosInt, DataPosFrac,  \
-                              OutPos, SamplesToDo, BufferSize);               \
-        break;                                                                \
-    case FmtX61:                                                              \
-        Mix_##T##_7_##sampler(Source, Device, Data, DataPosInt, DataPosFrac,  \
-                              OutPos, SamplesToDo, BufferSize);               \
-        break;                                                                \
-    case FmtX71:                                                              \
-        Mix_##T##_8_##sampler(Source, Device, Data, DataPosInt, DataPosFrac,  \
-                              OutPos, SamplesToDo, BufferSize);               \
-        break;                                                                \
-    }                                                                         \
+/* A callback source plays until the mixer gets past the end of its stream */
+static ALenum UpdateCallbackPosition(ALsource *Source, ALuint *BuffersPlayed,
+  ALuint *DataPosInt, ALuint *DataPosFrac)
+{
+    if(!Source->CallbackEnded || *DataPosInt < Source->CallbackEnd)
+        return AL_PLAYING;
+
+    *BuffersPlayed = Source->BuffersInQueue;
+    *DataPosInt = 0;
+    *DataPosFrac = 0;
+    return AL_STOPPED;
 }
 
-DECL_TEMPLATE(ALfp, point32)
-DECL_TEMPLATE(ALfp, lerp32)
-DECL_TEMPLATE(ALfp, cubic32)
+/* Checks that the buffers the next SamplesToDo samples will be read from,
+ * resampler padding included, are done loading */
+static ALboolean SourceBuffersReady(const ALsource *Source,
+  const ALbufferlistitem *BufferListItem, ALboolean Looping, ALuint FrameSize,
+  resampler_t Resampler, ALuint DataPosInt, ALuint DataPosFrac,
+  ALuint increment, ALuint SamplesToDo)
+{
+    ALuint64 Needed;
+    ALuint i;
 
-DECL_TEMPLATE(ALshort, point16)
-DECL_TEMPLATE(ALshort, lerp16)
-DECL_TEMPLATE(ALshort, cubic16)
+    if(FrameSize == 0)
+        return AL_TRUE;
 
-DECL_TEMPLATE(ALubyte, point8)
-DECL_TEMPLATE(ALubyte, lerp8)
-DECL_TEMPLATE(ALubyte, cubic8)
+    Needed  = (ALuint64)SamplesToDo * increment;
+    Needed += DataPosFrac;
+    Needed >>= FRACTIONBITS;
+    Needed += ResamplerPadding[Resampler] + 1;
 
-#undef DECL_TEMPLATE
+    for(i = 0;i < Source->BuffersInQueue && BufferListItem;i++)
+    {
+        const ALbuffer *ALBuffer;
 
+        if((ALBuffer=BufferListItem->buffer) != NULL)
+        {
+            ALuint DataSize = ALBuffer->size / FrameSize;
 
-#define DECL_TEMPLATE(sampler)                                                \
-static void Mix_##sampler(ALsource *Source, ALCdevice *Device,                \
-  enum FmtChannels FmtChannels, enum FmtType FmtType,                         \
-  const ALvoid *Data, ALuint *DataPosInt, ALuint *DataPosFrac,                \
-  ALuint OutPos, ALuint SamplesToDo, ALuint BufferSize)                       \
-{                                                                             \
-    switch(FmtType)                                                           \
-    {                                                                         \
-    case FmtUByte:                                                            \
-        Mix_ALubyte_##sampler##8(Source, Device, FmtChannels,                 \
-                                 Data, DataPosInt, DataPosFrac,               \
-                                 OutPos, SamplesToDo, BufferSize);            \
-        break;                                                                \
-                                                                              \
-    case FmtShort:                                                            \
-        Mix_ALshort_##sampler##16(Source, Device, FmtChannels,                \
-                                  Data, DataPosInt, DataPosFrac,              \
-                                  OutPos, SamplesToDo, BufferSize);           \
-        break;                                                                \
-                                                                              \
-    case FmtFloat:                                                            \
-        Mix_ALfp_##sampler##32(Source, Device, FmtChannels,                   \
-                                  Data, DataPosInt, DataPosFrac,              \
-                                  OutPos, SamplesToDo, BufferSize);           \
-        break;                                                                \
-    }                                                                         \
+            if(!BufferDataReady(ALBuffer))
+                return AL_FALSE;
+            if(DataSize > DataPosInt)
+            {
+                if(DataSize-DataPosInt >= Needed)
+                    break;
+                Needed -= DataSize-DataPosInt;
+                DataPosInt = 0;
+            }
+            else
+                DataPosInt -= DataSize;
+        }
+
+        BufferListItem = BufferListItem->next;
+        if(!BufferListItem && Looping)
+            BufferListItem = Source->queue;
+    }
+    return AL_TRUE;
 }
 
-DECL_TEMPLATE(point)
-DECL_TEMPLATE(lerp)
-DECL_TEMPLATE(cubic)
+/* Steps through the buffer queue once the play position has moved past the
+ * end of the current buffer (or loop). Returns AL_STOPPED when the end of a
+ * non-looping queue is reached, otherwise AL_PLAYING. */
+static ALenum UpdateQueuePosition(ALsource *Source, ALboolean Looping,
+  ALuint FrameSize, ALbufferlistitem **BufferListItem, ALuint *BuffersPlayed,
+  ALuint *DataPosInt, ALuint *DataPosFrac)
+{
+    while(1)
+    {
+        const ALbuffer *ALBuffer;
+        ALuint DataSize = 0;
+        ALuint LoopStart = 0;
+        ALuint LoopEnd = 0;
 
-#undef DECL_TEMPLATE
+        if((ALBuffer=(*BufferListItem)->buffer) != NULL)
+        {
+            DataSize = ALBuffer->size / FrameSize;
+            LoopStart = ALBuffer->LoopStart;
+            LoopEnd = ALBuffer->LoopEnd;
+            if(LoopEnd > *DataPosInt)
+                break;
+        }
+
+        if(Looping && Source->lSourceType == AL_STATIC)
+        {
+            *BufferListItem = Source->queue;
+            *DataPosInt = ((*DataPosInt-LoopStart)%(LoopEnd-LoopStart)) + LoopStart;
+            break;
+        }
+
+        if(DataSize > *DataPosInt)
+            break;
+
+        if((*BufferListItem)->next)
+        {
+            *BufferListItem = (*BufferListItem)->next;
+            (*BuffersPlayed)++;
+        }
+        else if(Looping)
+        {
+            *BufferListItem = Source->queue;
+            *BuffersPlayed = 0;
+        }
+        else
+        {
+            *BufferListItem = Source->queue;
+            *BuffersPlayed = Source->BuffersInQueue;
+            *DataPosInt = 0;
+            *DataPosFrac = 0;
+            return AL_STOPPED;
+        }
 
+        *DataPosInt -= DataSize;
+    }
+    return AL_PLAYING;
+}
 
-ALvoid MixSource(ALsource *Source, ALCdevice *Device, ALuint SamplesToDo)
+ALvoid MixSource(ALsource *Source, ALCdevice *Device, ALuint Worker,
+  ALuint SamplesToDo)
 {
     ALbufferlistitem *BufferListItem;
+    const ALbuffer *CallbackBuffer;
     ALuint DataPosInt, DataPosFrac;
     enum FmtChannels FmtChannels;
     enum FmtType FmtType;
@@ -493,12 +916,17 @@ ALvoid MixSource(ALsource *Source, ALCdevice *Device, ALuint SamplesToDo)
     ALboolean Looping;
     ALuint increment;
     resampler_t Resampler;
+    ResamplerFunc Resample;
     ALenum State;
     ALuint OutPos;
     ALuint FrameSize;
     ALint64 DataSize64;
     ALuint i;
 
+    /* Held until its parameters are worked out */
+    if(Source->Starting)
+        return;
+
     /* Get source info */
     State         = Source->state;
     BuffersPlayed = Source->BuffersPlayed;
@@ -526,18 +954,94 @@ ALvoid MixSource(ALsource *Source, ALCdevice *Device, ALuint SamplesToDo)
         }
         BufferListItem = BufferListItem->next;
     }
+    Resample = SelectResampler(Device->Mixer, Resampler, FmtType, increment);
 
     /* Get current buffer queue item */
     BufferListItem = Source->queue;
     for(i = 0;i < BuffersPlayed;i++)
         BufferListItem = BufferListItem->next;
 
+    /* If current pos is beyond the loop range, do not loop */
+    if(Source->lSourceType == AL_STATIC && Looping &&
+       DataPosInt >= (ALuint)Source->Buffer->LoopEnd)
+        Looping = AL_FALSE;
+
+    /* Callback buffers have no data, only a stream to pull from */
+    CallbackBuffer = NULL;
+    if(Source->lSourceType == AL_STATIC && Source->queue->buffer &&
+       Source->queue->buffer->Callback)
+        CallbackBuffer = Source->queue->buffer;
+
+    /* A source waiting on its buffers stays put until they're loaded */
+    if(State == AL_PLAYING && Source->WaitForBuffers &&
+       !SourceBuffersReady(Source, BufferListItem, Looping, FrameSize,
+                           Resampler, DataPosInt, DataPosFrac, increment,
+                           SamplesToDo))
+        return;
+
     OutPos = 0;
-    do {
+    if(Source->Culled ||
+       IsSourceInaudible(Source, Device, ChannelsFromFmt(FmtChannels)))
+    {
+        ALuint64 step;
+
+        /* Drop the filter state, so mixing picks up cleanly again once the
+         * source is audible. The click removal fades it back in. */
+        if(!Source->Virtual)
+        {
+            memset(Source->Params.history, 0, sizeof(Source->Params.history));
+            for(i = 0;i < MAX_SENDS;i++)
+                memset(Source->Params.Send[i].history, 0,
+                       sizeof(Source->Params.Send[i].history));
+            Source->Virtual = AL_TRUE;
+        }
+
+        step  = (ALuint64)SamplesToDo * increment;
+        step += DataPosFrac;
+        DataPosInt += (ALuint)(step>>FRACTIONBITS);
+        DataPosFrac = (ALuint)(step&FRACTIONMASK);
+        OutPos = SamplesToDo;
+
+        if(CallbackBuffer)
+        {
+            /* Keep the stream going along with the position */
+            FetchCallbackData(Source, CallbackBuffer, FrameSize,
+                              (ALint64)DataPosInt-ResamplerPrePadding[Resampler],
+                              0);
+            State = UpdateCallbackPosition(Source, &BuffersPlayed,
+                                           &DataPosInt, &DataPosFrac);
+        }
+        else
+            State = UpdateQueuePosition(Source, Looping, FrameSize,
+                                        &BufferListItem, &BuffersPlayed,
+                                        &DataPosInt, &DataPosFrac);
+    }
+    else
+    {
+        const ALbuffer *ALBuffer = (BufferListItem ? BufferListItem->buffer : NULL);
+
+        Source->Virtual = AL_FALSE;
+
+        /* Keep a mapped buffer's pages coming in ahead of the mix */
+        if(State == AL_PLAYING && ALBuffer && ALBuffer->MapBase)
+        {
+            if(Source->PrefetchBuffer != ALBuffer->buffer)
+            {
+                Source->PrefetchBuffer = ALBuffer->buffer;
+                Source->PrefetchEnd = 0;
+            }
+            Source->PrefetchEnd = PrefetchBufferData(ALBuffer, DataPosInt,
+                                                     Source->PrefetchEnd);
+        }
+    }
+
+    while(State == AL_PLAYING && OutPos < SamplesToDo)
+    {
         const ALuint BufferPrePadding = ResamplerPrePadding[Resampler];
         const ALuint BufferPadding = ResamplerPadding[Resampler];
         ALubyte StackData[STACK_DATA_SIZE];
         ALubyte *SrcData = StackData;
+        const ALubyte *DirectData = NULL;
         ALuint SrcDataSize = 0;
         ALuint BufferSize;
 
@@ -552,10 +1056,50 @@ ALvoid MixSource(ALsource *Source, ALCdevice *Device, ALuint SamplesToDo)
         BufferSize = min(DataSize64, STACK_DATA_SIZE);
         BufferSize -= BufferSize%FrameSize;
 
-        if(Source->lSourceType == AL_STATIC)
+        /* If the whole window, padding included, lies inside the current
+         * buffer (and loop range), resample straight from it. Only loop
+         * seams, queue boundaries and buffer edges need the stack copy. */
+        if(FrameSize > 0 && DataPosInt >= BufferPrePadding && !CallbackBuffer)
+        {
+            const ALbuffer *ALBuffer = BufferListItem->buffer;
+            ALuint Start = 0, End = 0;
+
+            if(Source->lSourceType == AL_STATIC)
+                ALBuffer = Source->Buffer;
+            if(ALBuffer && ALBuffer->FmtType != FmtIMA4 &&
+               BufferDataReady(ALBuffer))
+            {
+                End = ALBuffer->size / FrameSize;
+                if(Looping && Source->lSourceType == AL_STATIC)
+                {
+                    if(DataPosInt >= (ALuint)ALBuffer->LoopStart)
+                        Start = ALBuffer->LoopStart;
+                    End = ALBuffer->LoopEnd;
+                }
+            }
+            if(DataPosInt-BufferPrePadding >= Start &&
+               DataPosInt-BufferPrePadding < End &&
+               DataSize64 <= (ALint64)(End-(DataPosInt-BufferPrePadding))*FrameSize)
+                DirectData = (const ALubyte*)ALBuffer->data +
+                             (DataPosInt-BufferPrePadding)*FrameSize;
+        }
+
+        if(CallbackBuffer)
+        {
+            /* Pull in just what this pass needs */
+            DirectData = FetchCallbackData(Source, CallbackBuffer, FrameSize,
+                                           (ALint64)DataPosInt-BufferPrePadding,
+                                           BufferSize/FrameSize);
+            SrcDataSize = BufferSize;
+        }
+        else if(DirectData)
+        {
+            /* Read in place, nothing to stage */
+            SrcDataSize = (ALuint)DataSize64;
+        }
+        else if(Source->lSourceType == AL_STATIC)
         {
             const ALbuffer *ALBuffer = Source->Buffer;
-            const ALubyte *Data = ALBuffer->data;
             ALuint DataSize;
             ALuint pos;
 
@@ -583,7 +1127,7 @@ ALvoid MixSource(ALsource *Source, ALCdevice *Device, ALuint SamplesToDo)
                 DataSize = ALBuffer->size - pos;
                 DataSize = min(BufferSize, DataSize);
 
-                memcpy(&SrcData[SrcDataSize], &Data[pos], DataSize);
+                LoadBufferData(Source, ALBuffer, &SrcData[SrcDataSize], pos, DataSize);
                 SrcDataSize += DataSize;
                 BufferSize -= DataSize;
 
@@ -624,7 +1168,7 @@ ALvoid MixSource(ALsource *Source, ALCdevice *Device, ALuint SamplesToDo)
                 DataSize = LoopEnd*FrameSize - pos;
                 DataSize = min(BufferSize, DataSize);
 
-                memcpy(&SrcData[SrcDataSize], &Data[pos], DataSize);
+                LoadBufferData(Source, ALBuffer, &SrcData[SrcDataSize], pos, DataSize);
                 SrcDataSize += DataSize;
                 BufferSize -= DataSize;
 
@@ -633,7 +1177,8 @@ ALvoid MixSource(ALsource *Source, ALCdevice *Device, ALuint SamplesToDo)
                 {
                     DataSize = min(BufferSize, DataSize);
 
-                    memcpy(&SrcData[SrcDataSize], &Data[LoopStart*FrameSize], DataSize);
+                    LoadBufferData(Source, ALBuffer, &SrcData[SrcDataSize],
+                                   LoopStart*FrameSize, DataSize);
                     SrcDataSize += DataSize;
                     BufferSize -= DataSize;
                 }
@@ -689,7 +1234,6 @@ ALvoid MixSource(ALsource *Source, ALCdevice *Device, ALuint SamplesToDo)
                 const ALbuffer *ALBuffer;
                 if((ALBuffer=BufferListIter->buffer) != NULL)
                 {
-                    const ALubyte *Data = ALBuffer->data;
                     ALuint DataSize = ALBuffer->size;
 
                     /* Skip the data already played */
@@ -697,12 +1241,12 @@ ALvoid MixSource(ALsource *Source, ALCdevice *Device, ALuint SamplesToDo)
                         pos -= DataSize;
                     else
                     {
-                        Data += pos;
                         DataSize -= pos;
+                        DataSize = min(BufferSize, DataSize);
+                        LoadBufferData(Source, ALBuffer, &SrcData[SrcDataSize],
+                                       pos, DataSize);
                         pos -= pos;
 
-                        DataSize = min(BufferSize, DataSize);
-                        memcpy(&SrcData[SrcDataSize], Data, DataSize);
                         SrcDataSize += DataSize;
                         BufferSize -= DataSize;
                     }
@@ -729,80 +1273,22 @@ ALvoid MixSource(ALsource *Source, ALCdevice *Device, ALuint SamplesToDo)
         BufferSize = (ALuint)((DataSize64+(increment-1)) / increment);
         BufferSize = min(BufferSize, (SamplesToDo-OutPos));
 
-        SrcData += BufferPrePadding*FrameSize;
-        switch(Resampler)
-        {
-            case POINT_RESAMPLER:
-                Mix_point(Source, Device, FmtChannels, FmtType,
-                          SrcData, &DataPosInt, &DataPosFrac,
-                          OutPos, SamplesToDo, BufferSize);
-                break;
-            case LINEAR_RESAMPLER:
-                Mix_lerp(Source, Device, FmtChannels, FmtType,
-                         SrcData, &DataPosInt, &DataPosFrac,
-                         OutPos, SamplesToDo, BufferSize);
-                break;
-            case CUBIC_RESAMPLER:
-                Mix_cubic(Source, Device, FmtChannels, FmtType,
-                          SrcData, &DataPosInt, &DataPosFrac,
-                          OutPos, SamplesToDo, BufferSize);
-                break;
-            case RESAMPLER_MIN:
-            case RESAMPLER_MAX:
-            break;
-        }
+        if(!DirectData)
+            DirectData = SrcData;
+        Mix(Source, Device, Worker, FmtChannels, Resample,
+            DirectData + BufferPrePadding*FrameSize, &DataPosInt, &DataPosFrac,
+            OutPos, SamplesToDo, BufferSize);
         OutPos += BufferSize;
 
         /* Handle looping sources */
-        while(1)
-        {
-            const ALbuffer *ALBuffer;
-            ALuint DataSize = 0;
-            ALuint LoopStart = 0;
-            ALuint LoopEnd = 0;
-
-            if((ALBuffer=BufferListItem->buffer) != NULL)
-            {
-                DataSize = ALBuffer->size / FrameSize;
-                LoopStart = ALBuffer->LoopStart;
-                LoopEnd = ALBuffer->LoopEnd;
-                if(LoopEnd > DataPosInt)
-                    break;
-            }
-
-            if(Looping && Source->lSourceType == AL_STATIC)
-            {
-                BufferListItem = Source->queue;
-                DataPosInt = ((DataPosInt-LoopStart)%(LoopEnd-LoopStart)) + LoopStart;
-                break;
-            }
-
-            if(DataSize > DataPosInt)
-                break;
-
-            if(BufferListItem->next)
-            {
-                BufferListItem = BufferListItem->next;
-                BuffersPlayed++;
-            }
-            else if(Looping)
-            {
-                BufferListItem = Source->queue;
-                BuffersPlayed = 0;
-            }
-            else
-            {
-                State = AL_STOPPED;
-                BufferListItem = Source->queue;
-                BuffersPlayed = Source->BuffersInQueue;
-                DataPosInt = 0;
-                DataPosFrac = 0;
-                break;
-            }
-
-            DataPosInt -= DataSize;
-        }
-    } while(State == AL_PLAYING && OutPos < SamplesToDo);
+        if(CallbackBuffer)
+            State = UpdateCallbackPosition(Source, &BuffersPlayed,
+                                           &DataPosInt, &DataPosFrac);
+        else
+            State = UpdateQueuePosition(Source, Looping, FrameSize,
+                                        &BufferListItem, &BuffersPlayed,
+                                        &DataPosInt, &DataPosFrac);
+    }
 
     /* Update source info */
     Source->state             = State;
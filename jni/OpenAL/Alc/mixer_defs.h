@@ -0,0 +1,137 @@
+#ifndef MIXER_DEFS_H
+#define MIXER_DEFS_H
+
+#include "alMain.h"
+#include "alSource.h"
+
+/* The vector kernels only deal with float samples */
+#ifdef OPENAL_FIXED_POINT
+#undef HAVE_NEON
+#undef HAVE_SSE2
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Resamples dstlen samples of the given channel from interleaved source data
+ * with chans channels, starting at the given fractional position. */
+typedef ALvoid (*ResamplerFunc)(const ALvoid *src, ALuint chan, ALuint chans,
+                                ALuint frac, ALuint increment,
+                                ALsample *dst, ALuint dstlen);
+
+/* Adds len samples of src into dst */
+typedef ALvoid (*AccumulateFunc)(ALsample *dst, const ALsample *src, ALuint len);
+
+/* Sums count mix channels into one output channel, each scaled by its gain,
+ * in order: dst[i] = in[0][i]*gain[0] + in[1][i]*gain[1] + ... */
+typedef ALvoid (*MatrixMixFunc)(ALsample *dst, const ALsample *const *in,
+                                const ALsample *gain, ALuint count, ALuint len);
+
+/* Stores len mixed samples as one of the device's sample types, in every
+ * stride'th element of dst, clipped as the aluF2* functions do */
+typedef ALvoid (*StoreFunc)(ALvoid *dst, ALuint stride, const ALsample *src,
+                            ALuint len);
+
+/* Narrows len double samples, as given to alBufferData, to stored floats */
+typedef ALvoid (*NarrowFunc)(ALfp *dst, const ALdfp *src, ALuint len);
+
+/* Most sources whose geometry is worked out in one go */
+#define GEOMETRY_BLOCK 16
+
+/* The listener-relative geometry of a block of sources, one array per
+ * component so the kernels can work on several sources at once */
+typedef struct SourceGeometry {
+    /* In: the source position less the listener's, orientation and velocity.
+     * Out: the same in listener space, with the orientation normalized. */
+    ALfp Pos[3][GEOMETRY_BLOCK];
+    ALfp Dir[3][GEOMETRY_BLOCK];
+    ALfp Vel[3][GEOMETRY_BLOCK];
+
+    /* Out: the distance to the listener, the cosine of the angle between the
+     * source's orientation and the listener, the cosine of the angle between
+     * the listener's facing and the source, and the source and listener
+     * speeds along the source to listener vector */
+    ALfp Dist[GEOMETRY_BLOCK];
+    ALfp ConeCos[GEOMETRY_BLOCK];
+    ALfp BackCos[GEOMETRY_BLOCK];
+    ALfp SrcSpeed[GEOMETRY_BLOCK];
+    ALfp LisSpeed[GEOMETRY_BLOCK];
+} SourceGeometry;
+
+/* Works out the geometry of the first count sources. Sources are transformed
+ * into listener space by matrix, unless it is NULL, and listenerVel is the
+ * listener's velocity in listener space. count is rounded up to a multiple of
+ * four, so the extra entries must be filled in as well. */
+typedef ALvoid (*GeometryFunc)(SourceGeometry *geom, ALfp matrix[4][4],
+                               const ALfp *listenerVel, ALuint count);
+
+typedef struct MixerFuncs {
+    const char *Name;
+
+    /* Indexed by resampler_t */
+    ResamplerFunc UByte[RESAMPLER_MAX];
+    ResamplerFunc Short[RESAMPLER_MAX];
+    ResamplerFunc Float[RESAMPLER_MAX];
+
+    /* Used when the step is exactly one sample; frac and increment are
+     * ignored */
+    ResamplerFunc CopyUByte;
+    ResamplerFunc CopyShort;
+    ResamplerFunc CopyFloat;
+
+    /* Sums the worker threads' partial mixes */
+    AccumulateFunc Accumulate;
+
+    /* Turn the mix into the device's output */
+    MatrixMixFunc MatrixMix;
+    StoreFunc Store[DevFmtFloat+1]; /* Indexed by enum DevFmtType */
+
+    /* Buffer upload */
+    NarrowFunc NarrowDouble;
+
+    /* Source spatialization */
+    GeometryFunc Geometry;
+} MixerFuncs;
+
+#ifdef HAVE_NEON
+extern const MixerFuncs MixerFuncs_NEON;
+#endif
+#ifdef HAVE_SSE2
+extern const MixerFuncs MixerFuncs_SSE2;
+#endif
+
+
+/* Fills in the source offsets and fractions for the next group of four output
+ * samples, and steps the position past them. When fewer than four are left,
+ * the last one is repeated so the whole group can be loaded safely. Returns
+ * the number of valid samples in the group. */
+static __inline ALuint NextGroup4(ALint *idx, ALint *fr, ALuint todo,
+                                  ALuint chans, ALuint *pos, ALuint *frac,
+                                  ALuint increment)
+{
+    ALuint k;
+
+    todo = min(todo, 4);
+    for(k = 0;k < todo;k++)
+    {
+        idx[k] = *pos * chans;
+        fr[k] = *frac;
+
+        *frac += increment;
+        *pos  += *frac>>FRACTIONBITS;
+        *frac &= FRACTIONMASK;
+    }
+    for(;k < 4;k++)
+    {
+        idx[k] = idx[todo-1];
+        fr[k] = fr[todo-1];
+    }
+    return todo;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
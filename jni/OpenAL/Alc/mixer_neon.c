@@ -0,0 +1,502 @@
+/**
+ * OpenAL cross platform audio library
+ * Copyright (C) 2011 by authors.
+ * This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ *  License along with this library; if not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ *  Boston, MA  02111-1307, USA.
+ * Or go to http://www.gnu.org/copyleft/lgpl.html
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "alMain.h"
+#include "AL/al.h"
+#include "AL/alc.h"
+#include "alSource.h"
+#include "alu.h"
+#include "mixer_defs.h"
+
+#ifdef HAVE_NEON
+
+#include <arm_neon.h>
+
+
+static __inline float32x4_t Gather_ALubyte(const ALubyte *data, const ALint *idx, ALint off)
+{
+    ALsample tmp[4];
+    tmp[0] = (ALint)data[idx[0]+off]-128;
+    tmp[1] = (ALint)data[idx[1]+off]-128;
+    tmp[2] = (ALint)data[idx[2]+off]-128;
+    tmp[3] = (ALint)data[idx[3]+off]-128;
+    return vld1q_f32(tmp);
+}
+static __inline float32x4_t Gather_ALshort(const ALshort *data, const ALint *idx, ALint off)
+{
+    ALsample tmp[4];
+    tmp[0] = data[idx[0]+off];
+    tmp[1] = data[idx[1]+off];
+    tmp[2] = data[idx[2]+off];
+    tmp[3] = data[idx[3]+off];
+    return vld1q_f32(tmp);
+}
+static __inline float32x4_t Gather_ALfp(const ALfp *data, const ALint *idx, ALint off)
+{
+    ALsample tmp[4];
+    tmp[0] = data[idx[0]+off];
+    tmp[1] = data[idx[1]+off];
+    tmp[2] = data[idx[2]+off];
+    tmp[3] = data[idx[3]+off];
+    return vld1q_f32(tmp);
+}
+
+static __inline float32x4_t LoadFrac(const ALint *fr)
+{
+    return vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(fr)), 1.0f/FRACTIONONE);
+}
+
+static __inline void StoreGroup(ALsample *dst, float32x4_t val, ALuint count)
+{
+    if(count == 4)
+        vst1q_f32(dst, val);
+    else
+    {
+        ALsample tmp[4];
+        vst1q_f32(tmp, val);
+        memcpy(dst, tmp, count*sizeof(ALsample));
+    }
+}
+
+
+#define DECL_TEMPLATE(T, scale)                                               \
+static ALvoid Resample_##T##_point_NEON(const ALvoid *src, ALuint chan,       \
+  ALuint chans, ALuint frac, ALuint increment, ALsample *dst, ALuint dstlen)      \
+{                                                                             \
+    const T *data = (const T*)src + chan;                                     \
+    ALint idx[4], fr[4];                                                      \
+    ALuint pos = 0;                                                           \
+    ALuint i, todo;                                                           \
+                                                                              \
+    for(i = 0;i < dstlen;i += todo)                                           \
+    {                                                                         \
+        float32x4_t v0;                                                       \
+                                                                              \
+        todo = NextGroup4(idx, fr, dstlen-i, chans, &pos, &frac, increment);  \
+        v0 = Gather_##T(data, idx, 0);                                        \
+        StoreGroup(&dst[i], vmulq_n_f32(v0, scale), todo);                    \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+static ALvoid Resample_##T##_lerp_NEON(const ALvoid *src, ALuint chan,        \
+  ALuint chans, ALuint frac, ALuint increment, ALsample *dst, ALuint dstlen)      \
+{                                                                             \
+    const T *data = (const T*)src + chan;                                     \
+    ALint idx[4], fr[4];                                                      \
+    ALuint pos = 0;                                                           \
+    ALuint i, todo;                                                           \
+                                                                              \
+    for(i = 0;i < dstlen;i += todo)                                           \
+    {                                                                         \
+        float32x4_t v0, v1, mu, r;                                            \
+                                                                              \
+        todo = NextGroup4(idx, fr, dstlen-i, chans, &pos, &frac, increment);  \
+        v0 = Gather_##T(data, idx, 0);                                        \
+        v1 = Gather_##T(data, idx, chans);                                    \
+        mu = LoadFrac(fr);                                                    \
+                                                                              \
+        r = vmlaq_f32(v0, vsubq_f32(v1, v0), mu);                             \
+        StoreGroup(&dst[i], vmulq_n_f32(r, scale), todo);                     \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+static ALvoid Resample_##T##_cubic_NEON(const ALvoid *src, ALuint chan,       \
+  ALuint chans, ALuint frac, ALuint increment, ALsample *dst, ALuint dstlen)      \
+{                                                                             \
+    const T *data = (const T*)src + chan;                                     \
+    ALint idx[4], fr[4];                                                      \
+    ALuint pos = 0;                                                           \
+    ALuint i, todo;                                                           \
+                                                                              \
+    for(i = 0;i < dstlen;i += todo)                                           \
+    {                                                                         \
+        float32x4_t v0, v1, v2, v3, mu;                                       \
+        float32x4_t a0, a1, a2, r;                                            \
+                                                                              \
+        todo = NextGroup4(idx, fr, dstlen-i, chans, &pos, &frac, increment);  \
+        v0 = Gather_##T(data, idx, -(ALint)chans);                            \
+        v1 = Gather_##T(data, idx, 0);                                        \
+        v2 = Gather_##T(data, idx, chans);                                    \
+        v3 = Gather_##T(data, idx, chans*2);                                  \
+        mu = LoadFrac(fr);                                                    \
+                                                                              \
+        /* a0 = -0.5*v0 + 1.5*v1 - 1.5*v2 + 0.5*v3                           \
+         * a1 = v0 - 2.5*v1 + 2*v2 - 0.5*v3                                   \
+         * a2 = -0.5*v0 + 0.5*v2 */                                           \
+        a2 = vmulq_n_f32(vsubq_f32(v2, v0), 0.5f);                            \
+        a0 = vmlaq_n_f32(vmulq_n_f32(vsubq_f32(v3, v0), 0.5f),                \
+                         vsubq_f32(v1, v2), 1.5f);                            \
+        a1 = vmlsq_n_f32(vaddq_f32(v0, vaddq_f32(v2, v2)), v1, 2.5f);         \
+        a1 = vmlsq_n_f32(a1, v3, 0.5f);                                       \
+                                                                              \
+        r = vmlaq_f32(a1, a0, mu);                                            \
+        r = vmlaq_f32(a2, r, mu);                                             \
+        r = vmlaq_f32(v1, r, mu);                                             \
+        StoreGroup(&dst[i], vmulq_n_f32(r, scale), todo);                     \
+    }                                                                         \
+}
+
+DECL_TEMPLATE(ALubyte, 1.0f/127.0f)
+DECL_TEMPLATE(ALshort, 1.0f/32767.0f)
+DECL_TEMPLATE(ALfp, 1.0f)
+
+#undef DECL_TEMPLATE
+
+
+static __inline float32x4_t Cvt16(int16x4_t v, ALfloat scale)
+{ return vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(v)), scale); }
+
+static ALvoid Copy_ALubyte_NEON(const ALvoid *src, ALuint chan, ALuint chans,
+  ALuint frac, ALuint increment, ALsample *dst, ALuint dstlen)
+{
+    const ALubyte *data = (const ALubyte*)src;
+    const ALfloat scale = 1.0f/127.0f;
+    ALuint i = 0;
+
+    if(chans == 1)
+    {
+        for(;dstlen-i >= 8;i += 8)
+        {
+            int16x8_t v = vreinterpretq_s16_u16(vmovl_u8(vld1_u8(&data[i])));
+            v = vsubq_s16(v, vdupq_n_s16(128));
+            vst1q_f32(&dst[i],   Cvt16(vget_low_s16(v), scale));
+            vst1q_f32(&dst[i+4], Cvt16(vget_high_s16(v), scale));
+        }
+    }
+    for(;i < dstlen;i++)
+        dst[i] = ((ALint)data[i*chans + chan]-128) * scale;
+    (void)frac;
+    (void)increment;
+}
+
+static ALvoid Copy_ALshort_NEON(const ALvoid *src, ALuint chan, ALuint chans,
+  ALuint frac, ALuint increment, ALsample *dst, ALuint dstlen)
+{
+    const ALshort *data = (const ALshort*)src;
+    const ALfloat scale = 1.0f/32767.0f;
+    ALuint i = 0;
+
+    if(chans == 1)
+    {
+        for(;dstlen-i >= 8;i += 8)
+        {
+            int16x8_t v = vld1q_s16(&data[i]);
+            vst1q_f32(&dst[i],   Cvt16(vget_low_s16(v), scale));
+            vst1q_f32(&dst[i+4], Cvt16(vget_high_s16(v), scale));
+        }
+    }
+    else if(chans == 2)
+    {
+        for(;dstlen-i >= 4;i += 4)
+        {
+            int16x4x2_t v = vld2_s16(&data[i*2]);
+            vst1q_f32(&dst[i], Cvt16(v.val[chan], scale));
+        }
+    }
+    for(;i < dstlen;i++)
+        dst[i] = data[i*chans + chan] * scale;
+    (void)frac;
+    (void)increment;
+}
+
+static ALvoid Copy_ALfp_NEON(const ALvoid *src, ALuint chan, ALuint chans,
+  ALuint frac, ALuint increment, ALsample *dst, ALuint dstlen)
+{
+    const ALfp *data = (const ALfp*)src + chan;
+    ALuint i;
+
+    if(chans == 1)
+        memcpy(dst, data, dstlen*sizeof(ALsample));
+    else
+    {
+        for(i = 0;i < dstlen;i++)
+            dst[i] = data[i*chans];
+    }
+    (void)frac;
+    (void)increment;
+}
+
+static ALvoid Accumulate_NEON(ALsample *dst, const ALsample *src, ALuint len)
+{
+    ALuint i = 0;
+
+    for(;len-i >= 8;i += 8)
+    {
+        vst1q_f32(&dst[i],   vaddq_f32(vld1q_f32(&dst[i]),   vld1q_f32(&src[i])));
+        vst1q_f32(&dst[i+4], vaddq_f32(vld1q_f32(&dst[i+4]), vld1q_f32(&src[i+4])));
+    }
+    for(;i < len;i++)
+        dst[i] += src[i];
+}
+
+static ALvoid MatrixMix_NEON(ALsample *dst, const ALsample *const *in,
+  const ALsample *gain, ALuint count, ALuint len)
+{
+    ALuint i = 0, c;
+
+    for(;len-i >= 4;i += 4)
+    {
+        float32x4_t samp = vdupq_n_f32(0.0f);
+        for(c = 0;c < count;c++)
+            samp = vaddq_f32(samp, vmulq_n_f32(vld1q_f32(&in[c][i]), gain[c]));
+        vst1q_f32(&dst[i], samp);
+    }
+    for(;i < len;i++)
+    {
+        ALsample samp = 0.0f;
+        for(c = 0;c < count;c++)
+            samp += in[c][i] * gain[c];
+        dst[i] = samp;
+    }
+}
+
+/* Converts eight samples to 16-bit as aluF2S does: truncated, with anything
+ * past full scale clipped to 32767 or -32768 */
+static __inline int16x8_t CvtS16(const ALsample *src)
+{
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t none = vdupq_n_f32(-1.0f);
+    float32x4_t v0 = vld1q_f32(src);
+    float32x4_t v1 = vld1q_f32(src+4);
+    int32x4_t i0, i1;
+
+    i0 = vcvtq_s32_f32(vmulq_n_f32(vminq_f32(vmaxq_f32(v0, none), one), 32767.0f));
+    i1 = vcvtq_s32_f32(vmulq_n_f32(vminq_f32(vmaxq_f32(v1, none), one), 32767.0f));
+    /* Below -1 gives -32767 so far; the all-ones compare mask takes one more */
+    i0 = vaddq_s32(i0, vreinterpretq_s32_u32(vcltq_f32(v0, none)));
+    i1 = vaddq_s32(i1, vreinterpretq_s32_u32(vcltq_f32(v1, none)));
+    return vcombine_s16(vmovn_s32(i0), vmovn_s32(i1));
+}
+
+static ALvoid Store_ALshort_NEON(ALvoid *dst, ALuint stride, const ALsample *src,
+  ALuint len)
+{
+    ALshort *out = (ALshort*)dst;
+    ALshort tmp[8];
+    ALuint i = 0, k;
+
+    for(;len-i >= 8;i += 8)
+    {
+        if(stride == 1)
+            vst1q_s16(&out[i], CvtS16(&src[i]));
+        else
+        {
+            vst1q_s16(tmp, CvtS16(&src[i]));
+            for(k = 0;k < 8;k++)
+                out[(i+k)*stride] = tmp[k];
+        }
+    }
+    for(;i < len;i++)
+        out[i*stride] = aluF2S(src[i]);
+}
+
+static ALvoid Store_ALushort_NEON(ALvoid *dst, ALuint stride, const ALsample *src,
+  ALuint len)
+{
+    ALushort *out = (ALushort*)dst;
+    const uint16x8_t bias = vdupq_n_u16(0x8000);
+    ALushort tmp[8];
+    ALuint i = 0, k;
+
+    for(;len-i >= 8;i += 8)
+    {
+        uint16x8_t v = veorq_u16(vreinterpretq_u16_s16(CvtS16(&src[i])), bias);
+        if(stride == 1)
+            vst1q_u16(&out[i], v);
+        else
+        {
+            vst1q_u16(tmp, v);
+            for(k = 0;k < 8;k++)
+                out[(i+k)*stride] = tmp[k];
+        }
+    }
+    for(;i < len;i++)
+        out[i*stride] = aluF2US(src[i]);
+}
+
+static ALvoid Store_ALbyte_NEON(ALvoid *dst, ALuint stride, const ALsample *src,
+  ALuint len)
+{
+    ALbyte *out = (ALbyte*)dst;
+    ALbyte tmp[8];
+    ALuint i = 0, k;
+
+    for(;len-i >= 8;i += 8)
+    {
+        int8x8_t v = vshrn_n_s16(CvtS16(&src[i]), 8);
+        if(stride == 1)
+            vst1_s8(&out[i], v);
+        else
+        {
+            vst1_s8(tmp, v);
+            for(k = 0;k < 8;k++)
+                out[(i+k)*stride] = tmp[k];
+        }
+    }
+    for(;i < len;i++)
+        out[i*stride] = aluF2B(src[i]);
+}
+
+static ALvoid Store_ALubyte_NEON(ALvoid *dst, ALuint stride, const ALsample *src,
+  ALuint len)
+{
+    ALubyte *out = (ALubyte*)dst;
+    const uint16x8_t bias = vdupq_n_u16(0x8000);
+    ALubyte tmp[8];
+    ALuint i = 0, k;
+
+    for(;len-i >= 8;i += 8)
+    {
+        uint8x8_t v = vshrn_n_u16(veorq_u16(vreinterpretq_u16_s16(CvtS16(&src[i])),
+                                            bias), 8);
+        if(stride == 1)
+            vst1_u8(&out[i], v);
+        else
+        {
+            vst1_u8(tmp, v);
+            for(k = 0;k < 8;k++)
+                out[(i+k)*stride] = tmp[k];
+        }
+    }
+    for(;i < len;i++)
+        out[i*stride] = aluF2UB(src[i]);
+}
+
+static ALvoid Store_ALfloat_NEON(ALvoid *dst, ALuint stride, const ALsample *src,
+  ALuint len)
+{
+    ALfloat *out = (ALfloat*)dst;
+    ALuint i;
+
+    if(stride == 1)
+        memcpy(out, src, len*sizeof(ALfloat));
+    else for(i = 0;i < len;i++)
+        out[i*stride] = src[i];
+}
+
+/* ARMv7 NEON has no double precision */
+static ALvoid NarrowDouble_NEON(ALfp *dst, const ALdfp *src, ALuint len)
+{
+    ALuint i;
+    for(i = 0;i < len;i++)
+        dst[i] = (ALfp)src[i];
+}
+
+static __inline float32x4_t Dot3(const float32x4_t *a, const float32x4_t *b)
+{
+    return vaddq_f32(vaddq_f32(vmulq_f32(a[0], b[0]), vmulq_f32(a[1], b[1])),
+                     vmulq_f32(a[2], b[2]));
+}
+
+static __inline void Transform3(float32x4_t *v, ALfp matrix[4][4])
+{
+    float32x4_t r[3];
+    ALuint c;
+    for(c = 0;c < 3;c++)
+        r[c] = vaddq_f32(vaddq_f32(vmulq_n_f32(v[0], matrix[0][c]),
+                                   vmulq_n_f32(v[1], matrix[1][c])),
+                         vmulq_n_f32(v[2], matrix[2][c]));
+    v[0] = r[0]; v[1] = r[1]; v[2] = r[2];
+}
+
+/* Scales v to unit length, leaving zero-length vectors alone, and returns the
+ * original length. NEON only has estimates for the square root and
+ * reciprocal, so those are done a lane at a time to match the C version. */
+static __inline float32x4_t Normalize3(float32x4_t *v)
+{
+    ALfloat length[4], invlen[4];
+    float32x4_t scale;
+    ALuint k, c;
+
+    vst1q_f32(length, Dot3(v, v));
+    for(k = 0;k < 4;k++)
+    {
+        length[k] = aluSqrt(length[k]);
+        invlen[k] = ((length[k] != 0.0f) ? 1.0f/length[k] : 1.0f);
+    }
+    scale = vld1q_f32(invlen);
+    for(c = 0;c < 3;c++)
+        v[c] = vmulq_f32(v[c], scale);
+    return vld1q_f32(length);
+}
+
+static ALvoid Geometry_NEON(SourceGeometry *geom, ALfp matrix[4][4],
+  const ALfp *listenerVel, ALuint count)
+{
+    const float32x4_t lvel[3] = {
+        vdupq_n_f32(listenerVel[0]), vdupq_n_f32(listenerVel[1]),
+        vdupq_n_f32(listenerVel[2])
+    };
+    float32x4_t pos[3], dir[3], vel[3], tolis[3];
+    ALuint i, c;
+
+    for(i = 0;i < count;i += 4)
+    {
+        for(c = 0;c < 3;c++)
+        {
+            pos[c] = vld1q_f32(&geom->Pos[c][i]);
+            dir[c] = vld1q_f32(&geom->Dir[c][i]);
+            vel[c] = vld1q_f32(&geom->Vel[c][i]);
+        }
+        if(matrix)
+        {
+            Transform3(pos, matrix);
+            Transform3(dir, matrix);
+            Transform3(vel, matrix);
+        }
+        Normalize3(dir);
+
+        for(c = 0;c < 3;c++)
+            tolis[c] = vnegq_f32(pos[c]);
+        vst1q_f32(&geom->Dist[i], Normalize3(tolis));
+
+        for(c = 0;c < 3;c++)
+        {
+            vst1q_f32(&geom->Pos[c][i], pos[c]);
+            vst1q_f32(&geom->Dir[c][i], dir[c]);
+            vst1q_f32(&geom->Vel[c][i], vel[c]);
+        }
+        vst1q_f32(&geom->ConeCos[i], Dot3(dir, tolis));
+        vst1q_f32(&geom->BackCos[i], tolis[2]);
+        vst1q_f32(&geom->SrcSpeed[i], Dot3(vel, tolis));
+        vst1q_f32(&geom->LisSpeed[i], Dot3(lvel, tolis));
+    }
+}
+
+
+const MixerFuncs MixerFuncs_NEON = {
+    "NEON",
+    { Resample_ALubyte_point_NEON, Resample_ALubyte_lerp_NEON, Resample_ALubyte_cubic_NEON },
+    { Resample_ALshort_point_NEON, Resample_ALshort_lerp_NEON, Resample_ALshort_cubic_NEON },
+    { Resample_ALfp_point_NEON,    Resample_ALfp_lerp_NEON,    Resample_ALfp_cubic_NEON },
+    Copy_ALubyte_NEON, Copy_ALshort_NEON, Copy_ALfp_NEON,
+    Accumulate_NEON,
+    MatrixMix_NEON,
+    { Store_ALbyte_NEON, Store_ALubyte_NEON, Store_ALshort_NEON,
+      Store_ALushort_NEON, Store_ALfloat_NEON },
+    NarrowDouble_NEON,
+    Geometry_NEON
+};
+
+#endif
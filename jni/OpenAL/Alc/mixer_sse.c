@@ -0,0 +1,491 @@
+/**
+ * OpenAL cross platform audio library
+ * Copyright (C) 2011 by authors.
+ * This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ *  License along with this library; if not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ *  Boston, MA  02111-1307, USA.
+ * Or go to http://www.gnu.org/copyleft/lgpl.html
+ */
+
+#include "config.h"
+
+#include <string.h>
+
+#include "alMain.h"
+#include "AL/al.h"
+#include "AL/alc.h"
+#include "alSource.h"
+#include "alu.h"
+#include "mixer_defs.h"
+
+#ifdef HAVE_SSE2
+
+#include <emmintrin.h>
+
+
+static __inline __m128 Gather_ALubyte(const ALubyte *data, const ALint *idx, ALint off)
+{
+    return _mm_setr_ps((ALint)data[idx[0]+off]-128, (ALint)data[idx[1]+off]-128,
+                       (ALint)data[idx[2]+off]-128, (ALint)data[idx[3]+off]-128);
+}
+static __inline __m128 Gather_ALshort(const ALshort *data, const ALint *idx, ALint off)
+{
+    return _mm_setr_ps(data[idx[0]+off], data[idx[1]+off],
+                       data[idx[2]+off], data[idx[3]+off]);
+}
+static __inline __m128 Gather_ALfp(const ALfp *data, const ALint *idx, ALint off)
+{
+    return _mm_setr_ps(data[idx[0]+off], data[idx[1]+off],
+                       data[idx[2]+off], data[idx[3]+off]);
+}
+
+static __inline __m128 LoadFrac(const ALint *fr)
+{
+    return _mm_mul_ps(_mm_cvtepi32_ps(_mm_loadu_si128((const __m128i*)fr)),
+                      _mm_set1_ps(1.0f/FRACTIONONE));
+}
+
+static __inline void StoreGroup(ALsample *dst, __m128 val, ALuint count)
+{
+    if(count == 4)
+        _mm_storeu_ps(dst, val);
+    else
+    {
+        ALsample tmp[4];
+        _mm_storeu_ps(tmp, val);
+        memcpy(dst, tmp, count*sizeof(ALsample));
+    }
+}
+
+
+#define DECL_TEMPLATE(T, scale)                                               \
+static ALvoid Resample_##T##_point_SSE2(const ALvoid *src, ALuint chan,       \
+  ALuint chans, ALuint frac, ALuint increment, ALsample *dst, ALuint dstlen)      \
+{                                                                             \
+    const T *data = (const T*)src + chan;                                     \
+    const __m128 vscale = _mm_set1_ps(scale);                                 \
+    ALint idx[4], fr[4];                                                      \
+    ALuint pos = 0;                                                           \
+    ALuint i, todo;                                                           \
+                                                                              \
+    for(i = 0;i < dstlen;i += todo)                                           \
+    {                                                                         \
+        __m128 v0;                                                            \
+                                                                              \
+        todo = NextGroup4(idx, fr, dstlen-i, chans, &pos, &frac, increment);  \
+        v0 = Gather_##T(data, idx, 0);                                        \
+        StoreGroup(&dst[i], _mm_mul_ps(v0, vscale), todo);                    \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+static ALvoid Resample_##T##_lerp_SSE2(const ALvoid *src, ALuint chan,        \
+  ALuint chans, ALuint frac, ALuint increment, ALsample *dst, ALuint dstlen)      \
+{                                                                             \
+    const T *data = (const T*)src + chan;                                     \
+    const __m128 vscale = _mm_set1_ps(scale);                                 \
+    ALint idx[4], fr[4];                                                      \
+    ALuint pos = 0;                                                           \
+    ALuint i, todo;                                                           \
+                                                                              \
+    for(i = 0;i < dstlen;i += todo)                                           \
+    {                                                                         \
+        __m128 v0, v1, mu, r;                                                 \
+                                                                              \
+        todo = NextGroup4(idx, fr, dstlen-i, chans, &pos, &frac, increment);  \
+        v0 = Gather_##T(data, idx, 0);                                        \
+        v1 = Gather_##T(data, idx, chans);                                    \
+        mu = LoadFrac(fr);                                                    \
+                                                                              \
+        r = _mm_add_ps(v0, _mm_mul_ps(_mm_sub_ps(v1, v0), mu));               \
+        StoreGroup(&dst[i], _mm_mul_ps(r, vscale), todo);                     \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+static ALvoid Resample_##T##_cubic_SSE2(const ALvoid *src, ALuint chan,       \
+  ALuint chans, ALuint frac, ALuint increment, ALsample *dst, ALuint dstlen)      \
+{                                                                             \
+    const T *data = (const T*)src + chan;                                     \
+    const __m128 vscale = _mm_set1_ps(scale);                                 \
+    const __m128 half = _mm_set1_ps(0.5f);                                    \
+    ALint idx[4], fr[4];                                                      \
+    ALuint pos = 0;                                                           \
+    ALuint i, todo;                                                           \
+                                                                              \
+    for(i = 0;i < dstlen;i += todo)                                           \
+    {                                                                         \
+        __m128 v0, v1, v2, v3, mu;                                            \
+        __m128 a0, a1, a2, r;                                                 \
+                                                                              \
+        todo = NextGroup4(idx, fr, dstlen-i, chans, &pos, &frac, increment);  \
+        v0 = Gather_##T(data, idx, -(ALint)chans);                            \
+        v1 = Gather_##T(data, idx, 0);                                        \
+        v2 = Gather_##T(data, idx, chans);                                    \
+        v3 = Gather_##T(data, idx, chans*2);                                  \
+        mu = LoadFrac(fr);                                                    \
+                                                                              \
+        /* a0 = -0.5*v0 + 1.5*v1 - 1.5*v2 + 0.5*v3                           \
+         * a1 = v0 - 2.5*v1 + 2*v2 - 0.5*v3                                   \
+         * a2 = -0.5*v0 + 0.5*v2 */                                           \
+        a2 = _mm_mul_ps(_mm_sub_ps(v2, v0), half);                            \
+        a0 = _mm_add_ps(_mm_mul_ps(_mm_sub_ps(v3, v0), half),                 \
+                        _mm_mul_ps(_mm_sub_ps(v1, v2), _mm_set1_ps(1.5f)));   \
+        a1 = _mm_sub_ps(_mm_add_ps(v0, _mm_add_ps(v2, v2)),                   \
+                        _mm_add_ps(_mm_mul_ps(v1, _mm_set1_ps(2.5f)),         \
+                                   _mm_mul_ps(v3, half)));                    \
+                                                                              \
+        r = _mm_add_ps(_mm_mul_ps(a0, mu), a1);                               \
+        r = _mm_add_ps(_mm_mul_ps(r, mu), a2);                                \
+        r = _mm_add_ps(_mm_mul_ps(r, mu), v1);                                \
+        StoreGroup(&dst[i], _mm_mul_ps(r, vscale), todo);                     \
+    }                                                                         \
+}
+
+DECL_TEMPLATE(ALubyte, 1.0f/127.0f)
+DECL_TEMPLATE(ALshort, 1.0f/32767.0f)
+DECL_TEMPLATE(ALfp, 1.0f)
+
+#undef DECL_TEMPLATE
+
+
+/* Sign-extends the low or high 16 bits of each 32-bit lane */
+static __inline __m128 CvtLo16(__m128i v)
+{ return _mm_cvtepi32_ps(_mm_srai_epi32(_mm_slli_epi32(v, 16), 16)); }
+static __inline __m128 CvtHi16(__m128i v)
+{ return _mm_cvtepi32_ps(_mm_srai_epi32(v, 16)); }
+
+static ALvoid Copy_ALubyte_SSE2(const ALvoid *src, ALuint chan, ALuint chans,
+  ALuint frac, ALuint increment, ALsample *dst, ALuint dstlen)
+{
+    const ALubyte *data = (const ALubyte*)src;
+    const __m128 vscale = _mm_set1_ps(1.0f/127.0f);
+    const __m128i bias = _mm_set1_epi16(128);
+    ALuint i = 0;
+
+    if(chans == 1)
+    {
+        for(;dstlen-i >= 8;i += 8)
+        {
+            __m128i v = _mm_loadl_epi64((const __m128i*)&data[i]);
+            v = _mm_sub_epi16(_mm_unpacklo_epi8(v, _mm_setzero_si128()), bias);
+            _mm_storeu_ps(&dst[i],   _mm_mul_ps(CvtHi16(_mm_unpacklo_epi16(v, v)), vscale));
+            _mm_storeu_ps(&dst[i+4], _mm_mul_ps(CvtHi16(_mm_unpackhi_epi16(v, v)), vscale));
+        }
+    }
+    for(;i < dstlen;i++)
+        dst[i] = ((ALint)data[i*chans + chan]-128) * (1.0f/127.0f);
+    (void)frac;
+    (void)increment;
+}
+
+static ALvoid Copy_ALshort_SSE2(const ALvoid *src, ALuint chan, ALuint chans,
+  ALuint frac, ALuint increment, ALsample *dst, ALuint dstlen)
+{
+    const ALshort *data = (const ALshort*)src;
+    const __m128 vscale = _mm_set1_ps(1.0f/32767.0f);
+    ALuint i = 0;
+
+    if(chans == 1)
+    {
+        for(;dstlen-i >= 8;i += 8)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)&data[i]);
+            _mm_storeu_ps(&dst[i],   _mm_mul_ps(CvtHi16(_mm_unpacklo_epi16(v, v)), vscale));
+            _mm_storeu_ps(&dst[i+4], _mm_mul_ps(CvtHi16(_mm_unpackhi_epi16(v, v)), vscale));
+        }
+    }
+    else if(chans == 2)
+    {
+        /* Each 32-bit lane holds one frame; pick the wanted half */
+        for(;dstlen-i >= 4;i += 4)
+        {
+            __m128i v = _mm_loadu_si128((const __m128i*)&data[i*2]);
+            _mm_storeu_ps(&dst[i], _mm_mul_ps((chan ? CvtHi16(v) : CvtLo16(v)), vscale));
+        }
+    }
+    for(;i < dstlen;i++)
+        dst[i] = data[i*chans + chan] * (1.0f/32767.0f);
+    (void)frac;
+    (void)increment;
+}
+
+static ALvoid Copy_ALfp_SSE2(const ALvoid *src, ALuint chan, ALuint chans,
+  ALuint frac, ALuint increment, ALsample *dst, ALuint dstlen)
+{
+    const ALfp *data = (const ALfp*)src + chan;
+    ALuint i;
+
+    if(chans == 1)
+        memcpy(dst, data, dstlen*sizeof(ALsample));
+    else
+    {
+        for(i = 0;i < dstlen;i++)
+            dst[i] = data[i*chans];
+    }
+    (void)frac;
+    (void)increment;
+}
+
+static ALvoid Accumulate_SSE2(ALsample *dst, const ALsample *src, ALuint len)
+{
+    ALuint i = 0;
+
+    for(;len-i >= 8;i += 8)
+    {
+        _mm_storeu_ps(&dst[i],   _mm_add_ps(_mm_loadu_ps(&dst[i]),
+                                            _mm_loadu_ps(&src[i])));
+        _mm_storeu_ps(&dst[i+4], _mm_add_ps(_mm_loadu_ps(&dst[i+4]),
+                                            _mm_loadu_ps(&src[i+4])));
+    }
+    for(;i < len;i++)
+        dst[i] += src[i];
+}
+
+static ALvoid MatrixMix_SSE2(ALsample *dst, const ALsample *const *in,
+  const ALsample *gain, ALuint count, ALuint len)
+{
+    ALuint i = 0, c;
+
+    for(;len-i >= 4;i += 4)
+    {
+        __m128 samp = _mm_setzero_ps();
+        for(c = 0;c < count;c++)
+            samp = _mm_add_ps(samp, _mm_mul_ps(_mm_loadu_ps(&in[c][i]),
+                                               _mm_set1_ps(gain[c])));
+        _mm_storeu_ps(&dst[i], samp);
+    }
+    for(;i < len;i++)
+    {
+        ALsample samp = 0.0f;
+        for(c = 0;c < count;c++)
+            samp += in[c][i] * gain[c];
+        dst[i] = samp;
+    }
+}
+
+/* Converts eight samples to 16-bit as aluF2S does: truncated, with anything
+ * past full scale clipped to 32767 or -32768 */
+static __inline __m128i CvtS16(const ALsample *src)
+{
+    const __m128 one = _mm_set1_ps(1.0f);
+    const __m128 none = _mm_set1_ps(-1.0f);
+    const __m128 scale = _mm_set1_ps(32767.0f);
+    __m128 v0 = _mm_loadu_ps(src);
+    __m128 v1 = _mm_loadu_ps(src+4);
+    __m128i i0, i1;
+
+    i0 = _mm_cvttps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(v0, none), one), scale));
+    i1 = _mm_cvttps_epi32(_mm_mul_ps(_mm_min_ps(_mm_max_ps(v1, none), one), scale));
+    /* Below -1 gives -32767 so far; the all-ones compare mask takes one more */
+    i0 = _mm_add_epi32(i0, _mm_castps_si128(_mm_cmplt_ps(v0, none)));
+    i1 = _mm_add_epi32(i1, _mm_castps_si128(_mm_cmplt_ps(v1, none)));
+    return _mm_packs_epi32(i0, i1);
+}
+
+/* Stores eight 16-bit or 8-bit results held in a vector, every stride'th
+ * element */
+#define DECL_TEMPLATE(T)                                                      \
+static __inline void Scatter_##T(T *out, ALuint stride, __m128i v)           \
+{                                                                             \
+    T tmp[16];                                                                \
+    ALuint k;                                                                 \
+                                                                              \
+    _mm_storeu_si128((__m128i*)tmp, v);                                       \
+    if(stride == 1)                                                           \
+        memcpy(out, tmp, 8*sizeof(T));                                        \
+    else for(k = 0;k < 8;k++)                                                 \
+        out[k*stride] = tmp[k];                                               \
+}
+
+DECL_TEMPLATE(ALbyte)
+DECL_TEMPLATE(ALubyte)
+DECL_TEMPLATE(ALshort)
+DECL_TEMPLATE(ALushort)
+
+#undef DECL_TEMPLATE
+
+static ALvoid Store_ALshort_SSE2(ALvoid *dst, ALuint stride, const ALsample *src,
+  ALuint len)
+{
+    ALshort *out = (ALshort*)dst;
+    ALuint i = 0;
+
+    for(;len-i >= 8;i += 8)
+        Scatter_ALshort(&out[i*stride], stride, CvtS16(&src[i]));
+    for(;i < len;i++)
+        out[i*stride] = aluF2S(src[i]);
+}
+
+static ALvoid Store_ALushort_SSE2(ALvoid *dst, ALuint stride, const ALsample *src,
+  ALuint len)
+{
+    ALushort *out = (ALushort*)dst;
+    const __m128i bias = _mm_set1_epi16(-32768);
+    ALuint i = 0;
+
+    for(;len-i >= 8;i += 8)
+        Scatter_ALushort(&out[i*stride], stride,
+                         _mm_xor_si128(CvtS16(&src[i]), bias));
+    for(;i < len;i++)
+        out[i*stride] = aluF2US(src[i]);
+}
+
+static ALvoid Store_ALbyte_SSE2(ALvoid *dst, ALuint stride, const ALsample *src,
+  ALuint len)
+{
+    ALbyte *out = (ALbyte*)dst;
+    ALuint i = 0;
+
+    for(;len-i >= 8;i += 8)
+    {
+        __m128i v = _mm_srai_epi16(CvtS16(&src[i]), 8);
+        Scatter_ALbyte(&out[i*stride], stride, _mm_packs_epi16(v, v));
+    }
+    for(;i < len;i++)
+        out[i*stride] = aluF2B(src[i]);
+}
+
+static ALvoid Store_ALubyte_SSE2(ALvoid *dst, ALuint stride, const ALsample *src,
+  ALuint len)
+{
+    ALubyte *out = (ALubyte*)dst;
+    const __m128i bias = _mm_set1_epi16(-32768);
+    ALuint i = 0;
+
+    for(;len-i >= 8;i += 8)
+    {
+        __m128i v = _mm_xor_si128(CvtS16(&src[i]), bias);
+        v = _mm_srli_epi16(v, 8);
+        Scatter_ALubyte(&out[i*stride], stride, _mm_packus_epi16(v, v));
+    }
+    for(;i < len;i++)
+        out[i*stride] = aluF2UB(src[i]);
+}
+
+static ALvoid Store_ALfloat_SSE2(ALvoid *dst, ALuint stride, const ALsample *src,
+  ALuint len)
+{
+    ALfloat *out = (ALfloat*)dst;
+    ALuint i;
+
+    if(stride == 1)
+        memcpy(out, src, len*sizeof(ALfloat));
+    else for(i = 0;i < len;i++)
+        out[i*stride] = src[i];
+}
+
+static ALvoid NarrowDouble_SSE2(ALfp *dst, const ALdfp *src, ALuint len)
+{
+    ALuint i = 0;
+
+    for(;len-i >= 4;i += 4)
+    {
+        __m128 lo = _mm_cvtpd_ps(_mm_loadu_pd(&src[i]));
+        __m128 hi = _mm_cvtpd_ps(_mm_loadu_pd(&src[i+2]));
+        _mm_storeu_ps(&dst[i], _mm_movelh_ps(lo, hi));
+    }
+    for(;i < len;i++)
+        dst[i] = (ALfp)src[i];
+}
+
+static __inline __m128 Dot3(const __m128 *a, const __m128 *b)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(a[0], b[0]), _mm_mul_ps(a[1], b[1])),
+                      _mm_mul_ps(a[2], b[2]));
+}
+
+static __inline void Transform3(__m128 *v, ALfp matrix[4][4])
+{
+    __m128 r[3];
+    ALuint c;
+    for(c = 0;c < 3;c++)
+        r[c] = _mm_add_ps(_mm_add_ps(_mm_mul_ps(v[0], _mm_set1_ps(matrix[0][c])),
+                                     _mm_mul_ps(v[1], _mm_set1_ps(matrix[1][c]))),
+                          _mm_mul_ps(v[2], _mm_set1_ps(matrix[2][c])));
+    v[0] = r[0]; v[1] = r[1]; v[2] = r[2];
+}
+
+/* Scales v to unit length, leaving zero-length vectors alone, and returns the
+ * original length */
+static __inline __m128 Normalize3(__m128 *v)
+{
+    __m128 length = _mm_sqrt_ps(Dot3(v, v));
+    __m128 nonzero = _mm_cmpneq_ps(length, _mm_setzero_ps());
+    __m128 invlen = _mm_div_ps(_mm_set1_ps(1.0f), length);
+    ALuint c;
+    for(c = 0;c < 3;c++)
+        v[c] = _mm_or_ps(_mm_and_ps(nonzero, _mm_mul_ps(v[c], invlen)),
+                         _mm_andnot_ps(nonzero, v[c]));
+    return length;
+}
+
+static ALvoid Geometry_SSE2(SourceGeometry *geom, ALfp matrix[4][4],
+  const ALfp *listenerVel, ALuint count)
+{
+    const __m128 lvel[3] = {
+        _mm_set1_ps(listenerVel[0]), _mm_set1_ps(listenerVel[1]),
+        _mm_set1_ps(listenerVel[2])
+    };
+    const __m128 sign = _mm_set1_ps(-0.0f);
+    __m128 pos[3], dir[3], vel[3], tolis[3];
+    ALuint i, c;
+
+    for(i = 0;i < count;i += 4)
+    {
+        for(c = 0;c < 3;c++)
+        {
+            pos[c] = _mm_loadu_ps(&geom->Pos[c][i]);
+            dir[c] = _mm_loadu_ps(&geom->Dir[c][i]);
+            vel[c] = _mm_loadu_ps(&geom->Vel[c][i]);
+        }
+        if(matrix)
+        {
+            Transform3(pos, matrix);
+            Transform3(dir, matrix);
+            Transform3(vel, matrix);
+        }
+        Normalize3(dir);
+
+        for(c = 0;c < 3;c++)
+            tolis[c] = _mm_xor_ps(pos[c], sign);
+        _mm_storeu_ps(&geom->Dist[i], Normalize3(tolis));
+
+        for(c = 0;c < 3;c++)
+        {
+            _mm_storeu_ps(&geom->Pos[c][i], pos[c]);
+            _mm_storeu_ps(&geom->Dir[c][i], dir[c]);
+            _mm_storeu_ps(&geom->Vel[c][i], vel[c]);
+        }
+        _mm_storeu_ps(&geom->ConeCos[i], Dot3(dir, tolis));
+        _mm_storeu_ps(&geom->BackCos[i], tolis[2]);
+        _mm_storeu_ps(&geom->SrcSpeed[i], Dot3(vel, tolis));
+        _mm_storeu_ps(&geom->LisSpeed[i], Dot3(lvel, tolis));
+    }
+}
+
+
+const MixerFuncs MixerFuncs_SSE2 = {
+    "SSE2",
+    { Resample_ALubyte_point_SSE2, Resample_ALubyte_lerp_SSE2, Resample_ALubyte_cubic_SSE2 },
+    { Resample_ALshort_point_SSE2, Resample_ALshort_lerp_SSE2, Resample_ALshort_cubic_SSE2 },
+    { Resample_ALfp_point_SSE2,    Resample_ALfp_lerp_SSE2,    Resample_ALfp_cubic_SSE2 },
+    Copy_ALubyte_SSE2, Copy_ALshort_SSE2, Copy_ALfp_SSE2,
+    Accumulate_SSE2,
+    MatrixMix_SSE2,
+    { Store_ALbyte_SSE2, Store_ALubyte_SSE2, Store_ALshort_SSE2,
+      Store_ALushort_SSE2, Store_ALfloat_SSE2 },
+    NarrowDouble_SSE2,
+    Geometry_SSE2
+};
+
+#endif
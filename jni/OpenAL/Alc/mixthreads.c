@@ -0,0 +1,322 @@
+/**
+ * OpenAL cross platform audio library
+ * Copyright (C) 2011 by authors.
+ * This library is free software; you can redistribute it and/or
+ *  modify it under the terms of the GNU Library General Public
+ *  License as published by the Free Software Foundation; either
+ *  version 2 of the License, or (at your option) any later version.
+ *
+ * This library is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ *  Library General Public License for more details.
+ *
+ * You should have received a copy of the GNU Library General Public
+ *  License along with this library; if not, write to the
+ *  Free Software Foundation, Inc., 59 Temple Place - Suite 330,
+ *  Boston, MA  02111-1307, USA.
+ * Or go to http://www.gnu.org/copyleft/lgpl.html
+ */
+
+#include "config.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "alMain.h"
+#include "AL/al.h"
+#include "AL/alc.h"
+#include "alSource.h"
+#include "alAuxEffectSlot.h"
+#include "alu.h"
+#include "mixer_defs.h"
+
+
+/* Fewer active sources than this are not worth waking the workers for */
+#define MIN_THREADED_SOURCES 4
+
+#ifndef _WIN32
+
+typedef struct ALmixworker {
+    struct ALmixpool *Pool;
+    ALuint Worker;
+    ALvoid *Thread;
+} ALmixworker;
+
+typedef struct ALmixpool {
+    pthread_mutex_t Lock;
+    pthread_cond_t  Start;
+    pthread_cond_t  Done;
+
+    // Bumped for every batch; workers wait for it to change
+    ALuint    Generation;
+    ALuint    Busy;
+    ALboolean Quit;
+
+    // The current batch. Sources are handed out one at a time from Next.
+    ALCdevice *Device;
+    ALsource **Sources;
+    ALsizei    Count;
+    ALuint     SamplesToDo;
+    volatile ALsizei Next;
+
+    ALmixworker Workers[MAX_MIX_THREADS-1];
+    ALuint      NumWorkers;
+} ALmixpool;
+
+
+static ALvoid MixShare(ALmixpool *Pool, ALuint Worker)
+{
+    ALsizei i;
+
+    while((i=__sync_fetch_and_add(&Pool->Next, 1)) < Pool->Count)
+        MixSource(Pool->Sources[i], Pool->Device, Worker, Pool->SamplesToDo);
+}
+
+static ALuint MixThreadProc(ALvoid *ptr)
+{
+    ALmixworker *self = (ALmixworker*)ptr;
+    ALmixpool *Pool = self->Pool;
+    /* Not read from the pool: a batch may have gone out before this thread
+     * got going, and it is counted on to take part */
+    ALuint gen = 0;
+
+    pthread_mutex_lock(&Pool->Lock);
+    while(1)
+    {
+        while(!Pool->Quit && Pool->Generation == gen)
+            pthread_cond_wait(&Pool->Start, &Pool->Lock);
+        if(Pool->Quit)
+            break;
+        gen = Pool->Generation;
+        pthread_mutex_unlock(&Pool->Lock);
+
+        MixShare(Pool, self->Worker);
+
+        pthread_mutex_lock(&Pool->Lock);
+        if(--Pool->Busy == 0)
+            pthread_cond_signal(&Pool->Done);
+    }
+    pthread_mutex_unlock(&Pool->Lock);
+
+    return 0;
+}
+
+static ALvoid StopWorkers(ALmixpool *Pool)
+{
+    ALuint i;
+
+    pthread_mutex_lock(&Pool->Lock);
+    Pool->Quit = AL_TRUE;
+    pthread_cond_broadcast(&Pool->Start);
+    pthread_mutex_unlock(&Pool->Lock);
+
+    for(i = 0;i < Pool->NumWorkers;i++)
+        StopThread(Pool->Workers[i].Thread);
+    Pool->NumWorkers = 0;
+}
+
+static ALint GetNumCores(void)
+{
+    long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return ((cores > 0) ? (ALint)cores : 1);
+}
+
+/*
+    aluStartMixThreads
+
+    Sets up the threads that share the source mixing with the device's own,
+    one per core up to MAX_MIX_THREADS unless the "threads" option says
+    otherwise. Falls back to mixing serially when they can't be had.
+*/
+ALvoid aluStartMixThreads(ALCdevice *Device)
+{
+    ALmixpool *Pool;
+    ALint count;
+    ALint i;
+
+    Device->NumMixThreads = 1;
+    Device->MixAccum = NULL;
+    Device->MixPool = NULL;
+
+    count = GetConfigValueInt(NULL, "threads", 0);
+    if(count == 0)
+        count = GetNumCores();
+    count = min(count, MAX_MIX_THREADS);
+    if(count <= 1)
+        return;
+
+    Pool = calloc(1, sizeof(ALmixpool));
+    Device->MixAccum = al_calloc(MIX_ALIGN, (count-1)*sizeof(ALmixaccum));
+    if(!Pool || !Device->MixAccum)
+    {
+        free(Pool);
+        al_free(Device->MixAccum);
+        Device->MixAccum = NULL;
+        return;
+    }
+
+    pthread_mutex_init(&Pool->Lock, NULL);
+    pthread_cond_init(&Pool->Start, NULL);
+    pthread_cond_init(&Pool->Done, NULL);
+
+    for(i = 0;i < count-1;i++)
+    {
+        ALmixworker *Worker = &Pool->Workers[Pool->NumWorkers];
+
+        Worker->Pool = Pool;
+        Worker->Worker = Pool->NumWorkers+1;
+        Worker->Thread = StartThread(MixThreadProc, Worker);
+        if(!Worker->Thread)
+            break;
+        Pool->NumWorkers++;
+    }
+
+    Device->NumMixThreads = Pool->NumWorkers+1;
+    Device->MixPool = Pool;
+}
+
+ALvoid aluStopMixThreads(ALCdevice *Device)
+{
+    ALmixpool *Pool = Device->MixPool;
+
+    if(Pool)
+    {
+        StopWorkers(Pool);
+        pthread_cond_destroy(&Pool->Done);
+        pthread_cond_destroy(&Pool->Start);
+        pthread_mutex_destroy(&Pool->Lock);
+        free(Pool);
+    }
+    al_free(Device->MixAccum);
+
+    Device->NumMixThreads = 1;
+    Device->MixAccum = NULL;
+    Device->MixPool = NULL;
+}
+
+static ALvoid MixThreaded(ALCdevice *Device, ALsource **Sources, ALsizei Count,
+                          ALuint SamplesToDo)
+{
+    ALmixpool *Pool = Device->MixPool;
+
+    pthread_mutex_lock(&Pool->Lock);
+    Pool->Device = Device;
+    Pool->Sources = Sources;
+    Pool->Count = Count;
+    Pool->SamplesToDo = SamplesToDo;
+    Pool->Next = 0;
+    Pool->Busy = Pool->NumWorkers;
+    Pool->Generation++;
+    pthread_cond_broadcast(&Pool->Start);
+    pthread_mutex_unlock(&Pool->Lock);
+
+    /* This thread takes its share too */
+    MixShare(Pool, 0);
+
+    pthread_mutex_lock(&Pool->Lock);
+    while(Pool->Busy > 0)
+        pthread_cond_wait(&Pool->Done, &Pool->Lock);
+    pthread_mutex_unlock(&Pool->Lock);
+}
+
+#else
+
+ALvoid aluStartMixThreads(ALCdevice *Device)
+{
+    Device->NumMixThreads = 1;
+    Device->MixAccum = NULL;
+    Device->MixPool = NULL;
+}
+
+ALvoid aluStopMixThreads(ALCdevice *Device)
+{
+    (void)Device;
+}
+
+static ALvoid MixThreaded(ALCdevice *Device, ALsource **Sources, ALsizei Count,
+                          ALuint SamplesToDo)
+{
+    ALsizei i;
+    for(i = 0;i < Count;i++)
+        MixSource(Sources[i], Device, 0, SamplesToDo);
+}
+
+#endif
+
+
+/* Adds the workers' partial mixes into the device's dry buffer and the
+ * context's effect slot inputs, and clears them for the next batch */
+static ALvoid SumWorkers(ALCdevice *Device, ALCcontext *Context,
+                         ALuint SamplesToDo)
+{
+    AccumulateFunc Accumulate = Device->Mixer->Accumulate;
+    ALuint w, c;
+    ALsizei e;
+
+    for(w = 0;w < Device->NumMixThreads-1;w++)
+    {
+        ALmixaccum *Accum = &Device->MixAccum[w];
+
+        if(!Accum->Used)
+            continue;
+        for(c = 0;c < MAXCHANNELS;c++)
+        {
+            Accumulate(Device->DryBuffer[c], Accum->DryBuffer[c], SamplesToDo);
+            memset(Accum->DryBuffer[c], 0, SamplesToDo*sizeof(ALsample));
+
+            Device->ClickRemoval[c] += Accum->ClickRemoval[c];
+            Device->PendingClicks[c] += Accum->PendingClicks[c];
+            Accum->ClickRemoval[c] = int2ALfp(0);
+            Accum->PendingClicks[c] = int2ALfp(0);
+        }
+        Accum->Used = AL_FALSE;
+    }
+
+    for(e = 0;e < Context->EffectSlotMap.size;e++)
+    {
+        ALeffectslot *Slot = Context->EffectSlotMap.array[e].value;
+
+        if(!Slot->WorkerWet)
+            continue;
+        for(w = 0;w < Device->NumMixThreads-1;w++)
+        {
+            ALwetaccum *Accum = &Slot->WorkerWet[w];
+
+            if(!Accum->Used)
+                continue;
+            Accumulate(Slot->WetBuffer, Accum->WetBuffer, SamplesToDo);
+            memset(Accum->WetBuffer, 0, SamplesToDo*sizeof(ALsample));
+
+            Slot->ClickRemoval[0] += Accum->ClickRemoval[0];
+            Slot->PendingClicks[0] += Accum->PendingClicks[0];
+            Accum->ClickRemoval[0] = int2ALfp(0);
+            Accum->PendingClicks[0] = int2ALfp(0);
+            Accum->Used = AL_FALSE;
+        }
+    }
+}
+
+/*
+    aluMixSources
+
+    Mixes the context's active sources into the device's dry buffer and the
+    effect slot inputs, spread over the device's mixing threads when there
+    are enough of them to be worth it. Called with the device locked.
+*/
+ALvoid aluMixSources(ALCdevice *Device, ALCcontext *Context, ALuint SamplesToDo)
+{
+    ALsource **src = Context->ActiveSources;
+    ALsizei count = Context->ActiveSourceCount;
+    ALsizei i;
+
+    if(Device->NumMixThreads <= 1 || count < MIN_THREADED_SOURCES)
+    {
+        for(i = 0;i < count;i++)
+            MixSource(src[i], Device, 0, SamplesToDo);
+        return;
+    }
+
+    MixThreaded(Device, src, count, SamplesToDo);
+    SumWorkers(Device, Context, SamplesToDo);
+}
@@ -18,6 +18,8 @@
  * It is based on source code for the native-audio sample app bundled with NDK.
  */
 
+#include "config.h"
+
 #include <stdlib.h>
 #include <time.h>
 #include <sys/types.h>
@@ -353,8 +353,8 @@ ALvoid aluInitPanning(ALCdevice *Device)
                 /* source between speaker s and speaker s+1 */
                 Alpha = ALfpDiv(ALfpMult(float2ALfp(M_PI_2), (Theta-SpeakerAngle[s])),
                                  (SpeakerAngle[s+1]-SpeakerAngle[s]));
-                PanningLUT[offset + Speaker2Chan[s]]   = __cos(Alpha);
-                PanningLUT[offset + Speaker2Chan[s+1]] = __sin(Alpha);
+                PanningLUT[offset + Speaker2Chan[s]]   = aluCos(Alpha);
+                PanningLUT[offset + Speaker2Chan[s+1]] = aluSin(Alpha);
                 break;
             }
         }
@@ -365,8 +365,8 @@ ALvoid aluInitPanning(ALCdevice *Device)
                 Theta = (Theta + float2ALfp(2.0f * M_PI));
             Alpha = ALfpDiv(ALfpMult(float2ALfp(M_PI_2), (Theta-SpeakerAngle[s])),
                              (float2ALfp(2.0f * M_PI) + SpeakerAngle[0]-SpeakerAngle[s]));
-            PanningLUT[offset + Speaker2Chan[s]] = __cos(Alpha);
-            PanningLUT[offset + Speaker2Chan[0]] = __sin(Alpha);
+            PanningLUT[offset + Speaker2Chan[s]] = aluCos(Alpha);
+            PanningLUT[offset + Speaker2Chan[0]] = aluSin(Alpha);
         }
     }
 }
@@ -320,7 +320,7 @@ static void stream_buffer_attr_callback(pa_stream *stream, void *pdata) //{{{
     ALCdevice *Device = pdata;
     pulse_data *data = Device->ExtraData;
 
-    SuspendContext(NULL);
+    LockDevice(Device);
 
     data->attr = *(ppa_stream_get_buffer_attr(stream));
     Device->UpdateSize = data->attr.minreq / data->frame_size;
@@ -331,7 +331,7 @@ static void stream_buffer_attr_callback(pa_stream *stream, void *pdata) //{{{
         AL_PRINT("PulseAudio returned minreq > tlength/2; expect break up\n");
     }
 
-    ProcessContext(NULL);
+    UnlockDevice(Device);
 }//}}}
 
 static void stream_device_callback(pa_stream *stream, void *pdata) //{{{
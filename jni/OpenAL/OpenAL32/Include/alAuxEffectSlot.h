@@ -11,6 +11,16 @@ extern "C" {
 
 typedef struct ALeffectState ALeffectState;
 
+/* A mixing worker's share of a slot's input */
+typedef struct ALwetaccum {
+    ALIGN(MIX_ALIGN) ALsample WetBuffer[BUFFERSIZE];
+
+    ALsample ClickRemoval[1];
+    ALsample PendingClicks[1];
+
+    ALboolean Used;
+} ALwetaccum;
+
 typedef struct ALeffectslot
 {
     ALeffect effect;
@@ -20,10 +30,13 @@ typedef struct ALeffectslot
 
     ALeffectState *EffectState;
 
-    ALfp WetBuffer[BUFFERSIZE];
+    ALsample WetBuffer[BUFFERSIZE];
+
+    ALsample ClickRemoval[1];
+    ALsample PendingClicks[1];
 
-    ALfp ClickRemoval[1];
-    ALfp PendingClicks[1];
+    // One per extra mixing thread on the device, or NULL
+    ALwetaccum *WorkerWet;
 
     ALuint refcount;
 
@@ -41,7 +54,7 @@ struct ALeffectState {
     ALvoid (*Destroy)(ALeffectState *State);
     ALboolean (*DeviceUpdate)(ALeffectState *State, ALCdevice *Device);
     ALvoid (*Update)(ALeffectState *State, ALCcontext *Context, const ALeffect *Effect);
-    ALvoid (*Process)(ALeffectState *State, const ALeffectslot *Slot, ALuint SamplesToDo, const ALfp *SamplesIn, ALfp (*SamplesOut)[MAXCHANNELS]);
+    ALvoid (*Process)(ALeffectState *State, const ALeffectslot *Slot, ALuint SamplesToDo, const ALsample *SamplesIn, ALsample (*SamplesOut)[BUFFERSIZE]);
 };
 
 ALeffectState *NoneCreate(void);
@@ -2,6 +2,7 @@
 #define _AL_BUFFER_H_
 
 #include "AL/al.h"
+#include "AL/alext.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -46,6 +47,7 @@ enum FmtType {
     FmtUByte = UserFmtUByte,
     FmtShort = UserFmtShort,
     FmtFloat = UserFmtFloat,
+    FmtIMA4  = UserFmtIMA4, /* Kept compressed, decoded to 16-bit when mixed */
 };
 enum FmtChannels {
     FmtMono = UserFmtMono,
@@ -65,11 +67,34 @@ static __inline ALuint FrameSizeFromFmt(enum FmtChannels chans, enum FmtType typ
     return ChannelsFromFmt(chans) * BytesFromFmt(type);
 }
 
+/* An IMA4 block holds this many frames in 36 bytes per channel. IMA4 buffers
+ * are mono or stereo. */
+#define IMA4_BLOCK_FRAMES 65
+#define IMA4_BLOCK_SIZE   36
+
+ALvoid DecodeIMA4Block(ALshort *dst, const ALubyte *src, ALint numchans);
+
 
 typedef struct ALbuffer
 {
     ALvoid  *data;
-    ALsizei  size;
+    ALsizei  size; // In decoded bytes; IMA4 data takes up less
+    ALuint   DataId; // Changes along with the data, for caches of it
+    // data isn't ours to free or realloc; it belongs to the application
+    // (alBufferDataStatic) or to a file mapping
+    ALboolean StaticData;
+    // The read-only file mapping data lies in, if any
+    ALvoid  *MapBase;
+    size_t   MapSize;
+
+    // Set for a buffer without data, that the mixer pulls samples from as it
+    // plays (alBufferCallbackSOFT)
+    ALBUFFERCALLBACKTYPESOFT Callback;
+    ALvoid  *UserData;
+
+    // Set while the loader thread is still converting the data into place
+    // (alBufferDataAsyncSOFT)
+    ALuint   Loading;
 
     ALsizei          Frequency;
     enum FmtChannels FmtChannels;
@@ -79,6 +104,14 @@ typedef struct ALbuffer
     enum UserFmtType     OriginalType;
     ALsizei OriginalSize;
     ALsizei OriginalAlign;
+    // Differs from Frequency when the data was resampled on loading
+    ALsizei OriginalFrequency;
+
+    // Resample data given to alBufferData to the device's rate
+    // (AL_BUFFER_PRERESAMPLE_SOFT). alBufferData does so with the device
+    // held, keeping the mixer out until it's done; alBufferDataAsyncSOFT
+    // leaves it to the loader thread.
+    ALboolean Preresample;
 
     ALsizei  LoopStart;
     ALsizei  LoopEnd;
@@ -89,7 +122,35 @@ typedef struct ALbuffer
     ALuint buffer;
 } ALbuffer;
 
+/* Whether the buffer's data can be read yet. The flag is read as an atomic
+ * operation, so data the loader thread wrote is seen along with it going off. */
+static __inline ALboolean BufferDataReady(const ALbuffer *ALBuf)
+{
+    return !__sync_fetch_and_add((ALuint*)&ALBuf->Loading, 0);
+}
+
+/* Sample frame positions the app gives and gets back are at the rate it gave
+ * the data at. These convert them to and from the stored frames, for a buffer
+ * that was resampled on loading. */
+static __inline ALuint FramesFromOriginal(const ALbuffer *ALBuf, ALuint frames)
+{
+    if(ALBuf->Frequency == ALBuf->OriginalFrequency)
+        return frames;
+    return (ALuint)(((ALuint64)frames*ALBuf->Frequency + ALBuf->OriginalFrequency/2) /
+                    ALBuf->OriginalFrequency);
+}
+static __inline ALuint FramesToOriginal(const ALbuffer *ALBuf, ALuint frames)
+{
+    if(ALBuf->Frequency == ALBuf->OriginalFrequency)
+        return frames;
+    return (ALuint)(((ALuint64)frames*ALBuf->OriginalFrequency + ALBuf->Frequency/2) /
+                    ALBuf->Frequency);
+}
+
+ALuint PrefetchBufferData(const ALbuffer *ALBuf, ALuint pos, ALuint end);
 ALvoid ReleaseALBuffers(ALCdevice *device);
+ALvoid ReleaseBufferLoader(void);
+ALvoid InitBufferResampler(void);
 
 #ifdef __cplusplus
 }
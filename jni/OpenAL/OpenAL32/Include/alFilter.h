@@ -9,91 +9,91 @@ extern "C" {
 #endif
 
 typedef struct {
-    ALfp coeff;
+    ALsample coeff;
 #ifndef _MSC_VER
-    ALfp history[0];
+    ALsample history[0];
 #else
-    ALfp history[1];
+    ALsample history[1];
 #endif
 } FILTER;
 
-static __inline ALfp lpFilter4P(FILTER *iir, ALuint offset, ALfp input)
+static __inline ALsample lpFilter4P(FILTER *iir, ALuint offset, ALsample input)
 {
-    ALfp *history = &iir->history[offset];
-	ALfp a = iir->coeff;
-	ALfp output = input;
+    ALsample *history = &iir->history[offset];
+	ALsample a = iir->coeff;
+	ALsample output = input;
 
-    output = output + ALfpMult((history[0]-output),a);
+    output = output + ALsampleMult((history[0]-output),a);
     history[0] = output;
-    output = output + ALfpMult((history[1]-output),a);
+    output = output + ALsampleMult((history[1]-output),a);
     history[1] = output;
-    output = output + ALfpMult((history[2]-output),a);
+    output = output + ALsampleMult((history[2]-output),a);
     history[2] = output;
-    output = output + ALfpMult((history[3]-output),a);
+    output = output + ALsampleMult((history[3]-output),a);
     history[3] = output;
 
     return output;
 }
 
-static __inline ALfp lpFilter2P(FILTER *iir, ALuint offset, ALfp input)
+static __inline ALsample lpFilter2P(FILTER *iir, ALuint offset, ALsample input)
 {
-    ALfp *history = &iir->history[offset];
-    ALfp a = iir->coeff;
-    ALfp output = input;
+    ALsample *history = &iir->history[offset];
+    ALsample a = iir->coeff;
+    ALsample output = input;
 
-    output = output + ALfpMult((history[0]-output),a);
+    output = output + ALsampleMult((history[0]-output),a);
     history[0] = output;
-    output = output + ALfpMult((history[1]-output),a);
+    output = output + ALsampleMult((history[1]-output),a);
     history[1] = output;
 
     return output;
 }
 
-static __inline ALfp lpFilter1P(FILTER *iir, ALuint offset, ALfp input)
+static __inline ALsample lpFilter1P(FILTER *iir, ALuint offset, ALsample input)
 {
-    ALfp *history = &iir->history[offset];
-    ALfp a = iir->coeff;
-    ALfp output = input;
+    ALsample *history = &iir->history[offset];
+    ALsample a = iir->coeff;
+    ALsample output = input;
 
-    output = output + ALfpMult((history[0]-output),a);
+    output = output + ALsampleMult((history[0]-output),a);
     history[0] = output;
 
     return output;
 }
 
-static __inline ALfp lpFilter4PC(const FILTER *iir, ALuint offset, ALfp input)
+static __inline ALsample lpFilter4PC(const FILTER *iir, ALuint offset, ALsample input)
 {
-    const ALfp *history = &iir->history[offset];
-    ALfp a = iir->coeff;
-    ALfp output = input;
+    const ALsample *history = &iir->history[offset];
+    ALsample a = iir->coeff;
+    ALsample output = input;
 
-    output = output + ALfpMult((history[0]-output),a);
-    output = output + ALfpMult((history[1]-output),a);
-    output = output + ALfpMult((history[2]-output),a);
-    output = output + ALfpMult((history[3]-output),a);
+    output = output + ALsampleMult((history[0]-output),a);
+    output = output + ALsampleMult((history[1]-output),a);
+    output = output + ALsampleMult((history[2]-output),a);
+    output = output + ALsampleMult((history[3]-output),a);
 
     return output;
 }
 
-static __inline ALfp lpFilter2PC(const FILTER *iir, ALuint offset, ALfp input)
+static __inline ALsample lpFilter2PC(const FILTER *iir, ALuint offset, ALsample input)
 {
-    const ALfp *history = &iir->history[offset];
-    ALfp a = iir->coeff;
-    ALfp output = input;
+    const ALsample *history = &iir->history[offset];
+    ALsample a = iir->coeff;
+    ALsample output = input;
 
-    output = output + ALfpMult((history[0]-output),a);
-    output = output + ALfpMult((history[1]-output),a);
+    output = output + ALsampleMult((history[0]-output),a);
+    output = output + ALsampleMult((history[1]-output),a);
 
     return output;
 }
 
-static __inline ALfp lpFilter1PC(FILTER *iir, ALuint offset, ALfp input)
+static __inline ALsample lpFilter1PC(FILTER *iir, ALuint offset, ALsample input)
 {
-    const ALfp *history = &iir->history[offset];
-    ALfp a = iir->coeff;
-    ALfp output = input;
+    const ALsample *history = &iir->history[offset];
+    ALsample a = iir->coeff;
+    ALsample output = input;
 
-    output = output + ALfpMult((history[0]-output),a);
+    output = output + ALsampleMult((history[0]-output),a);
 
     return output;
 }
@@ -91,6 +91,17 @@ typedef unsigned long long ALuint64;
 #define PRINTF_STYLE(x, y)
 #endif
 
+#if defined(__GNUC__)
+#define ALIGN(x) __attribute__((aligned(x)))
+#elif defined(_MSC_VER)
+#define ALIGN(x) __declspec(align(x))
+#else
+#define ALIGN(x)
+#endif
+
+/* Alignment for the mixing buffers; one cache line */
+#define MIX_ALIGN 64
+
 #ifdef _WIN32
 
 #ifndef _WIN32_WINNT
@@ -137,6 +148,11 @@ static __inline void LeaveCriticalSection(CRITICAL_SECTION *cs)
     ret = pthread_mutex_unlock(cs);
     assert(ret == 0);
 }
+/* Returns non-zero if the lock was taken, like the Win32 call */
+static __inline int TryEnterCriticalSection(CRITICAL_SECTION *cs)
+{
+    return (pthread_mutex_trylock(cs) == 0);
+}
 static __inline void InitializeCriticalSection(CRITICAL_SECTION *cs)
 {
     pthread_mutexattr_t attrib;
@@ -302,6 +318,8 @@ void alc_null_deinit(void);
 void alc_null_probe(int type);
 
 
+/* Entries are kept packed in array, in no particular order, for walking over.
+ * Keys are found through an open-addressed hash index into it. */
 typedef struct UIntMap {
     struct {
         ALuint key;
@@ -309,6 +327,10 @@ typedef struct UIntMap {
     } *array;
     ALsizei size;
     ALsizei maxsize;
+
+    // Positions in array, -1 for an empty slot; twice maxsize long
+    ALint  *index;
+    ALuint  indexmask;
 } UIntMap;
 
 void InitUIntMap(UIntMap *map);
@@ -343,11 +365,27 @@ static __inline ALuint FrameSizeFromDevFmt(enum DevFmtChannels chans,
 }
 
 
+/* A mixing worker's share of the dry mix, summed into the device's before
+ * the effects run */
+typedef struct ALmixaccum {
+    ALIGN(MIX_ALIGN) ALsample DryBuffer[MAXCHANNELS][BUFFERSIZE];
+
+    ALsample ClickRemoval[MAXCHANNELS];
+    ALsample PendingClicks[MAXCHANNELS];
+
+    // Set when anything was mixed in since the last sum
+    ALboolean Used;
+} ALmixaccum;
+
 struct ALCdevice_struct
 {
     ALCboolean   Connected;
     ALboolean    IsCaptureDevice;
 
+    // Held while mixing, and while changing anything the mixer reads that
+    // isn't per-context. Taken before any context's lock.
+    CRITICAL_SECTION Mutex;
+
     ALuint       Frequency;
     ALuint       UpdateSize;
     ALuint       NumUpdates;
@@ -389,8 +427,12 @@ struct ALCdevice_struct
     // Duplicate stereo sources on the side/rear channels
     ALboolean    DuplicateStereo;
 
-    // Dry path buffer mix
-    ALfp DryBuffer[BUFFERSIZE][MAXCHANNELS];
+    // Resamplers, picked at open for the host CPU
+    const struct MixerFuncs *Mixer;
+
+    // Dry path buffer mix, one contiguous block per channel. The device must
+    // be allocated with al_calloc for the alignment to hold.
+    ALIGN(MIX_ALIGN) ALsample DryBuffer[MAXCHANNELS][BUFFERSIZE];
 
     ALuint DevChannels[MAXCHANNELS];
 
@@ -400,8 +442,20 @@ struct ALCdevice_struct
     ALfp PanningLUT[MAXCHANNELS * LUT_NUM];
     ALuint  NumChan;
 
-    ALfp ClickRemoval[MAXCHANNELS];
-    ALfp PendingClicks[MAXCHANNELS];
+    ALsample ClickRemoval[MAXCHANNELS];
+    ALsample PendingClicks[MAXCHANNELS];
+
+    // Threads sharing the source mixing, this one included, and the
+    // accumulation buffers of the other NumMixThreads-1
+    ALuint       NumMixThreads;
+    ALmixaccum  *MixAccum;
+
+    // Voice scheduling budget in VoiceCost units, adapted to the measured
+    // mixing time; MixedCost is what was actually mixed, summed over every
+    // output sample of the last update
+    ALint        MixBudget;
+    ALint64      MixedCost;
+    struct ALmixpool *MixPool;
 
     // Contexts created on this device
     ALCcontext  **Contexts;
@@ -424,8 +478,21 @@ struct ALCdevice_struct
 #define ALCdevice_CaptureSamples(a,b,c)  ((a)->Funcs->CaptureSamples((a), (b), (c)))
 #define ALCdevice_AvailableSamples(a)    ((a)->Funcs->AvailableSamples((a)))
 
+/* Size of a context's queue of source state changes; a power of two */
+#define SOURCE_CMD_QUEUE_SIZE 256
+
+typedef struct ALsourcecmd {
+    struct ALsource *Source;
+    // AL_PLAYING, AL_PAUSED, AL_STOPPED or AL_INITIAL
+    ALenum State;
+} ALsourcecmd;
+
 struct ALCcontext_struct
 {
+    // Guards the context's state. The mixer only takes it to pick up
+    // changes between updates.
+    CRITICAL_SECTION Mutex;
+
     ALlistener  Listener;
 
     UIntMap SourceMap;
@@ -445,10 +512,33 @@ struct ALCcontext_struct
     ALfp     DopplerVelocity;
     ALfp     flSpeedOfSound;
 
+    // Bumped instead of flagging every source when something they all
+    // depend on changes. The mixer recalculates a source when it last did so
+    // at an older generation. ListenerGen is for the listener's position,
+    // orientation and velocity, which head-relative sources don't use.
+    ALuint      UpdateGen;
+    ALuint      ListenerGen;
+
+    // Set between alDeferUpdatesSOFT and alProcessUpdatesSOFT. The mixer
+    // leaves the sources' parameters alone meanwhile, and state changes are
+    // held back, so a batch of changes is heard all at once.
+    ALboolean   DeferUpdates;
+
+    // Only touched with the device held. Kept big enough for every source
+    // in the context, so the mixer never has to grow it.
     struct ALsource **ActiveSources;
     ALsizei           ActiveSourceCount;
     ALsizei           MaxActiveSources;
 
+    // Play/pause/stop/rewind requests on their way to the mixer. Posted with
+    // the context locked, applied with the device held. The mixer only sees
+    // those before SourceCmdWrite; the rest, up to SourceCmdQueued, are held
+    // back while updates are deferred.
+    ALsourcecmd       SourceCmds[SOURCE_CMD_QUEUE_SIZE];
+    volatile ALuint   SourceCmdWrite;
+    volatile ALuint   SourceCmdRead;
+    ALuint            SourceCmdQueued;
+
     // Apportable Extension
     ALsizei           PrioritySlots;
 
@@ -471,6 +561,11 @@ ALvoid *StartThread(ALuint (*func)(ALvoid*), ALvoid *ptr);
 ALuint StopThread(ALvoid *thread);
 
 ALCcontext *GetContextSuspended(void);
+ALCcontext *GetContextLocked(void);
+ALCvoid UnlockContext(ALCcontext *context);
+
+#define LockDevice(d)   EnterCriticalSection(&(d)->Mutex)
+#define UnlockDevice(d) LeaveCriticalSection(&(d)->Mutex)
 
 typedef struct RingBuffer RingBuffer;
 RingBuffer *CreateRingBuffer(ALsizei frame_size, ALsizei length);
@@ -489,6 +584,9 @@ int GetConfigValueBool(const char *blockName, const char *keyName, int def);
 
 void SetRTPriority(void);
 
+void *al_calloc(size_t alignment, size_t size);
+void al_free(void *ptr);
+
 void SetDefaultChannelOrder(ALCdevice *device);
 void SetDefaultWFXChannelOrder(ALCdevice *device);
 
@@ -4,6 +4,7 @@
 #define MAX_SENDS                 4
 
 #include "alFilter.h"
+#include "alBuffer.h"
 #include "alu.h"
 #include "AL/al.h"
 
@@ -52,21 +53,68 @@ typedef struct ALsource
     ALboolean    bLooping;
     ALenum       DistanceModel;
 
+    // Hold still while a buffer about to be played is loading, rather than
+    // play silence in its place
+    ALboolean    WaitForBuffers;
+
+    // Set as a play is applied. The mixer holds the source where it is until
+    // its parameters have been worked out since, so it never starts out on
+    // ones left from before
+    ALboolean    Starting;
+
     // Apportably Extension
     ALuint    priority;
 
     resampler_t  Resampler;
 
+    // Only written with the device held: by the mixer, and as queued state
+    // changes are applied
     ALenum       state;
+    // What the app last asked for. It sees this instead of state while
+    // PendingCmds of its requests are still on their way to the mixer.
+    ALenum       AppState;
+    volatile ALuint PendingCmds;
+
     ALuint       position;
     ALuint       position_fraction;
 
+    // Too quiet to hear, or culled by the scheduler; only the position is
+    // being advanced
+    ALboolean    Virtual;
+
+    // Voice scheduling, set by the mixer each update
+    ALboolean    Culled;
+    ALfp         Audibility;
+    ALint        MixCost;
+
     struct ALbuffer *Buffer;
 
     ALbufferlistitem *queue; // Linked list of buffers in queue
     ALuint BuffersInQueue;   // Number of buffers in queue
     ALuint BuffersPlayed;    // Number of buffers played on this loop
 
+    // How far ahead the mixer has had a mapped buffer read in, in frames
+    ALuint PrefetchBuffer;
+    ALuint PrefetchEnd;
+
+    // The IMA4 block the mixer decoded last, which the next update usually
+    // starts in again
+    struct {
+        ALuint DataId;
+        ALuint Block;
+        ALshort Samples[IMA4_BLOCK_FRAMES*2];
+    } IMA4Cache;
+
+    // Frames pulled from a callback buffer that the mixer isn't done with,
+    // CallbackCount of them from frame CallbackBase on. CallbackEnd is where
+    // the stream stopped, once CallbackEnded. CallbackData holds
+    // STACK_DATA_SIZE bytes.
+    ALubyte  *CallbackData;
+    ALint64   CallbackBase;
+    ALuint    CallbackCount;
+    ALboolean CallbackEnded;
+    ALint64   CallbackEnd;
+
     ALfilter DirectFilter;
 
     struct {
@@ -89,8 +137,11 @@ typedef struct ALsource
     // Source Type (Static, Streaming, or Undetermined)
     ALint  lSourceType;
 
-    // Current target parameters used for mixing
+    // Current target parameters used for mixing, and the context generations
+    // they were calculated at
     ALboolean NeedsUpdate;
+    ALuint UpdateGen;
+    ALuint ListenerGen;
     struct {
         ALint Step;
 
@@ -99,12 +150,12 @@ typedef struct ALsource
          * channel target (eg. FRONT_LEFT) */
         ALfp DryGains[MAXCHANNELS][MAXCHANNELS];
         FILTER iirFilter;
-        ALfp history[MAXCHANNELS*2];
+        ALsample history[MAXCHANNELS*2];
 
         struct {
             ALfp WetGain;
             FILTER iirFilter;
-            ALfp history[MAXCHANNELS];
+            ALsample history[MAXCHANNELS];
         } Send[MAX_SENDS];
     } Params;
 
@@ -115,6 +166,8 @@ typedef struct ALsource
 } ALsource;
 #define ALsource_Update(s,a)  ((s)->Update(s,a))
 
+ALvoid PublishSourceCommands(ALCcontext *Context);
+ALvoid ProcessSourceCommands(ALCcontext *Context);
 ALvoid ReleaseALSources(ALCcontext *Context);
 
 #ifdef __cplusplus
@@ -13,8 +13,8 @@ extern "C" {
 void alThunkInit(void);
 void alThunkExit(void);
 ALuint alThunkAddEntry(ALvoid *ptr);
-void alThunkRemoveEntry(ALuint index);
-ALvoid *alThunkLookupEntry(ALuint index);
+void alThunkRemoveEntry(ALuint name);
+ALvoid *alThunkLookupEntry(ALuint name);
 
 #if (SIZEOF_VOIDP > SIZEOF_UINT)
 
@@ -18,6 +18,19 @@
 #define M_PI_2         1.57079632679489661923  /* pi/2 */
 #endif
 
+#ifdef OPENAL_FIXED_POINT
+/* Done natively (see Alc/fpmath.c), rather than converting to and from float
+ * around a soft-float libm call */
+#define aluPow(x,y) aluFpPow((x),(y))
+#define aluSqrt(x)  aluFpSqrt((x))
+#define aluAcos(x)  aluFpAcos((x))
+#define aluAtan(x)  aluFpAtan((x))
+#define aluExp(x)   aluFpExp((x))
+#define aluLog10(x) aluFpLog10((x))
+#define aluCos(x)   aluFpCos((x))
+#define aluSin(x)   aluFpSin((x))
+#define aluFabs(x)  (((x) < 0) ? -(x) : (x))
+#else
 #ifdef HAVE_POWF
 #define aluPow(x,y) (float2ALfp(powf(ALfp2float(x), ALfp2float(y))))
 #else
@@ -48,6 +61,12 @@
 #define aluFabs(x) (float2ALfp((float)fabs((double)ALfp2float(x))))
 #endif
 
+#define aluExp(x)   (float2ALfp((float)exp((double)ALfp2float(x))))
+#define aluLog10(x) __log10(x)
+#define aluCos(x)   __cos(x)
+#define aluSin(x)   __sin(x)
+#endif
+
 // FIXME make this better
 #if defined(max) && !defined(__max)
 #define __max(x,y) float2ALfp(max(ALfp2float(x),ALfp2float(y)))
@@ -56,6 +75,19 @@
 #define __min(x,y) float2ALfp(min(ALfp2float(x),ALfp2float(y)))
 #endif
 
+/* Sample type for the mixing path: resampled source data, filter history,
+ * the dry/wet mixing buffers and click removal. Fixed-point builds keep these
+ * in 32 bits, in the same 16.16 format as ALfp, so the inner loops only need
+ * a 32x32->64-bit multiply. ALfp stays 64-bit for the parameter math, which
+ * needs the extra range (eg. int2ALfp(Frequency)). */
+#ifdef OPENAL_FIXED_POINT
+typedef int32_t ALsample;
+#define ALsampleMult(x,y) ((ALsample)(((int64_t)(ALsample)(x)*(ALsample)(y))>>OPENAL_FIXED_POINT_SHIFT))
+#else
+typedef ALfp ALsample;
+#define ALsampleMult(x,y) ALfpMult((x),(y))
+#endif
+
 #define QUADRANT_NUM  128
 #define LUT_NUM       (4 * QUADRANT_NUM)
 
@@ -63,6 +95,17 @@
 extern "C" {
 #endif
 
+#ifdef OPENAL_FIXED_POINT
+ALfp aluFpSqrt(ALfp x);
+ALfp aluFpPow(ALfp x, ALfp y);
+ALfp aluFpExp(ALfp x);
+ALfp aluFpLog10(ALfp x);
+ALfp aluFpAcos(ALfp x);
+ALfp aluFpAtan(ALfp x);
+ALfp aluFpSin(ALfp x);
+ALfp aluFpCos(ALfp x);
+#endif
+
 typedef enum {
     FRONT_LEFT = 0,
     FRONT_RIGHT,
@@ -86,6 +129,19 @@ typedef enum {
 #define FRACTIONONE  (1<<FRACTIONBITS)
 #define FRACTIONMASK (FRACTIONONE-1)
 
+/* Sources with every output gain below this are not mixed, only advanced.
+ * It is under one LSB of 16-bit output for a full-scale input. */
+#define VIRTUAL_GAIN_THRESHOLD float2ALfp(1.0/32768.0)
+
+/* Scheduler cost of a mono, linearly resampled 16-bit source with no sends;
+ * the MAX_SOURCES_* limits are counted in these */
+#define VOICE_BASE_COST 5
+
+/* Most threads that mix sources at once, the device's own thread included */
+#ifndef MAX_MIX_THREADS
+#define MAX_MIX_THREADS 4
+#endif
+
 /* Size for temporary stack storage of buffer data. Larger values need more
  * stack, while smaller values may need more iterations. The value needs to be
  * a sensible size, however, as it constrains the max stepping value used for
@@ -119,6 +175,73 @@ static __inline ALdfp cubic(ALdfp val0, ALdfp val1, ALdfp val2, ALdfp val3, ALdf
 	return retval;
 }
 
+/* Conversions from mixed samples to the device's sample types. Anything past
+ * full scale is clipped. */
+static __inline ALfloat aluF2F(ALsample val)
+{
+    return ALfp2float(val);
+}
+static __inline ALushort aluF2US(ALsample val)
+{
+    if(val > int2ALfp(1)) return 65535;
+    if(val < -int2ALfp(1)) return 0;
+    return (ALushort)(ALfp2int(ALsampleMult(val,int2ALfp(32767))) + 32768);
+}
+static __inline ALshort aluF2S(ALsample val)
+{
+    if(val > int2ALfp(1)) return 32767;
+    if(val < -int2ALfp(1)) return -32768;
+    return (ALshort)(ALfp2int(ALsampleMult(val,int2ALfp(32767))));
+}
+static __inline ALubyte aluF2UB(ALsample val)
+{
+    ALushort i = aluF2US(val);
+    return i>>8;
+}
+static __inline ALbyte aluF2B(ALsample val)
+{
+    ALshort i = aluF2S(val);
+    return i>>8;
+}
+
+static __inline ALvoid aluCrossproduct(const ALfp *inVector1, const ALfp *inVector2, ALfp *outVector)
+{
+    outVector[0] = (ALfpMult(inVector1[1],inVector2[2]) - ALfpMult(inVector1[2],inVector2[1]));
+    outVector[1] = (ALfpMult(inVector1[2],inVector2[0]) - ALfpMult(inVector1[0],inVector2[2]));
+    outVector[2] = (ALfpMult(inVector1[0],inVector2[1]) - ALfpMult(inVector1[1],inVector2[0]));
+}
+
+static __inline ALfp aluDotproduct(const ALfp *inVector1, const ALfp *inVector2)
+{
+	return (ALfpMult(inVector1[0],inVector2[0]) + ALfpMult(inVector1[1],inVector2[1]) +
+            ALfpMult(inVector1[2],inVector2[2]));
+}
+
+static __inline ALvoid aluNormalize(ALfp *inVector)
+{
+    ALfp length, inverse_length;
+
+    length = aluSqrt(aluDotproduct(inVector, inVector));
+    if(length != int2ALfp(0))
+    {
+        inverse_length = ALfpDiv(int2ALfp(1),length);
+        inVector[0] = ALfpMult(inVector[0], inverse_length);
+        inVector[1] = ALfpMult(inVector[1], inverse_length);
+        inVector[2] = ALfpMult(inVector[2], inverse_length);
+    }
+}
+
+static __inline ALvoid aluMatrixVector(ALfp *vector,ALfp w,ALfp matrix[4][4])
+{
+    ALfp temp[4] = {
+        vector[0], vector[1], vector[2], w
+    };
+
+    vector[0] = ALfpMult(temp[0],matrix[0][0]) + ALfpMult(temp[1],matrix[1][0]) + ALfpMult(temp[2],matrix[2][0]) + ALfpMult(temp[3],matrix[3][0]);
+    vector[1] = ALfpMult(temp[0],matrix[0][1]) + ALfpMult(temp[1],matrix[1][1]) + ALfpMult(temp[2],matrix[2][1]) + ALfpMult(temp[3],matrix[3][1]);
+    vector[2] = ALfpMult(temp[0],matrix[0][2]) + ALfpMult(temp[1],matrix[1][2]) + ALfpMult(temp[2],matrix[2][2]) + ALfpMult(temp[3],matrix[3][2]);
+}
+
 struct ALsource;
 
 ALvoid aluInitPanning(ALCdevice *Device);
@@ -127,7 +250,13 @@ ALint aluCart2LUTpos(ALfp re, ALfp im);
 ALvoid CalcSourceParams(struct ALsource *ALSource, const ALCcontext *ALContext);
 ALvoid CalcNonAttnSourceParams(struct ALsource *ALSource, const ALCcontext *ALContext);
 
-ALvoid MixSource(struct ALsource *Source, ALCdevice *Device, ALuint SamplesToDo);
+ALvoid aluInitMixer(ALCdevice *Device);
+ALvoid aluNarrowDoubles(ALfp *dst, const ALdfp *src, ALuint len);
+ALvoid MixSource(struct ALsource *Source, ALCdevice *Device, ALuint Worker, ALuint SamplesToDo);
+
+ALvoid aluStartMixThreads(ALCdevice *Device);
+ALvoid aluStopMixThreads(ALCdevice *Device);
+ALvoid aluMixSources(ALCdevice *Device, ALCcontext *Context, ALuint SamplesToDo);
 
 ALvoid aluMixData(ALCdevice *device, ALvoid *buffer, ALsizei size);
 ALvoid aluHandleDisconnect(ALCdevice *device);
@@ -42,7 +42,7 @@ AL_API ALvoid AL_APIENTRY alGenAuxiliaryEffectSlots(ALsizei n, ALuint *effectslo
     ALCcontext *Context;
     ALCdevice *Device;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     Device = Context->Device;
@@ -59,8 +59,19 @@ AL_API ALvoid AL_APIENTRY alGenAuxiliaryEffectSlots(ALsizei n, ALuint *effectslo
         while(i < n)
         {
             ALeffectslot *slot = calloc(1, sizeof(ALeffectslot));
+            if(slot && Device->NumMixThreads > 1)
+            {
+                slot->WorkerWet = al_calloc(MIX_ALIGN, (Device->NumMixThreads-1) *
+                                                       sizeof(ALwetaccum));
+                if(!slot->WorkerWet)
+                {
+                    free(slot);
+                    slot = NULL;
+                }
+            }
             if(!slot || !(slot->EffectState=NoneCreate()))
             {
+                if(slot) al_free(slot->WorkerWet);
                 free(slot);
                 // We must have run out or memory
                 alSetError(Context, AL_OUT_OF_MEMORY);
@@ -75,6 +86,7 @@ AL_API ALvoid AL_APIENTRY alGenAuxiliaryEffectSlots(ALsizei n, ALuint *effectslo
             {
                 ALTHUNK_REMOVEENTRY(slot->effectslot);
                 ALEffect_Destroy(slot->EffectState);
+                al_free(slot->WorkerWet);
                 free(slot);
 
                 alSetError(Context, err);
@@ -97,7 +109,7 @@ AL_API ALvoid AL_APIENTRY alGenAuxiliaryEffectSlots(ALsizei n, ALuint *effectslo
         }
     }
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 AL_API ALvoid AL_APIENTRY alDeleteAuxiliaryEffectSlots(ALsizei n, ALuint *effectslots)
@@ -107,7 +119,7 @@ AL_API ALvoid AL_APIENTRY alDeleteAuxiliaryEffectSlots(ALsizei n, ALuint *effect
     ALboolean SlotsValid = AL_FALSE;
     ALsizei i;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     if(n < 0)
@@ -147,12 +159,13 @@ AL_API ALvoid AL_APIENTRY alDeleteAuxiliaryEffectSlots(ALsizei n, ALuint *effect
             RemoveUIntMapKey(&Context->EffectSlotMap, EffectSlot->effectslot);
             ALTHUNK_REMOVEENTRY(EffectSlot->effectslot);
 
+            al_free(EffectSlot->WorkerWet);
             memset(EffectSlot, 0, sizeof(ALeffectslot));
             free(EffectSlot);
         }
     }
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 AL_API ALboolean AL_APIENTRY alIsAuxiliaryEffectSlot(ALuint effectslot)
@@ -160,13 +173,13 @@ AL_API ALboolean AL_APIENTRY alIsAuxiliaryEffectSlot(ALuint effectslot)
     ALCcontext *Context;
     ALboolean  result;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return AL_FALSE;
 
     result = (LookupEffectSlot(Context->EffectSlotMap, effectslot) ?
               AL_TRUE : AL_FALSE);
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 
     return result;
 }
@@ -178,7 +191,7 @@ AL_API ALvoid AL_APIENTRY alAuxiliaryEffectSloti(ALuint effectslot, ALenum param
     ALboolean updateSources = AL_FALSE;
     ALeffectslot *EffectSlot;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     Device = Context->Device;
@@ -237,14 +250,14 @@ AL_API ALvoid AL_APIENTRY alAuxiliaryEffectSloti(ALuint effectslot, ALenum param
         }
     }
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 AL_API ALvoid AL_APIENTRY alAuxiliaryEffectSlotiv(ALuint effectslot, ALenum param, ALint *piValues)
 {
     ALCcontext *Context;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     if(LookupEffectSlot(Context->EffectSlotMap, effectslot) != NULL)
@@ -264,7 +277,7 @@ AL_API ALvoid AL_APIENTRY alAuxiliaryEffectSlotiv(ALuint effectslot, ALenum para
     else
         alSetError(Context, AL_INVALID_NAME);
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 AL_API ALvoid AL_APIENTRY alAuxiliaryEffectSlotf(ALuint effectslot, ALenum param, ALfloat flArg)
@@ -273,7 +286,7 @@ AL_API ALvoid AL_APIENTRY alAuxiliaryEffectSlotf(ALuint effectslot, ALenum param
     ALeffectslot *EffectSlot;
 	ALfp flValue = float2ALfp(flArg);
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     if((EffectSlot=LookupEffectSlot(Context->EffectSlotMap, effectslot)) != NULL)
@@ -295,14 +308,14 @@ AL_API ALvoid AL_APIENTRY alAuxiliaryEffectSlotf(ALuint effectslot, ALenum param
     else
         alSetError(Context, AL_INVALID_NAME);
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 AL_API ALvoid AL_APIENTRY alAuxiliaryEffectSlotfv(ALuint effectslot, ALenum param, ALfloat *pflValues)
 {
     ALCcontext *Context;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     if(LookupEffectSlot(Context->EffectSlotMap, effectslot) != NULL)
@@ -321,7 +334,7 @@ AL_API ALvoid AL_APIENTRY alAuxiliaryEffectSlotfv(ALuint effectslot, ALenum para
     else
         alSetError(Context, AL_INVALID_NAME);
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 AL_API ALvoid AL_APIENTRY alGetAuxiliaryEffectSloti(ALuint effectslot, ALenum param, ALint *piValue)
@@ -329,7 +342,7 @@ AL_API ALvoid AL_APIENTRY alGetAuxiliaryEffectSloti(ALuint effectslot, ALenum pa
     ALCcontext *Context;
     ALeffectslot *EffectSlot;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     if((EffectSlot=LookupEffectSlot(Context->EffectSlotMap, effectslot)) != NULL)
@@ -352,14 +365,14 @@ AL_API ALvoid AL_APIENTRY alGetAuxiliaryEffectSloti(ALuint effectslot, ALenum pa
     else
         alSetError(Context, AL_INVALID_NAME);
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 AL_API ALvoid AL_APIENTRY alGetAuxiliaryEffectSlotiv(ALuint effectslot, ALenum param, ALint *piValues)
 {
     ALCcontext *Context;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     if(LookupEffectSlot(Context->EffectSlotMap, effectslot) != NULL)
@@ -379,7 +392,7 @@ AL_API ALvoid AL_APIENTRY alGetAuxiliaryEffectSlotiv(ALuint effectslot, ALenum p
     else
         alSetError(Context, AL_INVALID_NAME);
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 AL_API ALvoid AL_APIENTRY alGetAuxiliaryEffectSlotf(ALuint effectslot, ALenum param, ALfloat *pflValue)
@@ -387,7 +400,7 @@ AL_API ALvoid AL_APIENTRY alGetAuxiliaryEffectSlotf(ALuint effectslot, ALenum pa
     ALCcontext *Context;
     ALeffectslot *EffectSlot;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     if((EffectSlot=LookupEffectSlot(Context->EffectSlotMap, effectslot)) != NULL)
@@ -406,14 +419,14 @@ AL_API ALvoid AL_APIENTRY alGetAuxiliaryEffectSlotf(ALuint effectslot, ALenum pa
     else
         alSetError(Context, AL_INVALID_NAME);
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 AL_API ALvoid AL_APIENTRY alGetAuxiliaryEffectSlotfv(ALuint effectslot, ALenum param, ALfloat *pflValues)
 {
     ALCcontext *Context;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     if(LookupEffectSlot(Context->EffectSlotMap, effectslot) != NULL)
@@ -432,7 +445,7 @@ AL_API ALvoid AL_APIENTRY alGetAuxiliaryEffectSlotfv(ALuint effectslot, ALenum p
     else
         alSetError(Context, AL_INVALID_NAME);
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 
@@ -450,7 +463,7 @@ static ALvoid NoneUpdate(ALeffectState *State, ALCcontext *Context, const ALeffe
     (void)Context;
     (void)Effect;
 }
-static ALvoid NoneProcess(ALeffectState *State, const ALeffectslot *Slot, ALuint SamplesToDo, const ALfp *SamplesIn, ALfp (*SamplesOut)[MAXCHANNELS])
+static ALvoid NoneProcess(ALeffectState *State, const ALeffectslot *Slot, ALuint SamplesToDo, const ALsample *SamplesIn, ALsample (*SamplesOut)[BUFFERSIZE])
 {
     (void)State;
     (void)Slot;
@@ -522,6 +535,7 @@ ALvoid ReleaseALAuxiliaryEffectSlots(ALCcontext *Context)
         ALEffect_Destroy(temp->EffectState);
 
         ALTHUNK_REMOVEENTRY(temp->effectslot);
+        al_free(temp->WorkerWet);
         memset(temp, 0, sizeof(ALeffectslot));
         free(temp);
     }
@@ -24,6 +24,12 @@
 #include <stdio.h>
 #include <assert.h>
 #include <limits.h>
+#ifdef HAVE_MMAP
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 #include "alMain.h"
 #include "AL/al.h"
@@ -32,9 +38,16 @@
 #include "alBuffer.h"
 #include "alDatabuffer.h"
 #include "alThunk.h"
+#include "alu.h"
 
 
-static ALenum LoadData(ALbuffer *ALBuf, ALuint freq, ALenum NewFormat, ALsizei size, enum UserFmtChannels chans, enum UserFmtType type, const ALvoid *data);
+static ALvoid BufferData(ALuint buffer, ALenum format, const ALvoid *data, ALsizei size, ALsizei freq, ALboolean Async);
+static ALenum LoadData(ALbuffer *ALBuf, ALuint freq, ALuint devFreq, ALenum NewFormat, ALsizei size, enum UserFmtChannels chans, enum UserFmtType type, const ALvoid *data, ALboolean Async);
+static ALenum MapData(ALbuffer *ALBuf, ALuint freq, ALenum format, ALint fd, ALsizei offset, ALsizei length);
+static ALvoid FreeBufferData(ALbuffer *ALBuf);
+static ALuint NewDataId(void);
+static ALboolean QueueConversion(ALbuffer *ALBuf, ALvoid *dst, enum FmtType dstType, const ALvoid *src, enum UserFmtType srcType, ALint chans, ALsizei len, ALuint srcFreq, ALuint dstFreq);
+static ALvoid FinishLoading(ALbuffer *ALBuf, ALboolean Discard);
 static void ConvertData(ALvoid *dst, enum FmtType dstType, const ALvoid *src, enum UserFmtType srcType, ALsizei len);
 static void ConvertDataIMA4(ALvoid *dst, enum FmtType dstType, const ALvoid *src, ALint chans, ALsizei len);
 
@@ -141,7 +154,7 @@ AL_API ALvoid AL_APIENTRY alGenBuffers(ALsizei n, ALuint *buffers)
     ALCcontext *Context;
     ALsizei i=0;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     /* Check that we are actually generating some Buffers */
@@ -179,7 +192,7 @@ AL_API ALvoid AL_APIENTRY alGenBuffers(ALsizei n, ALuint *buffers)
         }
     }
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 /*
@@ -195,7 +208,7 @@ AL_API ALvoid AL_APIENTRY alDeleteBuffers(ALsizei n, const ALuint *buffers)
     ALbuffer *ALBuf;
     ALsizei i;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     Failed = AL_TRUE;
@@ -240,7 +253,7 @@ AL_API ALvoid AL_APIENTRY alDeleteBuffers(ALsizei n, const ALuint *buffers)
                 continue;
 
             /* Release the memory used to store audio data */
-            free(ALBuf->data);
+            FreeBufferData(ALBuf);
 
             /* Release buffer structure */
             RemoveUIntMapKey(&device->BufferMap, ALBuf->buffer);
@@ -251,7 +264,7 @@ AL_API ALvoid AL_APIENTRY alDeleteBuffers(ALsizei n, const ALuint *buffers)
         }
     }
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 /*
@@ -264,13 +277,13 @@ AL_API ALboolean AL_APIENTRY alIsBuffer(ALuint buffer)
     ALCcontext *Context;
     ALboolean  result;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return AL_FALSE;
 
     result = ((!buffer || LookupBuffer(Context->Device->BufferMap, buffer)) ?
               AL_TRUE : AL_FALSE);
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 
     return result;
 }
@@ -282,6 +295,26 @@ AL_API ALboolean AL_APIENTRY alIsBuffer(ALuint buffer)
  *    Fill buffer with audio data
  */
 AL_API ALvoid AL_APIENTRY alBufferData(ALuint buffer,ALenum format,const ALvoid *data,ALsizei size,ALsizei freq)
+{
+    BufferData(buffer, format, data, size, freq, AL_FALSE);
+}
+
+/*
+ *    alBufferDataAsyncSOFT(ALuint buffer, ALenum format, const ALvoid *data,
+ *                          ALsizei size, ALsizei freq)
+ *
+ *    Fill buffer with audio data as alBufferData does, but return before the
+ *    data is converted; that happens on a background thread. The data must
+ *    stay valid until AL_BUFFER_READY_SOFT reads AL_TRUE. Sources can play the
+ *    buffer before then, either waiting for it or playing silence in its place
+ *    (AL_WAIT_FOR_BUFFERS_SOFT).
+ */
+AL_API ALvoid AL_APIENTRY alBufferDataAsyncSOFT(ALuint buffer,ALenum format,const ALvoid *data,ALsizei size,ALsizei freq)
+{
+    BufferData(buffer, format, data, size, freq, AL_TRUE);
+}
+
+static ALvoid BufferData(ALuint buffer, ALenum format, const ALvoid *data, ALsizei size, ALsizei freq, ALboolean Async)
 {
     enum UserFmtChannels SrcChannels;
     enum UserFmtType SrcType;
@@ -290,7 +323,7 @@ AL_API ALvoid AL_APIENTRY alBufferData(ALuint buffer,ALenum format,const ALvoid
     ALbuffer *ALBuf;
     ALenum err;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     if(Context->SampleSource)
@@ -300,12 +333,14 @@ AL_API ALvoid AL_APIENTRY alBufferData(ALuint buffer,ALenum format,const ALvoid
         if(Context->SampleSource->state == MAPPED)
         {
             alSetError(Context, AL_INVALID_OPERATION);
-            ProcessContext(Context);
+            UnlockContext(Context);
             return;
         }
 
         offset = (const ALubyte*)data - (ALubyte*)NULL;
         data = Context->SampleSource->data + offset;
+        // The databuffer could change under the loader thread
+        Async = AL_FALSE;
     }
 
     device = Context->Device;
@@ -326,7 +361,7 @@ AL_API ALvoid AL_APIENTRY alBufferData(ALuint buffer,ALenum format,const ALvoid
         case UserFmtInt:
         case UserFmtUInt:
         case UserFmtFloat:
-            err = LoadData(ALBuf, freq, format, size, SrcChannels, SrcType, data);
+            err = LoadData(ALBuf, freq, device->Frequency, format, size, SrcChannels, SrcType, data, Async);
             if(err != AL_NO_ERROR)
                 alSetError(Context, err);
             break;
@@ -343,13 +378,25 @@ AL_API ALvoid AL_APIENTRY alBufferData(ALuint buffer,ALenum format,const ALvoid
                 case UserFmtX61: NewFormat = AL_FORMAT_61CHN32; break;
                 case UserFmtX71: NewFormat = AL_FORMAT_71CHN32; break;
             }
-            err = LoadData(ALBuf, freq, NewFormat, size, SrcChannels, SrcType, data);
+            err = LoadData(ALBuf, freq, device->Frequency, NewFormat, size, SrcChannels, SrcType, data, Async);
             if(err != AL_NO_ERROR)
                 alSetError(Context, err);
         }   break;
 
-        case UserFmtMulaw:
         case UserFmtIMA4: {
+            ALenum NewFormat = AL_FORMAT_MONO_IMA4;
+            switch(SrcChannels)
+            {
+                case UserFmtMono: NewFormat = AL_FORMAT_MONO_IMA4; break;
+                case UserFmtStereo: NewFormat = AL_FORMAT_STEREO_IMA4; break;
+                default: break;
+            }
+            err = LoadData(ALBuf, freq, device->Frequency, NewFormat, size, SrcChannels, SrcType, data, Async);
+            if(err != AL_NO_ERROR)
+                alSetError(Context, err);
+        }   break;
+
+        case UserFmtMulaw: {
             ALenum NewFormat = AL_FORMAT_MONO16;
             switch(SrcChannels)
             {
@@ -361,13 +408,220 @@ AL_API ALvoid AL_APIENTRY alBufferData(ALuint buffer,ALenum format,const ALvoid
                 case UserFmtX61: NewFormat = AL_FORMAT_61CHN16; break;
                 case UserFmtX71: NewFormat = AL_FORMAT_71CHN16; break;
             }
-            err = LoadData(ALBuf, freq, NewFormat, size, SrcChannels, SrcType, data);
+            err = LoadData(ALBuf, freq, device->Frequency, NewFormat, size, SrcChannels, SrcType, data, Async);
             if(err != AL_NO_ERROR)
                 alSetError(Context, err);
         }   break;
     }
 
-    ProcessContext(Context);
+    UnlockContext(Context);
+}
+
+/*
+ *    alBufferDataStatic(const ALint buffer, ALenum format, ALvoid *data,
+ *                       ALsizei size, ALsizei freq)
+ *
+ *    Fill buffer with audio data, using the application's memory in place when
+ *    it can be mixed as-is. The memory must stay valid until the buffer is
+ *    deleted or filled again, neither of which can happen while a source is
+ *    using it. Anything that needs converting is copied as by alBufferData.
+ */
+AL_API ALvoid AL_APIENTRY alBufferDataStatic(const ALint buffer, ALenum format, ALvoid *data, ALsizei size, ALsizei freq)
+{
+    enum UserFmtChannels SrcChannels;
+    enum UserFmtType SrcType;
+    enum FmtChannels DstChannels;
+    enum FmtType DstType;
+    ALCcontext *Context;
+    ALCdevice *device;
+    ALbuffer *ALBuf;
+    ALuint FrameSize;
+
+    Context = GetContextLocked();
+    if(!Context) return;
+
+    /* Data from a bound databuffer can be moved or freed behind our back, and
+     * other formats need converting first */
+    if(Context->SampleSource ||
+       DecomposeUserFormat(format, &SrcChannels, &SrcType) == AL_FALSE ||
+       (SrcType != UserFmtUByte && SrcType != UserFmtShort &&
+        SrcType != UserFmtFloat) ||
+       DecomposeFormat(format, &DstChannels, &DstType) == AL_FALSE ||
+       ((ALintptrEXT)data % BytesFromFmt(DstType)) != 0)
+    {
+        alBufferData(buffer, format, data, size, freq);
+        UnlockContext(Context);
+        return;
+    }
+
+    FrameSize = FrameSizeFromFmt(DstChannels, DstType);
+
+    device = Context->Device;
+    if((ALBuf=LookupBuffer(device->BufferMap, buffer)) == NULL)
+        alSetError(Context, AL_INVALID_NAME);
+    else if(ALBuf->refcount != 0)
+        alSetError(Context, AL_INVALID_VALUE);
+    else if(size < 0 || freq < 0 || (size%FrameSize) != 0 ||
+            (size > 0 && data == NULL))
+        alSetError(Context, AL_INVALID_VALUE);
+    else
+    {
+        FreeBufferData(ALBuf);
+        ALBuf->data = data;
+        ALBuf->size = size;
+        ALBuf->DataId = NewDataId();
+        ALBuf->StaticData = AL_TRUE;
+
+        ALBuf->Frequency = freq;
+        ALBuf->FmtChannels = DstChannels;
+        ALBuf->FmtType = DstType;
+
+        ALBuf->OriginalChannels = SrcChannels;
+        ALBuf->OriginalType     = SrcType;
+        ALBuf->OriginalSize     = size;
+        ALBuf->OriginalAlign    = FrameSize;
+        ALBuf->OriginalFrequency = freq;
+
+        ALBuf->LoopStart = 0;
+        ALBuf->LoopEnd = size / FrameSize;
+    }
+
+    UnlockContext(Context);
+}
+
+/*
+ *    alBufferMapFileSOFT(ALuint buffer, ALenum format, ALint fd,
+ *                        ALsizei offset, ALsizei length, ALsizei freq)
+ *
+ *    Fill buffer with length bytes of audio data read straight from the file
+ *    at offset, which is mapped rather than copied. A length of 0 takes the
+ *    rest of the file. The descriptor may be closed afterwards.
+ */
+AL_API ALvoid AL_APIENTRY alBufferMapFileSOFT(ALuint buffer, ALenum format, ALint fd, ALsizei offset, ALsizei length, ALsizei freq)
+{
+    ALCcontext *Context;
+    ALCdevice *device;
+    ALbuffer *ALBuf;
+    ALenum err;
+
+    Context = GetContextLocked();
+    if(!Context) return;
+
+    device = Context->Device;
+    if((ALBuf=LookupBuffer(device->BufferMap, buffer)) == NULL)
+        alSetError(Context, AL_INVALID_NAME);
+    else if(ALBuf->refcount != 0)
+        alSetError(Context, AL_INVALID_VALUE);
+    else if(fd < 0 || offset < 0 || length < 0 || freq < 0)
+        alSetError(Context, AL_INVALID_VALUE);
+    else
+    {
+        err = MapData(ALBuf, freq, format, fd, offset, length);
+        if(err != AL_NO_ERROR)
+            alSetError(Context, err);
+    }
+
+    UnlockContext(Context);
+}
+
+/*
+ *    alBufferMapPathSOFT(ALuint buffer, ALenum format, const ALchar *path,
+ *                        ALsizei offset, ALsizei length, ALsizei freq)
+ *
+ *    As alBufferMapFileSOFT, for the named file
+ */
+AL_API ALvoid AL_APIENTRY alBufferMapPathSOFT(ALuint buffer, ALenum format, const ALchar *path, ALsizei offset, ALsizei length, ALsizei freq)
+{
+    ALCcontext *Context;
+
+    Context = GetContextLocked();
+    if(!Context) return;
+
+#ifdef HAVE_MMAP
+    if(!path)
+        alSetError(Context, AL_INVALID_VALUE);
+    else
+    {
+        int fd = open(path, O_RDONLY);
+        if(fd < 0)
+            alSetError(Context, AL_INVALID_VALUE);
+        else
+        {
+            alBufferMapFileSOFT(buffer, format, fd, offset, length, freq);
+            close(fd);
+        }
+    }
+#else
+    (void)buffer;
+    (void)format;
+    (void)path;
+    (void)offset;
+    (void)length;
+    (void)freq;
+    alSetError(Context, AL_INVALID_OPERATION);
+#endif
+
+    UnlockContext(Context);
+}
+
+/*
+ *    alBufferCallbackSOFT(ALuint buffer, ALenum format, ALsizei freq,
+ *                         ALBUFFERCALLBACKTYPESOFT callback, ALvoid *userptr)
+ *
+ *    Make buffer hold no data of its own, and have a source playing it ask
+ *    callback for samples as the mixer needs them. The callback is run from
+ *    the mixer's threads, so it must be quick and must not call back into the
+ *    library. Returning less than was asked for ends the stream.
+ */
+AL_API ALvoid AL_APIENTRY alBufferCallbackSOFT(ALuint buffer, ALenum format, ALsizei freq, ALBUFFERCALLBACKTYPESOFT callback, ALvoid *userptr)
+{
+    enum UserFmtChannels SrcChannels;
+    enum UserFmtType SrcType;
+    enum FmtChannels DstChannels;
+    enum FmtType DstType;
+    ALCcontext *Context;
+    ALCdevice *device;
+    ALbuffer *ALBuf;
+
+    Context = GetContextLocked();
+    if(!Context) return;
+
+    device = Context->Device;
+    if((ALBuf=LookupBuffer(device->BufferMap, buffer)) == NULL)
+        alSetError(Context, AL_INVALID_NAME);
+    else if(ALBuf->refcount != 0)
+        alSetError(Context, AL_INVALID_VALUE);
+    else if(freq <= 0 || !callback)
+        alSetError(Context, AL_INVALID_VALUE);
+    else if(DecomposeUserFormat(format, &SrcChannels, &SrcType) == AL_FALSE ||
+            DecomposeFormat(format, &DstChannels, &DstType) == AL_FALSE ||
+            DstType == FmtIMA4)
+        alSetError(Context, AL_INVALID_ENUM);
+    else
+    {
+        FreeBufferData(ALBuf);
+        ALBuf->size = 0;
+        ALBuf->DataId = NewDataId();
+        /* Nothing to free, and LoadData has to drop the callback */
+        ALBuf->StaticData = AL_TRUE;
+        ALBuf->Callback = callback;
+        ALBuf->UserData = userptr;
+
+        ALBuf->Frequency = freq;
+        ALBuf->FmtChannels = DstChannels;
+        ALBuf->FmtType = DstType;
+
+        ALBuf->OriginalChannels = SrcChannels;
+        ALBuf->OriginalType     = SrcType;
+        ALBuf->OriginalSize     = 0;
+        ALBuf->OriginalAlign    = FrameSizeFromFmt(DstChannels, DstType);
+        ALBuf->OriginalFrequency = freq;
+
+        ALBuf->LoopStart = 0;
+        ALBuf->LoopEnd = 0;
+    }
+
+    UnlockContext(Context);
 }
 
 /*
@@ -384,7 +638,7 @@ AL_API ALvoid AL_APIENTRY alBufferSubDataSOFT(ALuint buffer,ALenum format,const
     ALCdevice  *device;
     ALbuffer   *ALBuf;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     if(Context->SampleSource)
@@ -393,7 +647,7 @@ AL_API ALvoid AL_APIENTRY alBufferSubDataSOFT(ALuint buffer,ALenum format,const
         if(Context->SampleSource->state == MAPPED)
         {
             alSetError(Context, AL_INVALID_OPERATION);
-            ProcessContext(Context);
+            UnlockContext(Context);
             return;
         }
 
@@ -404,6 +658,8 @@ AL_API ALvoid AL_APIENTRY alBufferSubDataSOFT(ALuint buffer,ALenum format,const
     device = Context->Device;
     if((ALBuf=LookupBuffer(device->BufferMap, buffer)) == NULL)
         alSetError(Context, AL_INVALID_NAME);
+    else if(ALBuf->MapBase || ALBuf->Frequency != ALBuf->OriginalFrequency)
+        alSetError(Context, AL_INVALID_OPERATION);
     else if(length < 0 || offset < 0 || (length > 0 && data == NULL))
         alSetError(Context, AL_INVALID_VALUE);
     else if(DecomposeUserFormat(format, &SrcChannels, &SrcType) == AL_FALSE ||
@@ -417,15 +673,15 @@ AL_API ALvoid AL_APIENTRY alBufferSubDataSOFT(ALuint buffer,ALenum format,const
         alSetError(Context, AL_INVALID_VALUE);
     else
     {
+        /* The rest of the data has to be in place before this goes over it */
+        FinishLoading(ALBuf, AL_FALSE);
+
         if(SrcType == UserFmtIMA4)
         {
             ALuint Channels = ChannelsFromFmt(ALBuf->FmtChannels);
-            ALuint Bytes = BytesFromFmt(ALBuf->FmtType);
 
-            /* offset -> byte offset, length -> block count */
-            offset /= 36;
-            offset *= 65;
-            offset *= Bytes;
+            /* The blocks are stored as given, so only length changes, to a
+             * block count */
             length /= ALBuf->OriginalAlign;
 
             ConvertDataIMA4(&((ALubyte*)ALBuf->data)[offset], ALBuf->FmtType,
@@ -443,9 +699,10 @@ AL_API ALvoid AL_APIENTRY alBufferSubDataSOFT(ALuint buffer,ALenum format,const
             ConvertData(&((ALubyte*)ALBuf->data)[offset], ALBuf->FmtType,
                         data, SrcType, length);
         }
+        ALBuf->DataId = NewDataId();
     }
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 
@@ -456,7 +713,7 @@ AL_API void AL_APIENTRY alBufferf(ALuint buffer, ALenum eParam, ALfloat flValue)
 
     (void)flValue;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     device = pContext->Device;
@@ -472,7 +729,7 @@ AL_API void AL_APIENTRY alBufferf(ALuint buffer, ALenum eParam, ALfloat flValue)
         }
     }
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 
@@ -485,7 +742,7 @@ AL_API void AL_APIENTRY alBuffer3f(ALuint buffer, ALenum eParam, ALfloat flValue
     (void)flValue2;
     (void)flValue3;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     device = pContext->Device;
@@ -501,7 +758,7 @@ AL_API void AL_APIENTRY alBuffer3f(ALuint buffer, ALenum eParam, ALfloat flValue
         }
     }
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 
@@ -510,7 +767,7 @@ AL_API void AL_APIENTRY alBufferfv(ALuint buffer, ALenum eParam, const ALfloat*
     ALCcontext    *pContext;
     ALCdevice     *device;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     device = pContext->Device;
@@ -528,7 +785,7 @@ AL_API void AL_APIENTRY alBufferfv(ALuint buffer, ALenum eParam, const ALfloat*
         }
     }
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 
@@ -536,26 +793,34 @@ AL_API void AL_APIENTRY alBufferi(ALuint buffer, ALenum eParam, ALint lValue)
 {
     ALCcontext    *pContext;
     ALCdevice     *device;
+    ALbuffer      *ALBuf;
 
-    (void)lValue;
-
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     device = pContext->Device;
-    if(LookupBuffer(device->BufferMap, buffer) == NULL)
+    if((ALBuf=LookupBuffer(device->BufferMap, buffer)) == NULL)
         alSetError(pContext, AL_INVALID_NAME);
     else
     {
         switch(eParam)
         {
+        case AL_BUFFER_PRERESAMPLE_SOFT:
+            // Applies from the next alBufferData on. Large loads are better
+            // made with alBufferDataAsyncSOFT, which doesn't hold up the mixer.
+            if(lValue != AL_FALSE && lValue != AL_TRUE)
+                alSetError(pContext, AL_INVALID_VALUE);
+            else
+                ALBuf->Preresample = lValue;
+            break;
+
         default:
             alSetError(pContext, AL_INVALID_ENUM);
             break;
         }
     }
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 
@@ -568,7 +833,7 @@ AL_API void AL_APIENTRY alBuffer3i( ALuint buffer, ALenum eParam, ALint lValue1,
     (void)lValue2;
     (void)lValue3;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     device = pContext->Device;
@@ -584,7 +849,7 @@ AL_API void AL_APIENTRY alBuffer3i( ALuint buffer, ALenum eParam, ALint lValue1,
         }
     }
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 
@@ -594,7 +859,7 @@ AL_API void AL_APIENTRY alBufferiv(ALuint buffer, ALenum eParam, const ALint* pl
     ALCdevice     *device;
     ALbuffer      *ALBuf;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     device = pContext->Device;
@@ -606,6 +871,10 @@ AL_API void AL_APIENTRY alBufferiv(ALuint buffer, ALenum eParam, const ALint* pl
     {
         switch(eParam)
         {
+        case AL_BUFFER_PRERESAMPLE_SOFT:
+            alBufferi(buffer, eParam, plValues[0]);
+            break;
+
         case AL_LOOP_POINTS_SOFT:
             if(ALBuf->refcount > 0)
                 alSetError(pContext, AL_INVALID_OPERATION);
@@ -614,14 +883,14 @@ AL_API void AL_APIENTRY alBufferiv(ALuint buffer, ALenum eParam, const ALint* pl
                 alSetError(pContext, AL_INVALID_VALUE);
             else
             {
-                ALint maxlen = ALBuf->size /
-                               FrameSizeFromFmt(ALBuf->FmtChannels, ALBuf->FmtType);
+                ALint maxlen = FramesToOriginal(ALBuf, ALBuf->size /
+                               FrameSizeFromFmt(ALBuf->FmtChannels, ALBuf->FmtType));
                 if(plValues[0] > maxlen || plValues[1] > maxlen)
                     alSetError(pContext, AL_INVALID_VALUE);
                 else
                 {
-                    ALBuf->LoopStart = plValues[0];
-                    ALBuf->LoopEnd = plValues[1];
+                    ALBuf->LoopStart = FramesFromOriginal(ALBuf, plValues[0]);
+                    ALBuf->LoopEnd = FramesFromOriginal(ALBuf, plValues[1]);
                 }
             }
             break;
@@ -632,7 +901,7 @@ AL_API void AL_APIENTRY alBufferiv(ALuint buffer, ALenum eParam, const ALint* pl
         }
     }
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 
@@ -641,7 +910,7 @@ AL_API ALvoid AL_APIENTRY alGetBufferf(ALuint buffer, ALenum eParam, ALfloat *pf
     ALCcontext    *pContext;
     ALCdevice     *device;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     device = pContext->Device;
@@ -659,7 +928,7 @@ AL_API ALvoid AL_APIENTRY alGetBufferf(ALuint buffer, ALenum eParam, ALfloat *pf
         }
     }
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 
@@ -668,7 +937,7 @@ AL_API void AL_APIENTRY alGetBuffer3f(ALuint buffer, ALenum eParam, ALfloat* pfl
     ALCcontext    *pContext;
     ALCdevice     *device;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     device = pContext->Device;
@@ -686,7 +955,7 @@ AL_API void AL_APIENTRY alGetBuffer3f(ALuint buffer, ALenum eParam, ALfloat* pfl
         }
     }
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 
@@ -695,7 +964,7 @@ AL_API void AL_APIENTRY alGetBufferfv(ALuint buffer, ALenum eParam, ALfloat* pfl
     ALCcontext    *pContext;
     ALCdevice     *device;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     device = pContext->Device;
@@ -713,7 +982,7 @@ AL_API void AL_APIENTRY alGetBufferfv(ALuint buffer, ALenum eParam, ALfloat* pfl
         }
     }
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 
@@ -723,7 +992,7 @@ AL_API ALvoid AL_APIENTRY alGetBufferi(ALuint buffer, ALenum eParam, ALint *plVa
     ALbuffer      *pBuffer;
     ALCdevice     *device;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     device = pContext->Device;
@@ -736,7 +1005,7 @@ AL_API ALvoid AL_APIENTRY alGetBufferi(ALuint buffer, ALenum eParam, ALint *plVa
         switch(eParam)
         {
         case AL_FREQUENCY:
-            *plValue = pBuffer->Frequency;
+            *plValue = pBuffer->OriginalFrequency;
             break;
 
         case AL_BITS:
@@ -748,7 +1017,20 @@ AL_API ALvoid AL_APIENTRY alGetBufferi(ALuint buffer, ALenum eParam, ALint *plVa
             break;
 
         case AL_SIZE:
-            *plValue = pBuffer->size;
+            // As much as the data takes at the rate it was given at
+            if(pBuffer->Frequency != pBuffer->OriginalFrequency)
+                *plValue = pBuffer->OriginalSize / pBuffer->OriginalAlign *
+                           FrameSizeFromFmt(pBuffer->FmtChannels, pBuffer->FmtType);
+            else
+                *plValue = pBuffer->size;
+            break;
+
+        case AL_BUFFER_READY_SOFT:
+            *plValue = BufferDataReady(pBuffer);
+            break;
+
+        case AL_BUFFER_PRERESAMPLE_SOFT:
+            *plValue = pBuffer->Preresample;
             break;
 
         default:
@@ -757,7 +1039,7 @@ AL_API ALvoid AL_APIENTRY alGetBufferi(ALuint buffer, ALenum eParam, ALint *plVa
         }
     }
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 
@@ -766,7 +1048,7 @@ AL_API void AL_APIENTRY alGetBuffer3i(ALuint buffer, ALenum eParam, ALint* plVal
     ALCcontext    *pContext;
     ALCdevice     *device;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     device = pContext->Device;
@@ -784,7 +1066,7 @@ AL_API void AL_APIENTRY alGetBuffer3i(ALuint buffer, ALenum eParam, ALint* plVal
         }
     }
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 
@@ -794,7 +1076,7 @@ AL_API void AL_APIENTRY alGetBufferiv(ALuint buffer, ALenum eParam, ALint* plVal
     ALCdevice     *device;
     ALbuffer      *ALBuf;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     device = pContext->Device;
@@ -810,12 +1092,14 @@ AL_API void AL_APIENTRY alGetBufferiv(ALuint buffer, ALenum eParam, ALint* plVal
         case AL_BITS:
         case AL_CHANNELS:
         case AL_SIZE:
+        case AL_BUFFER_READY_SOFT:
+        case AL_BUFFER_PRERESAMPLE_SOFT:
             alGetBufferi(buffer, eParam, plValues);
             break;
 
         case AL_LOOP_POINTS_SOFT:
-            plValues[0] = ALBuf->LoopStart;
-            plValues[1] = ALBuf->LoopEnd;
+            plValues[0] = FramesToOriginal(ALBuf, ALBuf->LoopStart);
+            plValues[1] = FramesToOriginal(ALBuf, ALBuf->LoopEnd);
             break;
 
         default:
@@ -824,7 +1108,7 @@ AL_API void AL_APIENTRY alGetBufferiv(ALuint buffer, ALenum eParam, ALint* plVal
         }
     }
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 
@@ -855,7 +1139,7 @@ static ALmulaw EncodeMuLaw(ALshort val)
     return ~(sign | (exp<<4) | mant);
 }
 
-static void DecodeIMA4Block(ALshort *dst, const ALubyte *src, ALint numchans)
+ALvoid DecodeIMA4Block(ALshort *dst, const ALubyte *src, ALint numchans)
 {
     ALint sample[MAXCHANNELS], index[MAXCHANNELS];
     ALuint code[MAXCHANNELS];
@@ -1452,6 +1736,19 @@ static void Convert_IMA4(ALubyte *dst, const ALvoid *src, enum UserFmtType srcTy
 
 static void ConvertData(ALvoid *dst, enum FmtType dstType, const ALvoid *src, enum UserFmtType srcType, ALsizei len)
 {
+    /* The common uploads, data already in the stored type and doubles going
+     * to floats, don't need to go through the per-sample templates */
+    if((int)dstType == (int)srcType && dstType != FmtIMA4)
+    {
+        memcpy(dst, src, len*BytesFromUserFmt(srcType));
+        return;
+    }
+    if(dstType == FmtFloat && srcType == UserFmtDouble)
+    {
+        aluNarrowDoubles(dst, src, len);
+        return;
+    }
+
     switch(dstType)
     {
         (void)Convert_ALbyte;
@@ -1470,6 +1767,8 @@ static void ConvertData(ALvoid *dst, enum FmtType dstType, const ALvoid *src, en
         (void)Convert_ALdfp;
         (void)Convert_ALmulaw;
         (void)Convert_IMA4;
+        case FmtIMA4:
+            break; /* only ever stored from IMA4 data */
     }
 }
 
@@ -1492,7 +1791,261 @@ static void ConvertDataIMA4(ALvoid *dst, enum FmtType dstType, const ALvoid *src
             break;
         (void)Convert_ALdfp_IMA4;
         (void)Convert_ALmulaw_IMA4;
+        case FmtIMA4:
+            Convert_IMA4_IMA4(dst, src, chans, len);
+            break;
+    }
+}
+
+
+/* Resampling on load (AL_BUFFER_PRERESAMPLE_SOFT) uses a Kaiser-windowed sinc
+ * reaching RESAMPLE_ZEROS zero crossings to either side, tabulated at
+ * RESAMPLE_PHASES points per crossing and interpolated between them. The
+ * cutoff sits a little under the lower rate's Nyquist frequency, to leave room
+ * for the transition band. */
+#define RESAMPLE_ZEROS   32
+#define RESAMPLE_PHASES  256
+#define RESAMPLE_BETA    8.0
+#define RESAMPLE_CUTOFF  0.9f
+/* Data at more than this many times the device rate is left as it is, which
+ * bounds how wide the filter gets */
+#define RESAMPLE_MAX_DOWN 4
+#define RESAMPLE_MAX_TAPS (2*RESAMPLE_ZEROS*RESAMPLE_MAX_DOWN*2)
+/* Rates with more output phases than fit in this many taps have their weights
+ * worked out frame by frame instead */
+#define RESAMPLE_MAX_TABLE 65536
+
+static ALfloat ResampleKernel[RESAMPLE_ZEROS*RESAMPLE_PHASES + 2];
+
+static double BesselI0(double x)
+{
+    double term = 1.0, sum = 1.0;
+    ALuint k;
+
+    for(k = 1;term > sum*1e-12;k++)
+    {
+        term *= (x*x) / (4.0*k*k);
+        sum += term;
+    }
+    return sum;
+}
+
+/*
+ * InitBufferResampler
+ *
+ * Fills in the kernel table. Called once when the library loads.
+ */
+ALvoid InitBufferResampler(void)
+{
+    ALuint i;
+
+    for(i = 0;i <= RESAMPLE_ZEROS*RESAMPLE_PHASES;i++)
+    {
+        double x = (double)i / RESAMPLE_PHASES;
+        double r = x / RESAMPLE_ZEROS;
+        double sinc = ((i == 0) ? 1.0 : sin(M_PI*x) / (M_PI*x));
+
+        ResampleKernel[i] = (ALfloat)(sinc * BesselI0(RESAMPLE_BETA*sqrt(1.0-r*r)) /
+                                      BesselI0(RESAMPLE_BETA));
+    }
+    ResampleKernel[i] = 0.0f;
+}
+
+static __inline ALboolean CanResample(ALuint srcFreq, ALuint dstFreq)
+{
+    return (srcFreq > 0 && dstFreq > 0 && srcFreq != dstFreq &&
+            srcFreq <= dstFreq*RESAMPLE_MAX_DOWN);
+}
+
+/* Same rounding as FramesFromOriginal, so the whole of the data maps to the
+ * whole of the resampled data */
+static __inline ALuint64 ResampledFrames(ALuint64 frames, ALuint srcFreq, ALuint dstFreq)
+{
+    return (frames*dstFreq + srcFreq/2) / srcFreq;
+}
+
+static ALuint Gcd(ALuint a, ALuint b)
+{
+    while(b)
+    {
+        ALuint t = a%b;
+        a = b;
+        b = t;
+    }
+    return a;
+}
+
+/* Fills in the filter taps for an output frame frac (0 <= frac < 1) of the
+ * way past a source frame. Returns how many there are, and the first one's
+ * offset from that frame. */
+static ALuint CalcResampleWeights(ALfp *weight, ALint *first, ALfloat frac,
+                                  ALfloat cutoff, ALfloat width)
+{
+    ALint lo = (ALint)ceilf(frac - width);
+    ALint hi = (ALint)floorf(frac + width);
+    ALuint count = hi-lo+1;
+    ALuint k;
+
+    for(k = 0;k < count;k++)
+    {
+        ALfloat x = fabsf(frac - (ALfloat)(lo+(ALint)k)) * cutoff * RESAMPLE_PHASES;
+        ALuint idx = (ALuint)x;
+        ALfloat w = 0.0f;
+
+        if(idx < RESAMPLE_ZEROS*RESAMPLE_PHASES)
+            w = (ResampleKernel[idx] + (x-(ALfloat)idx)*(ResampleKernel[idx+1] -
+                                                         ResampleKernel[idx])) * cutoff;
+        weight[k] = float2ALfp(w);
+    }
+    *first = lo;
+    return count;
+}
+
+#define DECL_TEMPLATE(T)                                                      \
+static ALfp Filter_##T(const T *src, ALuint chans, const ALfp *weight,        \
+                       ALuint count)                                          \
+{                                                                             \
+    ALfp sum = int2ALfp(0);                                                   \
+    ALuint k;                                                                 \
+    for(k = 0;k < count;k++)                                                  \
+        sum += ALfpMult(weight[k], Conv_ALfp_##T(src[k*chans]));              \
+    return sum;                                                               \
+}
+
+DECL_TEMPLATE(ALbyte)
+DECL_TEMPLATE(ALubyte)
+DECL_TEMPLATE(ALshort)
+DECL_TEMPLATE(ALushort)
+DECL_TEMPLATE(ALint)
+DECL_TEMPLATE(ALuint)
+DECL_TEMPLATE(ALfp)
+DECL_TEMPLATE(ALdfp)
+DECL_TEMPLATE(ALmulaw)
+
+#undef DECL_TEMPLATE
+
+static ALfp FilterSamples(const ALvoid *src, enum UserFmtType srcType,
+                          ALuint chans, const ALfp *weight, ALuint count)
+{
+    switch(srcType)
+    {
+        case UserFmtByte:
+            return Filter_ALbyte(src, chans, weight, count);
+        case UserFmtUByte:
+            return Filter_ALubyte(src, chans, weight, count);
+        case UserFmtShort:
+            return Filter_ALshort(src, chans, weight, count);
+        case UserFmtUShort:
+            return Filter_ALushort(src, chans, weight, count);
+        case UserFmtInt:
+            return Filter_ALint(src, chans, weight, count);
+        case UserFmtUInt:
+            return Filter_ALuint(src, chans, weight, count);
+        case UserFmtFloat:
+            return Filter_ALfp(src, chans, weight, count);
+        case UserFmtDouble:
+            return Filter_ALdfp(src, chans, weight, count);
+        case UserFmtMulaw:
+            return Filter_ALmulaw(src, chans, weight, count);
+        case UserFmtIMA4:
+            break; /* not handled here */
     }
+    return int2ALfp(0);
+}
+
+/*
+ * ResampleData
+ *
+ * Converts len samples of chans-channel data at srcFreq into dstType data at
+ * dstFreq. Output is filtered a block at a time and then stored as by
+ * ConvertData.
+ *
+ * Output frames fall at dstFreq/gcd(srcFreq,dstFreq) distinct phases between
+ * the source frames, only a handful for the usual rates, so the weights for
+ * each phase are worked out up front and the filtering itself is plain ALfp
+ * multiply-adds. Called with the device held for alBufferData, so it has to
+ * be quick.
+ */
+static void ResampleData(ALvoid *dst, enum FmtType dstType, const ALvoid *src, enum UserFmtType srcType, ALint chans, ALsizei len, ALuint srcFreq, ALuint dstFreq)
+{
+    const ALuint SrcBytes = BytesFromUserFmt(srcType);
+    const ALuint DstFrameSize = chans * BytesFromFmt(dstType);
+    const ALint SrcFrames = len / chans;
+    const ALuint DstFrames = ResampledFrames(SrcFrames, srcFreq, dstFreq);
+    const ALuint gcd = Gcd(srcFreq, dstFreq);
+    const ALuint step = srcFreq / gcd;
+    const ALuint phases = dstFreq / gcd;
+    const ALfloat cutoff = RESAMPLE_CUTOFF * ((srcFreq > dstFreq) ?
+                                              (ALfloat)dstFreq/srcFreq : 1.0f);
+    const ALfloat width = RESAMPLE_ZEROS / cutoff;
+    const ALuint stride = (ALuint)(2.0f*width) + 2;
+    ALfp weight[RESAMPLE_MAX_TAPS];
+    ALfp *table = NULL;
+    ALint *firsts = NULL;
+    ALuint *counts = NULL;
+    ALfp block[1024];
+    ALuint base, todo, i, phase, p;
+    ALint pos, c;
+
+    if(phases*stride <= RESAMPLE_MAX_TABLE)
+        table = malloc(phases * (stride*sizeof(ALfp) + sizeof(ALint) + sizeof(ALuint)));
+    if(table)
+    {
+        firsts = (ALint*)(table + phases*stride);
+        counts = (ALuint*)(firsts + phases);
+        for(p = 0;p < phases;p++)
+            counts[p] = CalcResampleWeights(table + p*stride, &firsts[p],
+                                            (ALfloat)p / phases, cutoff, width);
+    }
+
+    /* Each output frame is phase/phases of the way past source frame pos */
+    pos = 0;
+    phase = 0;
+    for(base = 0;base < DstFrames;base += todo)
+    {
+        todo = min(DstFrames-base, sizeof(block)/sizeof(block[0])/chans);
+        for(i = 0;i < todo;i++)
+        {
+            const ALfp *w = weight;
+            ALint first, last;
+            ALuint count;
+
+            if(table)
+            {
+                w = table + phase*stride;
+                first = firsts[phase];
+                count = counts[phase];
+            }
+            else
+                count = CalcResampleWeights(weight, &first, (ALfloat)phase / phases,
+                                            cutoff, width);
+            first += pos;
+            last = first + (ALint)count;
+
+            /* Past either end is silence */
+            if(first < 0)
+            {
+                w += min(-first, (ALint)count);
+                first = 0;
+            }
+            last = min(last, SrcFrames);
+            count = ((last > first) ? last-first : 0);
+
+            for(c = 0;c < chans;c++)
+            {
+                const ALubyte *in = (const ALubyte*)src + (first*chans + c)*SrcBytes;
+                block[i*chans + c] = FilterSamples(in, srcType, chans, w, count);
+            }
+
+            phase += step;
+            pos += phase / phases;
+            phase %= phases;
+        }
+        ConvertData((ALubyte*)dst + base*DstFrameSize, dstType, block,
+                    UserFmtFloat, todo*chans);
+    }
+
+    free(table);
 }
 
 
@@ -1501,14 +2054,16 @@ static void ConvertDataIMA4(ALvoid *dst, enum FmtType dstType, const ALvoid *src
  *
  * Loads the specified data into the buffer, using the specified formats.
  * Currently, the new format must have the same channel configuration as the
- * original format.
+ * original format. The data is resampled to the device's rate first if the
+ * buffer asks for that.
  */
-static ALenum LoadData(ALbuffer *ALBuf, ALuint freq, ALenum NewFormat, ALsizei size, enum UserFmtChannels SrcChannels, enum UserFmtType SrcType, const ALvoid *data)
+static ALenum LoadData(ALbuffer *ALBuf, ALuint freq, ALuint devFreq, ALenum NewFormat, ALsizei size, enum UserFmtChannels SrcChannels, enum UserFmtType SrcType, const ALvoid *data, ALboolean Async)
 {
     ALuint NewChannels, NewBytes;
+    ALuint DstFreq = freq;
     enum FmtChannels DstChannels;
     enum FmtType DstType;
-    ALuint64 newsize;
+    ALuint64 newsize, datasize;
     ALvoid *temp;
 
     DecomposeFormat(NewFormat, &DstChannels, &DstType);
@@ -1517,6 +2072,9 @@ static ALenum LoadData(ALbuffer *ALBuf, ALuint freq, ALenum NewFormat, ALsizei s
 
     assert((int)SrcChannels == (int)DstChannels);
 
+    /* The old data is going away, whatever was still to be done with it */
+    FinishLoading(ALBuf, AL_TRUE);
+
     if(SrcType == UserFmtIMA4)
     {
         ALuint OrigChannels = ChannelsFromUserFmt(SrcChannels);
@@ -1534,12 +2092,20 @@ static ALenum LoadData(ALbuffer *ALBuf, ALuint freq, ALenum NewFormat, ALsizei s
         if(newsize > INT_MAX)
             return AL_OUT_OF_MEMORY;
 
-        temp = realloc(ALBuf->data, newsize);
-        if(!temp && newsize) return AL_OUT_OF_MEMORY;
+        /* Kept as IMA4, the data is no bigger than given */
+        datasize = ((DstType == FmtIMA4) ? (ALuint64)size : newsize);
+        temp = realloc((ALBuf->StaticData ? NULL : ALBuf->data), datasize);
+        if(!temp && datasize) return AL_OUT_OF_MEMORY;
+        if(ALBuf->StaticData)
+            FreeBufferData(ALBuf);
         ALBuf->data = temp;
         ALBuf->size = newsize;
 
-        if(data != NULL)
+        if(data != NULL &&
+           (!Async || !QueueConversion(ALBuf, ALBuf->data, DstType, data,
+                                       UserFmtIMA4, OrigChannels,
+                                       newsize/(65*NewChannels*NewBytes),
+                                       freq, freq)))
             ConvertDataIMA4(ALBuf->data, DstType, data, OrigChannels,
                             newsize/(65*NewChannels*NewBytes));
 
@@ -1556,18 +2122,32 @@ static ALenum LoadData(ALbuffer *ALBuf, ALuint freq, ALenum NewFormat, ALsizei s
         if((size%(OrigBytes*OrigChannels)) != 0)
             return AL_INVALID_VALUE;
 
-        newsize = size / OrigBytes;
-        newsize *= NewBytes;
+        if(ALBuf->Preresample && CanResample(freq, devFreq))
+            DstFreq = devFreq;
+
+        newsize = ResampledFrames(size / (OrigBytes*OrigChannels), freq, DstFreq);
+        newsize *= NewChannels * NewBytes;
         if(newsize > INT_MAX)
             return AL_OUT_OF_MEMORY;
 
-        temp = realloc(ALBuf->data, newsize);
+        temp = realloc((ALBuf->StaticData ? NULL : ALBuf->data), newsize);
         if(!temp && newsize) return AL_OUT_OF_MEMORY;
+        if(ALBuf->StaticData)
+            FreeBufferData(ALBuf);
         ALBuf->data = temp;
         ALBuf->size = newsize;
 
-        if(data != NULL)
-            ConvertData(ALBuf->data, DstType, data, SrcType, newsize/NewBytes);
+        if(data != NULL &&
+           (!Async || !QueueConversion(ALBuf, ALBuf->data, DstType, data,
+                                       SrcType, OrigChannels,
+                                       size/OrigBytes, freq, DstFreq)))
+        {
+            if(DstFreq != freq)
+                ResampleData(ALBuf->data, DstType, data, SrcType, OrigChannels,
+                             size/OrigBytes, freq, DstFreq);
+            else
+                ConvertData(ALBuf->data, DstType, data, SrcType, newsize/NewBytes);
+        }
 
         ALBuf->OriginalChannels = SrcChannels;
         ALBuf->OriginalType     = SrcType;
@@ -1575,14 +2155,381 @@ static ALenum LoadData(ALbuffer *ALBuf, ALuint freq, ALenum NewFormat, ALsizei s
         ALBuf->OriginalAlign    = OrigBytes * OrigChannels;
     }
 
-    ALBuf->Frequency = freq;
+    ALBuf->Frequency = DstFreq;
+    ALBuf->OriginalFrequency = freq;
     ALBuf->FmtChannels = DstChannels;
     ALBuf->FmtType = DstType;
 
     ALBuf->LoopStart = 0;
     ALBuf->LoopEnd = newsize / NewChannels / NewBytes;
+    ALBuf->DataId = NewDataId();
+
+    return AL_NO_ERROR;
+}
+
+#ifdef HAVE_MMAP
+/* How much of a mapped buffer to have read in ahead of the mixer */
+#define MAP_PREFETCH_SIZE (256*1024)
+
+static long PageSize;
+
+/* Asks for len bytes of mapped data, from offset on, to be read in */
+static ALvoid AdviseWillNeed(const ALbuffer *ALBuf, size_t offset, size_t len)
+{
+    ALubyte *start = (ALubyte*)ALBuf->data + offset;
+    size_t skip = (size_t)(start - (ALubyte*)ALBuf->MapBase) % PageSize;
+
+    madvise(start-skip, len+skip, MADV_WILLNEED);
+}
+#endif
+
+/*
+ * MapData
+ *
+ * Maps length bytes of the file at offset into the buffer, read-only. The
+ * format must be one the mixer reads directly, since there is nowhere to
+ * convert it to.
+ */
+static ALenum MapData(ALbuffer *ALBuf, ALuint freq, ALenum format, ALint fd, ALsizei offset, ALsizei length)
+{
+#ifdef HAVE_MMAP
+    enum UserFmtChannels SrcChannels;
+    enum UserFmtType SrcType;
+    enum FmtChannels DstChannels;
+    enum FmtType DstType;
+    ALuint FrameSize;
+    struct stat st;
+    ALvoid *base;
+    size_t skip;
+
+    if(DecomposeUserFormat(format, &SrcChannels, &SrcType) == AL_FALSE ||
+       DecomposeFormat(format, &DstChannels, &DstType) == AL_FALSE ||
+       DstType == FmtIMA4)
+        return AL_INVALID_ENUM;
+    FrameSize = FrameSizeFromFmt(DstChannels, DstType);
+
+    /* Touching mapped pages past the end of the file raises SIGBUS, so the
+     * whole range has to be in it */
+    if(fstat(fd, &st) != 0 || st.st_size < offset)
+        return AL_INVALID_VALUE;
+    if(length == 0)
+    {
+        if(st.st_size-offset > INT_MAX)
+            return AL_OUT_OF_MEMORY;
+        length = st.st_size - offset;
+    }
+    else if((off_t)length > st.st_size-offset)
+        return AL_INVALID_VALUE;
+    /* The samples have to come out aligned in memory */
+    if(length == 0 || (length%FrameSize) != 0 ||
+       (offset%BytesFromFmt(DstType)) != 0)
+        return AL_INVALID_VALUE;
+
+    if(PageSize == 0)
+        PageSize = sysconf(_SC_PAGESIZE);
+    skip = offset % PageSize;
+
+    base = mmap(NULL, length+skip, PROT_READ, MAP_SHARED, fd, offset-skip);
+    if(base == MAP_FAILED)
+        return AL_INVALID_VALUE;
+
+    FreeBufferData(ALBuf);
+    ALBuf->data = (ALubyte*)base + skip;
+    ALBuf->size = length;
+    ALBuf->DataId = NewDataId();
+    ALBuf->StaticData = AL_TRUE;
+    ALBuf->MapBase = base;
+    ALBuf->MapSize = length+skip;
+
+    ALBuf->Frequency = freq;
+    ALBuf->FmtChannels = DstChannels;
+    ALBuf->FmtType = DstType;
+
+    ALBuf->OriginalChannels = SrcChannels;
+    ALBuf->OriginalType     = SrcType;
+    ALBuf->OriginalSize     = length;
+    ALBuf->OriginalAlign    = FrameSize;
+    ALBuf->OriginalFrequency = freq;
+
+    ALBuf->LoopStart = 0;
+    ALBuf->LoopEnd = length / FrameSize;
+
+    /* Get the start coming in before anything plays it */
+    AdviseWillNeed(ALBuf, 0, min(length, MAP_PREFETCH_SIZE));
 
     return AL_NO_ERROR;
+#else
+    (void)ALBuf;
+    (void)freq;
+    (void)format;
+    (void)fd;
+    (void)offset;
+    (void)length;
+    return AL_INVALID_OPERATION;
+#endif
+}
+
+/*
+ * FreeBufferData
+ *
+ * Lets go of the buffer's sample storage, however it was come by
+ */
+static ALvoid FreeBufferData(ALbuffer *ALBuf)
+{
+    FinishLoading(ALBuf, AL_TRUE);
+
+#ifdef HAVE_MMAP
+    if(ALBuf->MapBase)
+        munmap(ALBuf->MapBase, ALBuf->MapSize);
+#endif
+    if(!ALBuf->StaticData)
+        free(ALBuf->data);
+
+    ALBuf->data = NULL;
+    ALBuf->StaticData = AL_FALSE;
+    ALBuf->MapBase = NULL;
+    ALBuf->MapSize = 0;
+    ALBuf->Callback = NULL;
+    ALBuf->UserData = NULL;
+}
+
+/*
+ * NewDataId
+ *
+ * Hands out a DataId for freshly changed buffer data. Never 0, so a zeroed
+ * cache matches nothing.
+ */
+static ALuint NewDataId(void)
+{
+    static ALuint NextDataId;
+    ALuint id;
+
+    while((id=__sync_add_and_fetch(&NextDataId, 1)) == 0)
+        ;
+    return id;
+}
+
+#ifndef _WIN32
+
+/* A conversion for the loader thread to do */
+typedef struct ALbufferjob {
+    ALbuffer *Buffer;
+
+    ALvoid *Dst;
+    enum FmtType DstType;
+    const ALvoid *Src;
+    enum UserFmtType SrcType;
+    ALint SrcChannels;
+    ALsizei Len;
+    ALuint SrcFreq;
+    ALuint DstFreq;
+
+    struct ALbufferjob *next;
+} ALbufferjob;
+
+static pthread_mutex_t LoaderLock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t  LoaderWake = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t  LoaderDone = PTHREAD_COND_INITIALIZER;
+static ALvoid   *LoaderThread;
+static ALboolean LoaderQuit;
+// Jobs not started yet, oldest first
+static ALbufferjob  *LoaderQueue;
+static ALbufferjob **LoaderQueueTail = &LoaderQueue;
+
+static ALvoid RunConversion(const ALbufferjob *job)
+{
+    if(job->SrcType == UserFmtIMA4)
+        ConvertDataIMA4(job->Dst, job->DstType, job->Src, job->SrcChannels, job->Len);
+    else if(job->SrcFreq != job->DstFreq)
+        ResampleData(job->Dst, job->DstType, job->Src, job->SrcType,
+                     job->SrcChannels, job->Len, job->SrcFreq, job->DstFreq);
+    else
+        ConvertData(job->Dst, job->DstType, job->Src, job->SrcType, job->Len);
+}
+
+static ALuint LoaderProc(ALvoid *ptr)
+{
+    ALbufferjob *job;
+    (void)ptr;
+
+    pthread_mutex_lock(&LoaderLock);
+    while(!LoaderQuit)
+    {
+        if((job=LoaderQueue) == NULL)
+        {
+            pthread_cond_wait(&LoaderWake, &LoaderLock);
+            continue;
+        }
+        if((LoaderQueue=job->next) == NULL)
+            LoaderQueueTail = &LoaderQueue;
+        pthread_mutex_unlock(&LoaderLock);
+
+        RunConversion(job);
+
+        pthread_mutex_lock(&LoaderLock);
+        /* The mixer checks the flag without the lock */
+        __sync_lock_release(&job->Buffer->Loading);
+        pthread_cond_broadcast(&LoaderDone);
+        free(job);
+    }
+    pthread_mutex_unlock(&LoaderLock);
+
+    return 0;
+}
+
+/*
+ * QueueConversion
+ *
+ * Hands the conversion of len samples from src into the buffer's new storage
+ * to the loader thread, starting it if need be, and marks the buffer as
+ * loading. The data is resampled along the way when the rates differ. Returns
+ * AL_FALSE if it can't, for the caller to do it itself.
+ */
+static ALboolean QueueConversion(ALbuffer *ALBuf, ALvoid *dst, enum FmtType dstType, const ALvoid *src, enum UserFmtType srcType, ALint chans, ALsizei len, ALuint srcFreq, ALuint dstFreq)
+{
+    ALbufferjob *job;
+
+    job = malloc(sizeof(ALbufferjob));
+    if(!job)
+        return AL_FALSE;
+    job->Buffer = ALBuf;
+    job->Dst = dst;
+    job->DstType = dstType;
+    job->Src = src;
+    job->SrcType = srcType;
+    job->SrcChannels = chans;
+    job->Len = len;
+    job->SrcFreq = srcFreq;
+    job->DstFreq = dstFreq;
+    job->next = NULL;
+
+    pthread_mutex_lock(&LoaderLock);
+    if(!LoaderThread && (LoaderThread=StartThread(LoaderProc, NULL)) == NULL)
+    {
+        pthread_mutex_unlock(&LoaderLock);
+        free(job);
+        return AL_FALSE;
+    }
+    __sync_lock_test_and_set(&ALBuf->Loading, AL_TRUE);
+    *LoaderQueueTail = job;
+    LoaderQueueTail = &job->next;
+    pthread_cond_signal(&LoaderWake);
+    pthread_mutex_unlock(&LoaderLock);
+
+    return AL_TRUE;
+}
+
+/*
+ * FinishLoading
+ *
+ * Makes sure the loader thread is done with the buffer. A conversion it hasn't
+ * started on is taken back, and either done here or, when the data is being
+ * thrown out anyway, dropped. One it's in the middle of is waited for.
+ */
+static ALvoid FinishLoading(ALbuffer *ALBuf, ALboolean Discard)
+{
+    ALbufferjob **list, *job = NULL;
+
+    if(BufferDataReady(ALBuf))
+        return;
+
+    pthread_mutex_lock(&LoaderLock);
+    for(list = &LoaderQueue;*list;list = &(*list)->next)
+    {
+        if((*list)->Buffer == ALBuf)
+        {
+            job = *list;
+            if((*list=job->next) == NULL)
+                LoaderQueueTail = list;
+            break;
+        }
+    }
+    if(!job)
+    {
+        while(ALBuf->Loading)
+            pthread_cond_wait(&LoaderDone, &LoaderLock);
+    }
+    pthread_mutex_unlock(&LoaderLock);
+
+    if(job)
+    {
+        if(!Discard)
+            RunConversion(job);
+        free(job);
+
+        __sync_lock_release(&ALBuf->Loading);
+    }
+}
+
+/*
+ *    ReleaseBufferLoader()
+ *
+ *    INTERNAL: Called to stop the loader thread, once all buffers are gone
+ */
+ALvoid ReleaseBufferLoader(void)
+{
+    if(!LoaderThread)
+        return;
+
+    pthread_mutex_lock(&LoaderLock);
+    LoaderQuit = AL_TRUE;
+    pthread_cond_signal(&LoaderWake);
+    pthread_mutex_unlock(&LoaderLock);
+
+    StopThread(LoaderThread);
+    LoaderThread = NULL;
+    LoaderQuit = AL_FALSE;
+}
+
+#else
+
+static ALboolean QueueConversion(ALbuffer *ALBuf, ALvoid *dst, enum FmtType dstType, const ALvoid *src, enum UserFmtType srcType, ALint chans, ALsizei len, ALuint srcFreq, ALuint dstFreq)
+{
+    (void)ALBuf; (void)dst; (void)dstType; (void)src;
+    (void)srcType; (void)chans; (void)len;
+    (void)srcFreq; (void)dstFreq;
+    return AL_FALSE;
+}
+
+static ALvoid FinishLoading(ALbuffer *ALBuf, ALboolean Discard)
+{
+    (void)ALBuf;
+    (void)Discard;
+}
+
+ALvoid ReleaseBufferLoader(void)
+{
+}
+
+#endif
+
+/*
+ * PrefetchBufferData
+ *
+ * Called by the mixer as it plays a mapped buffer from frame pos, with end
+ * being how far it had asked for before. Has the next stretch of the file
+ * read in once the mixer gets within half of it, or has jumped elsewhere, so
+ * it doesn't stall on page faults. Returns the new end.
+ */
+ALuint PrefetchBufferData(const ALbuffer *ALBuf, ALuint pos, ALuint end)
+{
+#ifdef HAVE_MMAP
+    ALuint FrameSize = FrameSizeFromFmt(ALBuf->FmtChannels, ALBuf->FmtType);
+    ALuint frames = ALBuf->size / FrameSize;
+    ALuint window = max(MAP_PREFETCH_SIZE / FrameSize, 1);
+
+    if(pos >= frames)
+        return end;
+    if(pos < end && end-pos <= window && (end-pos > window/2 || end >= frames))
+        return end;
+
+    end = min(pos+window, frames);
+    AdviseWillNeed(ALBuf, (size_t)pos*FrameSize, (size_t)(end-pos)*FrameSize);
+#else
+    (void)ALBuf;
+    (void)pos;
+#endif
+    return end;
 }
 
 
@@ -1763,6 +2710,7 @@ ALuint BytesFromFmt(enum FmtType type)
     case FmtUByte: return sizeof(ALubyte);
     case FmtShort: return sizeof(ALshort);
     case FmtFloat: return sizeof(ALfp);
+    case FmtIMA4: return sizeof(ALshort); /* as mixed */
     }
     return 0;
 }
@@ -1796,6 +2744,10 @@ ALboolean DecomposeFormat(ALenum format, enum FmtChannels *chans, enum FmtType *
             *chans = FmtMono;
             *type  = FmtFloat;
             return AL_TRUE;
+        case AL_FORMAT_MONO_IMA4:
+            *chans = FmtMono;
+            *type  = FmtIMA4;
+            return AL_TRUE;
         case AL_FORMAT_STEREO8:
             *chans = FmtStereo;
             *type  = FmtUByte;
@@ -1808,6 +2760,10 @@ ALboolean DecomposeFormat(ALenum format, enum FmtChannels *chans, enum FmtType *
             *chans = FmtStereo;
             *type  = FmtFloat;
             return AL_TRUE;
+        case AL_FORMAT_STEREO_IMA4:
+            *chans = FmtStereo;
+            *type  = FmtIMA4;
+            return AL_TRUE;
         case AL_FORMAT_QUAD8_LOKI:
         case AL_FORMAT_QUAD8:
             *chans = FmtQuad;
@@ -1888,7 +2844,7 @@ ALvoid ReleaseALBuffers(ALCdevice *device)
         ALbuffer *temp = device->BufferMap.array[i].value;
         device->BufferMap.array[i].value = NULL;
 
-        free(temp->data);
+        FreeBufferData(temp);
 
         ALTHUNK_REMOVEENTRY(temp->buffer);
         memset(temp, 0, sizeof(ALbuffer));
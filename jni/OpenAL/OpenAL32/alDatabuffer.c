@@ -44,7 +44,7 @@ AL_API ALvoid AL_APIENTRY alGenDatabuffersEXT(ALsizei n,ALuint *puiBuffers)
     ALCcontext *Context;
     ALsizei i=0;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     /* Check that we are actually generation some Databuffers */
@@ -85,7 +85,7 @@ AL_API ALvoid AL_APIENTRY alGenDatabuffersEXT(ALsizei n,ALuint *puiBuffers)
         }
     }
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 /*
@@ -101,7 +101,7 @@ AL_API ALvoid AL_APIENTRY alDeleteDatabuffersEXT(ALsizei n, const ALuint *buffer
     ALboolean Failed;
     ALsizei i;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     /* Check we are actually Deleting some Databuffers */
@@ -162,7 +162,7 @@ AL_API ALvoid AL_APIENTRY alDeleteDatabuffersEXT(ALsizei n, const ALuint *buffer
         }
     }
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 /*
@@ -176,14 +176,14 @@ AL_API ALboolean AL_APIENTRY alIsDatabufferEXT(ALuint buffer)
     ALboolean  result;
     ALCdevice *device;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return AL_FALSE;
 
     device = Context->Device;
     result = ((!buffer || LookupDatabuffer(device->DatabufferMap, buffer)) ?
               AL_TRUE : AL_FALSE);
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 
     return result;
 }
@@ -200,7 +200,7 @@ AL_API ALvoid AL_APIENTRY alDatabufferDataEXT(ALuint buffer,const ALvoid *data,A
     ALCdevice *Device;
     ALvoid *temp;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     Device = Context->Device;
@@ -241,7 +241,7 @@ AL_API ALvoid AL_APIENTRY alDatabufferDataEXT(ALuint buffer,const ALvoid *data,A
     else
         alSetError(Context, AL_INVALID_NAME);
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 AL_API ALvoid AL_APIENTRY alDatabufferSubDataEXT(ALuint uiBuffer, ALintptrEXT start, ALsizeiptrEXT length, const ALvoid *data)
@@ -250,7 +250,7 @@ AL_API ALvoid AL_APIENTRY alDatabufferSubDataEXT(ALuint uiBuffer, ALintptrEXT st
     ALdatabuffer  *pBuffer;
     ALCdevice     *Device;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     Device = pContext->Device;
@@ -269,7 +269,7 @@ AL_API ALvoid AL_APIENTRY alDatabufferSubDataEXT(ALuint uiBuffer, ALintptrEXT st
     else
         alSetError(pContext, AL_INVALID_NAME);
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 AL_API ALvoid AL_APIENTRY alGetDatabufferSubDataEXT(ALuint uiBuffer, ALintptrEXT start, ALsizeiptrEXT length, ALvoid *data)
@@ -278,7 +278,7 @@ AL_API ALvoid AL_APIENTRY alGetDatabufferSubDataEXT(ALuint uiBuffer, ALintptrEXT
     ALdatabuffer  *pBuffer;
     ALCdevice     *Device;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     Device = pContext->Device;
@@ -297,7 +297,7 @@ AL_API ALvoid AL_APIENTRY alGetDatabufferSubDataEXT(ALuint uiBuffer, ALintptrEXT
     else
         alSetError(pContext, AL_INVALID_NAME);
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 
@@ -308,7 +308,7 @@ AL_API ALvoid AL_APIENTRY alDatabufferfEXT(ALuint buffer, ALenum eParam, ALfloat
 
     (void)flValue;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     Device = pContext->Device;
@@ -324,7 +324,7 @@ AL_API ALvoid AL_APIENTRY alDatabufferfEXT(ALuint buffer, ALenum eParam, ALfloat
     else
         alSetError(pContext, AL_INVALID_NAME);
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 AL_API ALvoid AL_APIENTRY alDatabufferfvEXT(ALuint buffer, ALenum eParam, const ALfloat* flValues)
@@ -334,7 +334,7 @@ AL_API ALvoid AL_APIENTRY alDatabufferfvEXT(ALuint buffer, ALenum eParam, const
 
     (void)flValues;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     Device = pContext->Device;
@@ -350,7 +350,7 @@ AL_API ALvoid AL_APIENTRY alDatabufferfvEXT(ALuint buffer, ALenum eParam, const
     else
         alSetError(pContext, AL_INVALID_NAME);
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 
@@ -361,7 +361,7 @@ AL_API ALvoid AL_APIENTRY alDatabufferiEXT(ALuint buffer, ALenum eParam, ALint l
 
     (void)lValue;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     Device = pContext->Device;
@@ -377,7 +377,7 @@ AL_API ALvoid AL_APIENTRY alDatabufferiEXT(ALuint buffer, ALenum eParam, ALint l
     else
         alSetError(pContext, AL_INVALID_NAME);
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 AL_API ALvoid AL_APIENTRY alDatabufferivEXT(ALuint buffer, ALenum eParam, const ALint* plValues)
@@ -387,7 +387,7 @@ AL_API ALvoid AL_APIENTRY alDatabufferivEXT(ALuint buffer, ALenum eParam, const
 
     (void)plValues;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     Device = pContext->Device;
@@ -403,7 +403,7 @@ AL_API ALvoid AL_APIENTRY alDatabufferivEXT(ALuint buffer, ALenum eParam, const
     else
         alSetError(pContext, AL_INVALID_NAME);
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 
@@ -412,7 +412,7 @@ AL_API ALvoid AL_APIENTRY alGetDatabufferfEXT(ALuint buffer, ALenum eParam, ALfl
     ALCcontext    *pContext;
     ALCdevice     *Device;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     if(pflValue)
@@ -433,7 +433,7 @@ AL_API ALvoid AL_APIENTRY alGetDatabufferfEXT(ALuint buffer, ALenum eParam, ALfl
     else
         alSetError(pContext, AL_INVALID_VALUE);
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 AL_API ALvoid AL_APIENTRY alGetDatabufferfvEXT(ALuint buffer, ALenum eParam, ALfloat* pflValues)
@@ -441,7 +441,7 @@ AL_API ALvoid AL_APIENTRY alGetDatabufferfvEXT(ALuint buffer, ALenum eParam, ALf
     ALCcontext    *pContext;
     ALCdevice     *Device;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     if(pflValues)
@@ -462,7 +462,7 @@ AL_API ALvoid AL_APIENTRY alGetDatabufferfvEXT(ALuint buffer, ALenum eParam, ALf
     else
         alSetError(pContext, AL_INVALID_VALUE);
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 AL_API ALvoid AL_APIENTRY alGetDatabufferiEXT(ALuint buffer, ALenum eParam, ALint *plValue)
@@ -471,7 +471,7 @@ AL_API ALvoid AL_APIENTRY alGetDatabufferiEXT(ALuint buffer, ALenum eParam, ALin
     ALdatabuffer  *pBuffer;
     ALCdevice     *Device;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     if(plValue)
@@ -496,7 +496,7 @@ AL_API ALvoid AL_APIENTRY alGetDatabufferiEXT(ALuint buffer, ALenum eParam, ALin
     else
         alSetError(pContext, AL_INVALID_VALUE);
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 AL_API ALvoid AL_APIENTRY alGetDatabufferivEXT(ALuint buffer, ALenum eParam, ALint* plValues)
@@ -504,7 +504,7 @@ AL_API ALvoid AL_APIENTRY alGetDatabufferivEXT(ALuint buffer, ALenum eParam, ALi
     ALCcontext    *pContext;
     ALCdevice     *Device;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     if(plValues)
@@ -529,7 +529,7 @@ AL_API ALvoid AL_APIENTRY alGetDatabufferivEXT(ALuint buffer, ALenum eParam, ALi
     else
         alSetError(pContext, AL_INVALID_VALUE);
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 
@@ -539,7 +539,7 @@ AL_API ALvoid AL_APIENTRY alSelectDatabufferEXT(ALenum target, ALuint uiBuffer)
     ALdatabuffer  *pBuffer = NULL;
     ALCdevice     *Device;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     Device = pContext->Device;
@@ -556,7 +556,7 @@ AL_API ALvoid AL_APIENTRY alSelectDatabufferEXT(ALenum target, ALuint uiBuffer)
     else
         alSetError(pContext, AL_INVALID_NAME);
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 
@@ -567,7 +567,7 @@ AL_API ALvoid* AL_APIENTRY alMapDatabufferEXT(ALuint uiBuffer, ALintptrEXT start
     ALvoid        *ret = NULL;
     ALCdevice     *Device;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return NULL;
 
     Device = pContext->Device;
@@ -595,7 +595,7 @@ AL_API ALvoid* AL_APIENTRY alMapDatabufferEXT(ALuint uiBuffer, ALintptrEXT start
     else
         alSetError(pContext, AL_INVALID_NAME);
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 
     return ret;
 }
@@ -606,7 +606,7 @@ AL_API ALvoid AL_APIENTRY alUnmapDatabufferEXT(ALuint uiBuffer)
     ALdatabuffer  *pBuffer;
     ALCdevice     *Device;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     Device = pContext->Device;
@@ -620,7 +620,7 @@ AL_API ALvoid AL_APIENTRY alUnmapDatabufferEXT(ALuint uiBuffer)
     else
         alSetError(pContext, AL_INVALID_NAME);
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 
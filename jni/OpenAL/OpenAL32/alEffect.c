@@ -43,7 +43,7 @@ AL_API ALvoid AL_APIENTRY alGenEffects(ALsizei n, ALuint *effects)
     ALCcontext *Context;
     ALsizei i=0;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     if(n < 0 || IsBadWritePtr((void*)effects, n * sizeof(ALuint)))
@@ -81,7 +81,7 @@ AL_API ALvoid AL_APIENTRY alGenEffects(ALsizei n, ALuint *effects)
         }
     }
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 AL_API ALvoid AL_APIENTRY alDeleteEffects(ALsizei n, ALuint *effects)
@@ -92,7 +92,7 @@ AL_API ALvoid AL_APIENTRY alDeleteEffects(ALsizei n, ALuint *effects)
     ALboolean Failed;
     ALsizei i;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     Failed = AL_TRUE;
@@ -134,7 +134,7 @@ AL_API ALvoid AL_APIENTRY alDeleteEffects(ALsizei n, ALuint *effects)
         }
     }
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 AL_API ALboolean AL_APIENTRY alIsEffect(ALuint effect)
@@ -142,13 +142,13 @@ AL_API ALboolean AL_APIENTRY alIsEffect(ALuint effect)
     ALCcontext *Context;
     ALboolean  result;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return AL_FALSE;
 
     result = ((!effect || LookupEffect(Context->Device->EffectMap, effect)) ?
               AL_TRUE : AL_FALSE);
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 
     return result;
 }
@@ -159,7 +159,7 @@ AL_API ALvoid AL_APIENTRY alEffecti(ALuint effect, ALenum param, ALint iValue)
     ALCdevice  *Device;
     ALeffect   *ALEffect;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     Device = Context->Device;
@@ -249,7 +249,7 @@ AL_API ALvoid AL_APIENTRY alEffecti(ALuint effect, ALenum param, ALint iValue)
     else
         alSetError(Context, AL_INVALID_NAME);
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 AL_API ALvoid AL_APIENTRY alEffectiv(ALuint effect, ALenum param, ALint *piValues)
@@ -258,7 +258,7 @@ AL_API ALvoid AL_APIENTRY alEffectiv(ALuint effect, ALenum param, ALint *piValue
     ALCdevice  *Device;
     ALeffect   *ALEffect;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     Device = Context->Device;
@@ -324,7 +324,7 @@ AL_API ALvoid AL_APIENTRY alEffectiv(ALuint effect, ALenum param, ALint *piValue
     else
         alSetError(Context, AL_INVALID_NAME);
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 AL_API ALvoid AL_APIENTRY alEffectf(ALuint effect, ALenum param, ALfloat flArg)
@@ -334,7 +334,7 @@ AL_API ALvoid AL_APIENTRY alEffectf(ALuint effect, ALenum param, ALfloat flArg)
     ALeffect   *ALEffect;
 	ALfp     flValue = float2ALfp(flArg);
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     Device = Context->Device;
@@ -688,7 +688,7 @@ AL_API ALvoid AL_APIENTRY alEffectf(ALuint effect, ALenum param, ALfloat flArg)
     else
         alSetError(Context, AL_INVALID_NAME);
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 AL_API ALvoid AL_APIENTRY alEffectfv(ALuint effect, ALenum param, ALfloat *pflValues)
@@ -697,7 +697,7 @@ AL_API ALvoid AL_APIENTRY alEffectfv(ALuint effect, ALenum param, ALfloat *pflVa
     ALCdevice  *Device;
     ALeffect   *ALEffect;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     Device = Context->Device;
@@ -817,7 +817,7 @@ AL_API ALvoid AL_APIENTRY alEffectfv(ALuint effect, ALenum param, ALfloat *pflVa
     else
         alSetError(Context, AL_INVALID_NAME);
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 AL_API ALvoid AL_APIENTRY alGetEffecti(ALuint effect, ALenum param, ALint *piValue)
@@ -826,7 +826,7 @@ AL_API ALvoid AL_APIENTRY alGetEffecti(ALuint effect, ALenum param, ALint *piVal
     ALCdevice  *Device;
     ALeffect   *ALEffect;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     Device = Context->Device;
@@ -896,7 +896,7 @@ AL_API ALvoid AL_APIENTRY alGetEffecti(ALuint effect, ALenum param, ALint *piVal
     else
         alSetError(Context, AL_INVALID_NAME);
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 AL_API ALvoid AL_APIENTRY alGetEffectiv(ALuint effect, ALenum param, ALint *piValues)
@@ -905,7 +905,7 @@ AL_API ALvoid AL_APIENTRY alGetEffectiv(ALuint effect, ALenum param, ALint *piVa
     ALCdevice  *Device;
     ALeffect   *ALEffect;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     Device = Context->Device;
@@ -971,7 +971,7 @@ AL_API ALvoid AL_APIENTRY alGetEffectiv(ALuint effect, ALenum param, ALint *piVa
     else
         alSetError(Context, AL_INVALID_NAME);
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 AL_API ALvoid AL_APIENTRY alGetEffectf(ALuint effect, ALenum param, ALfloat *pflValue)
@@ -980,7 +980,7 @@ AL_API ALvoid AL_APIENTRY alGetEffectf(ALuint effect, ALenum param, ALfloat *pfl
     ALCdevice  *Device;
     ALeffect   *ALEffect;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     Device = Context->Device;
@@ -1183,7 +1183,7 @@ AL_API ALvoid AL_APIENTRY alGetEffectf(ALuint effect, ALenum param, ALfloat *pfl
     else
         alSetError(Context, AL_INVALID_NAME);
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 AL_API ALvoid AL_APIENTRY alGetEffectfv(ALuint effect, ALenum param, ALfloat *pflValues)
@@ -1192,7 +1192,7 @@ AL_API ALvoid AL_APIENTRY alGetEffectfv(ALuint effect, ALenum param, ALfloat *pf
     ALCdevice  *Device;
     ALeffect   *ALEffect;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     Device = Context->Device;
@@ -1302,7 +1302,7 @@ AL_API ALvoid AL_APIENTRY alGetEffectfv(ALuint effect, ALenum param, ALfloat *pf
     else
         alSetError(Context, AL_INVALID_NAME);
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 
@@ -65,14 +65,7 @@ AL_API ALvoid AL_APIENTRY alListenerf(ALenum eParam, ALfloat flArg)
     // Force updating the sources for these parameters, since even head-
     // relative sources are affected
     if(updateAll)
-    {
-        ALsizei pos;
-        for(pos = 0;pos < pContext->SourceMap.size;pos++)
-        {
-            ALsource *source = pContext->SourceMap.array[pos].value;
-            source->NeedsUpdate = AL_TRUE;
-        }
-    }
+        pContext->UpdateGen++;
 
     ProcessContext(pContext);
 }
@@ -112,15 +105,7 @@ AL_API ALvoid AL_APIENTRY alListener3f(ALenum eParam, ALfloat flArg1, ALfloat fl
     }
 
     if(updateWorld)
-    {
-        ALsizei pos;
-        for(pos = 0;pos < pContext->SourceMap.size;pos++)
-        {
-            ALsource *source = pContext->SourceMap.array[pos].value;
-            if(!source->bHeadRelative)
-                source->NeedsUpdate = AL_TRUE;
-        }
-    }
+        pContext->ListenerGen++;
 
     ProcessContext(pContext);
 }
@@ -168,15 +153,7 @@ AL_API ALvoid AL_APIENTRY alListenerfv(ALenum eParam, const ALfloat *pflValues)
         alSetError(pContext, AL_INVALID_VALUE);
 
     if(updateWorld)
-    {
-        ALsizei pos;
-        for(pos = 0;pos < pContext->SourceMap.size;pos++)
-        {
-            ALsource *source = pContext->SourceMap.array[pos].value;
-            if(!source->bHeadRelative)
-                source->NeedsUpdate = AL_TRUE;
-        }
-    }
+        pContext->ListenerGen++;
 
     ProcessContext(pContext);
 }
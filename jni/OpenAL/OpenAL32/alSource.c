@@ -32,16 +32,6 @@
 #include "alThunk.h"
 #include "alAuxEffectSlot.h"
 
-#ifdef ANDROID
-// Apportable: Defines a cap on the maximum number of playing sources
-extern int alc_max_sources;
-extern int alc_active_sources;
-#define LOG_TAG "OpenAL_alSource.c"
-#define LOGV(...) __android_log_print(ANDROID_LOG_INFO, LOG_TAG, __VA_ARGS__)
-#else
-#define LOGV(...)
-#endif
-
 resampler_t DefaultResampler;
 const ALsizei ResamplerPadding[RESAMPLER_MAX] = {
     0, /* Point */
@@ -58,6 +48,9 @@ const ALsizei ResamplerPrePadding[RESAMPLER_MAX] = {
 static ALvoid InitSourceParams(ALsource *Source);
 static ALvoid GetSourceOffset(ALsource *Source, ALenum eName, ALdfp *Offsets, ALdfp updateLen);
 static ALboolean ApplyOffset(ALsource *Source);
+static ALvoid PostSourceCommand(ALCcontext *Context, ALsource *Source,
+                                ALenum State);
+static ALvoid FlushSourceCommands(ALCcontext *Context);
 static ALint GetByteOffset(ALsource *Source);
 
 #define LookupSource(m, k) ((ALsource*)LookupUIntMapKey(&(m), (k)))
@@ -65,12 +58,82 @@ static ALint GetByteOffset(ALsource *Source);
 #define LookupFilter(m, k) ((ALfilter*)LookupUIntMapKey(&(m), (k)))
 #define LookupEffectSlot(m, k) ((ALeffectslot*)LookupUIntMapKey(&(m), (k)))
 
+/* Makes room in the active list for count sources, so playing them never
+ * has to allocate. Called with the device held. */
+static ALboolean ReserveActiveSources(ALCcontext *Context, ALsizei count)
+{
+    void *temp;
+    ALsizei newcount;
+
+    if(count <= Context->MaxActiveSources)
+        return AL_TRUE;
+
+    newcount = max(count, Context->MaxActiveSources << 1);
+    temp = realloc(Context->ActiveSources,
+                   sizeof(*Context->ActiveSources) * newcount);
+    if(!temp)
+        return AL_FALSE;
+
+    Context->ActiveSources = temp;
+    Context->MaxActiveSources = newcount;
+    return AL_TRUE;
+}
+
+/* Offsets move the position the mixer is reading from, so setting one needs
+ * the device held as well */
+static __inline ALboolean IsOffsetParam(ALenum param)
+{
+    return (param == AL_SEC_OFFSET || param == AL_SAMPLE_OFFSET ||
+            param == AL_BYTE_OFFSET);
+}
+
+/* Queries that read the mixer's position, so need the device held */
+static __inline ALboolean IsOffsetQuery(ALenum param)
+{
+    return (IsOffsetParam(param) || param == AL_SAMPLE_RW_OFFSETS_SOFT ||
+            param == AL_BYTE_RW_OFFSETS_SOFT);
+}
+
+/* The state as far as the app is concerned: what it last asked for, until
+ * the mixer has caught up with that */
+static __inline ALenum GetSourceState(ALsource *Source)
+{
+    if(__sync_fetch_and_add(&Source->PendingCmds, 0) != 0)
+        return Source->AppState;
+    return Source->state;
+}
+
+/* Whether the source has anything to play: a non-null buffer with data, or a
+ * callback buffer (which has no length) */
+static ALboolean HasPlayableBuffer(const ALsource *Source)
+{
+    const ALbufferlistitem *BufferList = Source->queue;
+    while(BufferList)
+    {
+        if(BufferList->buffer != NULL &&
+           (BufferList->buffer->size || BufferList->buffer->Callback))
+            return AL_TRUE;
+        BufferList = BufferList->next;
+    }
+    return AL_FALSE;
+}
+
+/* Forgets what the mixer pulled from a callback buffer, so the source starts
+ * over with the stream */
+static __inline ALvoid ResetCallbackData(ALsource *Source)
+{
+    Source->CallbackBase = 0;
+    Source->CallbackCount = 0;
+    Source->CallbackEnded = AL_FALSE;
+    Source->CallbackEnd = 0;
+}
+
 AL_API ALvoid AL_APIENTRY alGenSources(ALsizei n,ALuint *sources)
 {
     ALCcontext *Context;
     ALCdevice *Device;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     Device = Context->Device;
@@ -78,6 +141,8 @@ AL_API ALvoid AL_APIENTRY alGenSources(ALsizei n,ALuint *sources)
         alSetError(Context, AL_INVALID_VALUE);
     else if((ALuint)n > Device->MaxNoOfSources - Context->SourceMap.size)
         alSetError(Context, AL_INVALID_VALUE);
+    else if(!ReserveActiveSources(Context, Context->SourceMap.size + n))
+        alSetError(Context, AL_OUT_OF_MEMORY);
     else
     {
         ALenum err;
@@ -114,7 +179,7 @@ AL_API ALvoid AL_APIENTRY alGenSources(ALsizei n,ALuint *sources)
         }
     }
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 
@@ -123,10 +188,11 @@ AL_API ALvoid AL_APIENTRY alDeleteSources(ALsizei n, const ALuint *sources)
     ALCcontext *Context;
     ALsource *Source;
     ALsizei i, j;
+    ALuint pos;
     ALbufferlistitem *BufferList;
     ALboolean SourcesValid = AL_FALSE;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     if(n < 0)
@@ -165,6 +231,15 @@ AL_API ALvoid AL_APIENTRY alDeleteSources(ALsizei n, const ALuint *sources)
                 }
             }
 
+            // The mixer has applied everything handed to it. Drop what's
+            // still held back for a deferred update.
+            for(pos = Context->SourceCmdWrite;pos != Context->SourceCmdQueued;pos++)
+            {
+                ALsourcecmd *cmd = &Context->SourceCmds[pos&(SOURCE_CMD_QUEUE_SIZE-1)];
+                if(cmd->Source == Source)
+                    cmd->Source = NULL;
+            }
+
             // For each buffer in the source's queue...
             while(Source->queue != NULL)
             {
@@ -183,6 +258,8 @@ AL_API ALvoid AL_APIENTRY alDeleteSources(ALsizei n, const ALuint *sources)
                 Source->Send[j].Slot = NULL;
             }
 
+            free(Source->CallbackData);
+
             // Remove Source from list of Sources
             RemoveUIntMapKey(&Context->SourceMap, Source->source);
             ALTHUNK_REMOVEENTRY(Source->source);
@@ -192,7 +269,7 @@ AL_API ALvoid AL_APIENTRY alDeleteSources(ALsizei n, const ALuint *sources)
         }
     }
 
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 
@@ -212,234 +289,246 @@ AL_API ALboolean AL_APIENTRY alIsSource(ALuint source)
 }
 
 
-AL_API ALvoid AL_APIENTRY alSourcef(ALuint source, ALenum eParam, ALfloat flValue)
+static ALvoid SetSourcef(ALCcontext *pContext, ALsource *Source, ALenum eParam,
+                         ALfloat flValue)
 {
-    ALCcontext    *pContext;
-    ALsource    *Source;
+    switch(eParam)
+    {
+        case AL_PITCH:
+            if(flValue >= 0.0f)
+            {
+                Source->flPitch = float2ALfp(flValue);
+                Source->NeedsUpdate = AL_TRUE;
+            }
+            else
+                alSetError(pContext, AL_INVALID_VALUE);
+            break;
 
-    pContext = GetContextSuspended();
-    if(!pContext) return;
+        case AL_CONE_INNER_ANGLE:
+            if(flValue >= 0.0f && flValue <= 360.0f)
+            {
+                Source->flInnerAngle = float2ALfp(flValue);
+                Source->NeedsUpdate = AL_TRUE;
+            }
+            else
+                alSetError(pContext, AL_INVALID_VALUE);
+            break;
 
-    if((Source=LookupSource(pContext->SourceMap, source)) != NULL)
-    {
-        switch(eParam)
-        {
-            case AL_PITCH:
-                if(flValue >= 0.0f)
-                {
-                    Source->flPitch = float2ALfp(flValue);
-                    Source->NeedsUpdate = AL_TRUE;
-                }
-                else
-                    alSetError(pContext, AL_INVALID_VALUE);
-                break;
+        case AL_CONE_OUTER_ANGLE:
+            if(flValue >= 0.0f && flValue <= 360.0f)
+            {
+                Source->flOuterAngle = float2ALfp(flValue);
+                Source->NeedsUpdate = AL_TRUE;
+            }
+            else
+                alSetError(pContext, AL_INVALID_VALUE);
+            break;
 
-            case AL_CONE_INNER_ANGLE:
-                if(flValue >= 0.0f && flValue <= 360.0f)
-                {
-                    Source->flInnerAngle = float2ALfp(flValue);
-                    Source->NeedsUpdate = AL_TRUE;
-                }
-                else
-                    alSetError(pContext, AL_INVALID_VALUE);
-                break;
+        case AL_GAIN:
+            if(flValue >= 0.0f)
+            {
+                Source->flGain = float2ALfp(flValue);
+                Source->NeedsUpdate = AL_TRUE;
+            }
+            else
+                alSetError(pContext, AL_INVALID_VALUE);
+            break;
 
-            case AL_CONE_OUTER_ANGLE:
-                if(flValue >= 0.0f && flValue <= 360.0f)
-                {
-                    Source->flOuterAngle = float2ALfp(flValue);
-                    Source->NeedsUpdate = AL_TRUE;
-                }
-                else
-                    alSetError(pContext, AL_INVALID_VALUE);
-                break;
+        case AL_MAX_DISTANCE:
+            if(flValue >= 0.0f)
+            {
+                Source->flMaxDistance = float2ALfp(flValue);
+                Source->NeedsUpdate = AL_TRUE;
+            }
+            else
+                alSetError(pContext, AL_INVALID_VALUE);
+            break;
 
-            case AL_GAIN:
-                if(flValue >= 0.0f)
-                {
-                    Source->flGain = float2ALfp(flValue);
-                    Source->NeedsUpdate = AL_TRUE;
-                }
-                else
-                    alSetError(pContext, AL_INVALID_VALUE);
-                break;
+        case AL_ROLLOFF_FACTOR:
+            if(flValue >= 0.0f)
+            {
+                Source->flRollOffFactor = float2ALfp(flValue);
+                Source->NeedsUpdate = AL_TRUE;
+            }
+            else
+                alSetError(pContext, AL_INVALID_VALUE);
+            break;
 
-            case AL_MAX_DISTANCE:
-                if(flValue >= 0.0f)
-                {
-                    Source->flMaxDistance = float2ALfp(flValue);
-                    Source->NeedsUpdate = AL_TRUE;
-                }
-                else
-                    alSetError(pContext, AL_INVALID_VALUE);
-                break;
+        case AL_REFERENCE_DISTANCE:
+            if(flValue >= 0.0f)
+            {
+                Source->flRefDistance = float2ALfp(flValue);
+                Source->NeedsUpdate = AL_TRUE;
+            }
+            else
+                alSetError(pContext, AL_INVALID_VALUE);
+            break;
 
-            case AL_ROLLOFF_FACTOR:
-                if(flValue >= 0.0f)
-                {
-                    Source->flRollOffFactor = float2ALfp(flValue);
-                    Source->NeedsUpdate = AL_TRUE;
-                }
-                else
-                    alSetError(pContext, AL_INVALID_VALUE);
-                break;
+        case AL_MIN_GAIN:
+            if(flValue >= 0.0f && flValue <= 1.0f)
+            {
+                Source->flMinGain = float2ALfp(flValue);
+                Source->NeedsUpdate = AL_TRUE;
+            }
+            else
+                alSetError(pContext, AL_INVALID_VALUE);
+            break;
 
-            case AL_REFERENCE_DISTANCE:
-                if(flValue >= 0.0f)
-                {
-                    Source->flRefDistance = float2ALfp(flValue);
-                    Source->NeedsUpdate = AL_TRUE;
-                }
-                else
-                    alSetError(pContext, AL_INVALID_VALUE);
-                break;
+        case AL_MAX_GAIN:
+            if(flValue >= 0.0f && flValue <= 1.0f)
+            {
+                Source->flMaxGain = float2ALfp(flValue);
+                Source->NeedsUpdate = AL_TRUE;
+            }
+            else
+                alSetError(pContext, AL_INVALID_VALUE);
+            break;
 
-            case AL_MIN_GAIN:
-                if(flValue >= 0.0f && flValue <= 1.0f)
-                {
-                    Source->flMinGain = float2ALfp(flValue);
-                    Source->NeedsUpdate = AL_TRUE;
-                }
-                else
-                    alSetError(pContext, AL_INVALID_VALUE);
-                break;
+        case AL_CONE_OUTER_GAIN:
+            if(flValue >= 0.0f && flValue <= 1.0f)
+            {
+                Source->flOuterGain = float2ALfp(flValue);
+                Source->NeedsUpdate = AL_TRUE;
+            }
+            else
+                alSetError(pContext, AL_INVALID_VALUE);
+            break;
 
-            case AL_MAX_GAIN:
-                if(flValue >= 0.0f && flValue <= 1.0f)
-                {
-                    Source->flMaxGain = float2ALfp(flValue);
-                    Source->NeedsUpdate = AL_TRUE;
-                }
-                else
-                    alSetError(pContext, AL_INVALID_VALUE);
-                break;
+        case AL_CONE_OUTER_GAINHF:
+            if(flValue >= 0.0f && flValue <= 1.0f)
+            {
+                Source->OuterGainHF = float2ALfp(flValue);
+                Source->NeedsUpdate = AL_TRUE;
+            }
+            else
+                alSetError(pContext, AL_INVALID_VALUE);
+            break;
 
-            case AL_CONE_OUTER_GAIN:
-                if(flValue >= 0.0f && flValue <= 1.0f)
-                {
-                    Source->flOuterGain = float2ALfp(flValue);
-                    Source->NeedsUpdate = AL_TRUE;
-                }
-                else
-                    alSetError(pContext, AL_INVALID_VALUE);
-                break;
+        case AL_AIR_ABSORPTION_FACTOR:
+            if(flValue >= 0.0f && flValue <= 10.0f)
+            {
+                Source->AirAbsorptionFactor = float2ALfp(flValue);
+                Source->NeedsUpdate = AL_TRUE;
+            }
+            else
+                alSetError(pContext, AL_INVALID_VALUE);
+            break;
 
-            case AL_CONE_OUTER_GAINHF:
-                if(flValue >= 0.0f && flValue <= 1.0f)
-                {
-                    Source->OuterGainHF = float2ALfp(flValue);
-                    Source->NeedsUpdate = AL_TRUE;
-                }
-                else
-                    alSetError(pContext, AL_INVALID_VALUE);
-                break;
+        case AL_ROOM_ROLLOFF_FACTOR:
+            if(flValue >= 0.0f && flValue <= 10.0f)
+            {
+                Source->RoomRolloffFactor = float2ALfp(flValue);
+                Source->NeedsUpdate = AL_TRUE;
+            }
+            else
+                alSetError(pContext, AL_INVALID_VALUE);
+            break;
 
-            case AL_AIR_ABSORPTION_FACTOR:
-                if(flValue >= 0.0f && flValue <= 10.0f)
-                {
-                    Source->AirAbsorptionFactor = float2ALfp(flValue);
-                    Source->NeedsUpdate = AL_TRUE;
-                }
-                else
-                    alSetError(pContext, AL_INVALID_VALUE);
-                break;
+        case AL_DOPPLER_FACTOR:
+            if(flValue >= 0.0f && flValue <= 1.0f)
+            {
+                Source->DopplerFactor = float2ALfp(flValue);
+                Source->NeedsUpdate = AL_TRUE;
+            }
+            else
+                alSetError(pContext, AL_INVALID_VALUE);
+            break;
 
-            case AL_ROOM_ROLLOFF_FACTOR:
-                if(flValue >= 0.0f && flValue <= 10.0f)
-                {
-                    Source->RoomRolloffFactor = float2ALfp(flValue);
-                    Source->NeedsUpdate = AL_TRUE;
-                }
+        case AL_SEC_OFFSET:
+        case AL_SAMPLE_OFFSET:
+        case AL_BYTE_OFFSET:
+            if(flValue >= 0.0f)
+            {
+                Source->lOffsetType = eParam;
+
+                // Store Offset (convert Seconds into Milliseconds)
+                if(eParam == AL_SEC_OFFSET)
+                    Source->lOffset = (ALint)(flValue * 1000.0f);
                 else
-                    alSetError(pContext, AL_INVALID_VALUE);
-                break;
+                    Source->lOffset = (ALint)flValue;
 
-            case AL_DOPPLER_FACTOR:
-                if(flValue >= 0.0f && flValue <= 1.0f)
+                if ((Source->state == AL_PLAYING) || (Source->state == AL_PAUSED))
                 {
-                    Source->DopplerFactor = float2ALfp(flValue);
-                    Source->NeedsUpdate = AL_TRUE;
+                    if(ApplyOffset(Source) == AL_FALSE)
+                        alSetError(pContext, AL_INVALID_VALUE);
                 }
-                else
-                    alSetError(pContext, AL_INVALID_VALUE);
-                break;
+            }
+            else
+                alSetError(pContext, AL_INVALID_VALUE);
+            break;
 
-            case AL_SEC_OFFSET:
-            case AL_SAMPLE_OFFSET:
-            case AL_BYTE_OFFSET:
-                if(flValue >= 0.0f)
-                {
-                    Source->lOffsetType = eParam;
+        default:
+            alSetError(pContext, AL_INVALID_ENUM);
+            break;
+    }
+}
 
-                    // Store Offset (convert Seconds into Milliseconds)
-                    if(eParam == AL_SEC_OFFSET)
-                        Source->lOffset = (ALint)(flValue * 1000.0f);
-                    else
-                        Source->lOffset = (ALint)flValue;
+AL_API ALvoid AL_APIENTRY alSourcef(ALuint source, ALenum eParam, ALfloat flValue)
+{
+    ALCcontext    *pContext;
+    ALsource    *Source;
 
-                    if ((Source->state == AL_PLAYING) || (Source->state == AL_PAUSED))
-                    {
-                        if(ApplyOffset(Source) == AL_FALSE)
-                            alSetError(pContext, AL_INVALID_VALUE);
-                    }
-                }
-                else
-                    alSetError(pContext, AL_INVALID_VALUE);
-                break;
+    pContext = (IsOffsetParam(eParam) ? GetContextLocked() :
+                GetContextSuspended());
+    if(!pContext) return;
 
-            default:
-                alSetError(pContext, AL_INVALID_ENUM);
-                break;
-        }
-    }
+    if((Source=LookupSource(pContext->SourceMap, source)) != NULL)
+        SetSourcef(pContext, Source, eParam, flValue);
     else
     {
         // Invalid Source Name
         alSetError(pContext, AL_INVALID_NAME);
     }
 
-    ProcessContext(pContext);
+    if(IsOffsetParam(eParam))
+        UnlockContext(pContext);
+    else
+        ProcessContext(pContext);
 }
 
 
-AL_API ALvoid AL_APIENTRY alSource3f(ALuint source, ALenum eParam, ALfloat flValue1,ALfloat flValue2,ALfloat flValue3)
+static ALvoid SetSource3f(ALCcontext *pContext, ALsource *Source, ALenum eParam,
+                          ALfloat flValue1, ALfloat flValue2, ALfloat flValue3)
 {
-    ALCcontext    *pContext;
-    ALsource    *Source;
+    switch(eParam)
+    {
+        case AL_POSITION:
+            Source->vPosition[0] = float2ALfp(flValue1);
+            Source->vPosition[1] = float2ALfp(flValue2);
+            Source->vPosition[2] = float2ALfp(flValue3);
+            Source->NeedsUpdate = AL_TRUE;
+            break;
 
-    pContext = GetContextSuspended();
-    if(!pContext) return;
+        case AL_VELOCITY:
+            Source->vVelocity[0] = float2ALfp(flValue1);
+            Source->vVelocity[1] = float2ALfp(flValue2);
+            Source->vVelocity[2] = float2ALfp(flValue3);
+            Source->NeedsUpdate = AL_TRUE;
+            break;
 
-    if((Source=LookupSource(pContext->SourceMap, source)) != NULL)
-    {
-        switch(eParam)
-        {
-            case AL_POSITION:
-                Source->vPosition[0] = float2ALfp(flValue1);
-                Source->vPosition[1] = float2ALfp(flValue2);
-                Source->vPosition[2] = float2ALfp(flValue3);
-                Source->NeedsUpdate = AL_TRUE;
-                break;
+        case AL_DIRECTION:
+            Source->vOrientation[0] = float2ALfp(flValue1);
+            Source->vOrientation[1] = float2ALfp(flValue2);
+            Source->vOrientation[2] = float2ALfp(flValue3);
+            Source->NeedsUpdate = AL_TRUE;
+            break;
 
-            case AL_VELOCITY:
-                Source->vVelocity[0] = float2ALfp(flValue1);
-                Source->vVelocity[1] = float2ALfp(flValue2);
-                Source->vVelocity[2] = float2ALfp(flValue3);
-                Source->NeedsUpdate = AL_TRUE;
-                break;
+        default:
+            alSetError(pContext, AL_INVALID_ENUM);
+            break;
+    }
+}
 
-            case AL_DIRECTION:
-                Source->vOrientation[0] = float2ALfp(flValue1);
-                Source->vOrientation[1] = float2ALfp(flValue2);
-                Source->vOrientation[2] = float2ALfp(flValue3);
-                Source->NeedsUpdate = AL_TRUE;
-                break;
+AL_API ALvoid AL_APIENTRY alSource3f(ALuint source, ALenum eParam, ALfloat flValue1,ALfloat flValue2,ALfloat flValue3)
+{
+    ALCcontext    *pContext;
+    ALsource    *Source;
 
-            default:
-                alSetError(pContext, AL_INVALID_ENUM);
-                break;
-        }
-    }
+    pContext = GetContextSuspended();
+    if(!pContext) return;
+
+    if((Source=LookupSource(pContext->SourceMap, source)) != NULL)
+        SetSource3f(pContext, Source, eParam, flValue1, flValue2, flValue3);
     else
         alSetError(pContext, AL_INVALID_NAME);
 
@@ -447,56 +536,65 @@ AL_API ALvoid AL_APIENTRY alSource3f(ALuint source, ALenum eParam, ALfloat flVal
 }
 
 
+static ALvoid SetSourcefv(ALCcontext *pContext, ALsource *Source, ALenum eParam,
+                          const ALfloat *pflValues)
+{
+    switch(eParam)
+    {
+        case AL_PITCH:
+        case AL_CONE_INNER_ANGLE:
+        case AL_CONE_OUTER_ANGLE:
+        case AL_GAIN:
+        case AL_MAX_DISTANCE:
+        case AL_ROLLOFF_FACTOR:
+        case AL_REFERENCE_DISTANCE:
+        case AL_MIN_GAIN:
+        case AL_MAX_GAIN:
+        case AL_CONE_OUTER_GAIN:
+        case AL_CONE_OUTER_GAINHF:
+        case AL_SEC_OFFSET:
+        case AL_SAMPLE_OFFSET:
+        case AL_BYTE_OFFSET:
+        case AL_AIR_ABSORPTION_FACTOR:
+        case AL_ROOM_ROLLOFF_FACTOR:
+            SetSourcef(pContext, Source, eParam, pflValues[0]);
+            break;
+
+        case AL_POSITION:
+        case AL_VELOCITY:
+        case AL_DIRECTION:
+            SetSource3f(pContext, Source, eParam, pflValues[0], pflValues[1], pflValues[2]);
+            break;
+
+        default:
+            alSetError(pContext, AL_INVALID_ENUM);
+            break;
+    }
+}
+
 AL_API ALvoid AL_APIENTRY alSourcefv(ALuint source, ALenum eParam, const ALfloat *pflValues)
 {
     ALCcontext    *pContext;
+    ALsource      *Source;
 
-    pContext = GetContextSuspended();
+    pContext = (IsOffsetParam(eParam) ? GetContextLocked() :
+                GetContextSuspended());
     if(!pContext) return;
 
     if(pflValues)
     {
-        if(LookupSource(pContext->SourceMap, source) != NULL)
-        {
-            switch(eParam)
-            {
-                case AL_PITCH:
-                case AL_CONE_INNER_ANGLE:
-                case AL_CONE_OUTER_ANGLE:
-                case AL_GAIN:
-                case AL_MAX_DISTANCE:
-                case AL_ROLLOFF_FACTOR:
-                case AL_REFERENCE_DISTANCE:
-                case AL_MIN_GAIN:
-                case AL_MAX_GAIN:
-                case AL_CONE_OUTER_GAIN:
-                case AL_CONE_OUTER_GAINHF:
-                case AL_SEC_OFFSET:
-                case AL_SAMPLE_OFFSET:
-                case AL_BYTE_OFFSET:
-                case AL_AIR_ABSORPTION_FACTOR:
-                case AL_ROOM_ROLLOFF_FACTOR:
-                    alSourcef(source, eParam, pflValues[0]);
-                    break;
-
-                case AL_POSITION:
-                case AL_VELOCITY:
-                case AL_DIRECTION:
-                    alSource3f(source, eParam, pflValues[0], pflValues[1], pflValues[2]);
-                    break;
-
-                default:
-                    alSetError(pContext, AL_INVALID_ENUM);
-                    break;
-            }
-        }
+        if((Source=LookupSource(pContext->SourceMap, source)) != NULL)
+            SetSourcefv(pContext, Source, eParam, pflValues);
         else
             alSetError(pContext, AL_INVALID_NAME);
     }
     else
         alSetError(pContext, AL_INVALID_VALUE);
 
-    ProcessContext(pContext);
+    if(IsOffsetParam(eParam))
+        UnlockContext(pContext);
+    else
+        ProcessContext(pContext);
 }
 
 
@@ -506,7 +604,7 @@ AL_API ALvoid AL_APIENTRY alSourcei(ALuint source,ALenum eParam,ALint lValue)
     ALsource            *Source;
     ALbufferlistitem    *BufferListItem;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     if((Source=LookupSource(pContext->SourceMap, source)) != NULL)
@@ -540,13 +638,32 @@ AL_API ALvoid AL_APIENTRY alSourcei(ALuint source,ALenum eParam,ALint lValue)
                     alSetError(pContext, AL_INVALID_VALUE);
                 break;
 
+            case AL_WAIT_FOR_BUFFERS_SOFT:
+                if(lValue == AL_FALSE || lValue == AL_TRUE)
+                    Source->WaitForBuffers = (ALboolean)lValue;
+                else
+                    alSetError(pContext, AL_INVALID_VALUE);
+                break;
+
             case AL_BUFFER:
                 if(Source->state == AL_STOPPED || Source->state == AL_INITIAL)
                 {
                     ALbuffer *buffer = NULL;
 
-                    if(lValue == 0 ||
-                       (buffer=LookupBuffer(device->BufferMap, lValue)) != NULL)
+                    if(lValue != 0 &&
+                       (buffer=LookupBuffer(device->BufferMap, lValue)) != NULL &&
+                       buffer->Callback && !Source->CallbackData)
+                    {
+                        // Somewhere for the mixer to pull the samples into
+                        Source->CallbackData = malloc(STACK_DATA_SIZE);
+                        if(!Source->CallbackData)
+                        {
+                            alSetError(pContext, AL_OUT_OF_MEMORY);
+                            break;
+                        }
+                    }
+
+                    if(lValue == 0 || buffer != NULL)
                     {
                         // Remove all elements in the queue
                         while(Source->queue != NULL)
@@ -589,6 +706,7 @@ AL_API ALvoid AL_APIENTRY alSourcei(ALuint source,ALenum eParam,ALint lValue)
                             Source->lSourceType = AL_UNDETERMINED;
                         }
                         Source->BuffersPlayed = 0;
+                        ResetCallbackData(Source);
 
                         // Update AL_BUFFER parameter
                         Source->Buffer = buffer;
@@ -707,7 +825,7 @@ AL_API ALvoid AL_APIENTRY alSourcei(ALuint source,ALenum eParam,ALint lValue)
     else
         alSetError(pContext, AL_INVALID_NAME);
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 
@@ -716,7 +834,7 @@ AL_API void AL_APIENTRY alSource3i(ALuint source, ALenum eParam, ALint lValue1,
     ALCcontext *pContext;
     ALsource   *Source;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     if((Source=LookupSource(pContext->SourceMap, source)) != NULL)
@@ -771,7 +889,7 @@ AL_API void AL_APIENTRY alSource3i(ALuint source, ALenum eParam, ALint lValue1,
     else
         alSetError(pContext, AL_INVALID_NAME);
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 
@@ -779,7 +897,7 @@ AL_API void AL_APIENTRY alSourceiv(ALuint source, ALenum eParam, const ALint* pl
 {
     ALCcontext    *pContext;
 
-    pContext = GetContextSuspended();
+    pContext = GetContextLocked();
     if(!pContext) return;
 
     if(plValues)
@@ -792,6 +910,7 @@ AL_API void AL_APIENTRY alSourceiv(ALuint source, ALenum eParam, const ALint* pl
                 case AL_CONE_INNER_ANGLE:
                 case AL_CONE_OUTER_ANGLE:
                 case AL_LOOPING:
+                case AL_WAIT_FOR_BUFFERS_SOFT:
                 case AL_BUFFER:
                 case AL_SOURCE_STATE:
                 case AL_SEC_OFFSET:
@@ -826,106 +945,144 @@ AL_API void AL_APIENTRY alSourceiv(ALuint source, ALenum eParam, const ALint* pl
     else
         alSetError(pContext, AL_INVALID_VALUE);
 
-    ProcessContext(pContext);
+    UnlockContext(pContext);
 }
 
 
-AL_API ALvoid AL_APIENTRY alGetSourcef(ALuint source, ALenum eParam, ALfloat *pflValue)
+static ALvoid GetSourcef(ALCcontext *pContext, ALsource *Source, ALenum eParam,
+                         ALfloat *pflValue)
 {
-    ALCcontext  *pContext;
-    ALsource    *Source;
     ALdfp    Offsets[2];
     ALdfp    updateLen;
 
-    pContext = GetContextSuspended();
-    if(!pContext) return;
-
-    if(pflValue)
+    switch(eParam)
     {
-        if((Source=LookupSource(pContext->SourceMap, source)) != NULL)
-        {
-            switch(eParam)
-            {
-                case AL_PITCH:
-                    *pflValue = ALfp2float(Source->flPitch);
-                    break;
+        case AL_PITCH:
+            *pflValue = ALfp2float(Source->flPitch);
+            break;
 
-                case AL_GAIN:
-                    *pflValue = ALfp2float(Source->flGain);
-                    break;
+        case AL_GAIN:
+            *pflValue = ALfp2float(Source->flGain);
+            break;
 
-                case AL_MIN_GAIN:
-                    *pflValue = ALfp2float(Source->flMinGain);
-                    break;
+        case AL_MIN_GAIN:
+            *pflValue = ALfp2float(Source->flMinGain);
+            break;
 
-                case AL_MAX_GAIN:
-                    *pflValue = ALfp2float(Source->flMaxGain);
-                    break;
+        case AL_MAX_GAIN:
+            *pflValue = ALfp2float(Source->flMaxGain);
+            break;
 
-                case AL_MAX_DISTANCE:
-                    *pflValue = ALfp2float(Source->flMaxDistance);
-                    break;
+        case AL_MAX_DISTANCE:
+            *pflValue = ALfp2float(Source->flMaxDistance);
+            break;
 
-                case AL_ROLLOFF_FACTOR:
-                    *pflValue = ALfp2float(Source->flRollOffFactor);
-                    break;
+        case AL_ROLLOFF_FACTOR:
+            *pflValue = ALfp2float(Source->flRollOffFactor);
+            break;
 
-                case AL_CONE_OUTER_GAIN:
-                    *pflValue = ALfp2float(Source->flOuterGain);
-                    break;
+        case AL_CONE_OUTER_GAIN:
+            *pflValue = ALfp2float(Source->flOuterGain);
+            break;
 
-                case AL_CONE_OUTER_GAINHF:
-                    *pflValue = ALfp2float(Source->OuterGainHF);
-                    break;
+        case AL_CONE_OUTER_GAINHF:
+            *pflValue = ALfp2float(Source->OuterGainHF);
+            break;
 
-                case AL_SEC_OFFSET:
-                case AL_SAMPLE_OFFSET:
-                case AL_BYTE_OFFSET:
-                    updateLen = ALdfpDiv(int2ALdfp(pContext->Device->UpdateSize),
-                                         int2ALdfp(pContext->Device->Frequency));
-                    GetSourceOffset(Source, eParam, Offsets, updateLen);
-                    *pflValue = (ALfloat)ALdfp2double(Offsets[0]);
-                    break;
+        case AL_SEC_OFFSET:
+        case AL_SAMPLE_OFFSET:
+        case AL_BYTE_OFFSET:
+            updateLen = ALdfpDiv(int2ALdfp(pContext->Device->UpdateSize),
+                                 int2ALdfp(pContext->Device->Frequency));
+            GetSourceOffset(Source, eParam, Offsets, updateLen);
+            *pflValue = (ALfloat)ALdfp2double(Offsets[0]);
+            break;
 
-                case AL_CONE_INNER_ANGLE:
-                    *pflValue = ALfp2float(Source->flInnerAngle);
-                    break;
+        case AL_CONE_INNER_ANGLE:
+            *pflValue = ALfp2float(Source->flInnerAngle);
+            break;
 
-                case AL_CONE_OUTER_ANGLE:
-                    *pflValue = ALfp2float(Source->flOuterAngle);
-                    break;
+        case AL_CONE_OUTER_ANGLE:
+            *pflValue = ALfp2float(Source->flOuterAngle);
+            break;
 
-                case AL_REFERENCE_DISTANCE:
-                    *pflValue = ALfp2float(Source->flRefDistance);
-                    break;
+        case AL_REFERENCE_DISTANCE:
+            *pflValue = ALfp2float(Source->flRefDistance);
+            break;
 
-                case AL_AIR_ABSORPTION_FACTOR:
-                    *pflValue = ALfp2float(Source->AirAbsorptionFactor);
-                    break;
+        case AL_AIR_ABSORPTION_FACTOR:
+            *pflValue = ALfp2float(Source->AirAbsorptionFactor);
+            break;
 
-                case AL_ROOM_ROLLOFF_FACTOR:
-                    *pflValue = ALfp2float(Source->RoomRolloffFactor);
-                    break;
+        case AL_ROOM_ROLLOFF_FACTOR:
+            *pflValue = ALfp2float(Source->RoomRolloffFactor);
+            break;
 
-                case AL_DOPPLER_FACTOR:
-                    *pflValue = ALfp2float(Source->DopplerFactor);
-                    break;
+        case AL_DOPPLER_FACTOR:
+            *pflValue = ALfp2float(Source->DopplerFactor);
+            break;
 
-                default:
-                    alSetError(pContext, AL_INVALID_ENUM);
-                    break;
-            }
-        }
+        default:
+            alSetError(pContext, AL_INVALID_ENUM);
+            break;
+    }
+}
+
+AL_API ALvoid AL_APIENTRY alGetSourcef(ALuint source, ALenum eParam, ALfloat *pflValue)
+{
+    ALCcontext  *pContext;
+    ALsource    *Source;
+
+    pContext = (IsOffsetQuery(eParam) ? GetContextLocked() :
+                GetContextSuspended());
+    if(!pContext) return;
+
+    if(pflValue)
+    {
+        if((Source=LookupSource(pContext->SourceMap, source)) != NULL)
+            GetSourcef(pContext, Source, eParam, pflValue);
         else
             alSetError(pContext, AL_INVALID_NAME);
     }
     else
         alSetError(pContext, AL_INVALID_VALUE);
 
-    ProcessContext(pContext);
+    if(IsOffsetQuery(eParam))
+        UnlockContext(pContext);
+    else
+        ProcessContext(pContext);
 }
 
 
+static ALvoid GetSource3f(ALCcontext *pContext, ALsource *Source, ALenum eParam,
+                          ALfloat *pflValue1, ALfloat *pflValue2, ALfloat *pflValue3)
+{
+    switch(eParam)
+    {
+        case AL_POSITION:
+            *pflValue1 = ALfp2float(Source->vPosition[0]);
+            *pflValue2 = ALfp2float(Source->vPosition[1]);
+            *pflValue3 = ALfp2float(Source->vPosition[2]);
+            break;
+
+        case AL_VELOCITY:
+            *pflValue1 = ALfp2float(Source->vVelocity[0]);
+            *pflValue2 = ALfp2float(Source->vVelocity[1]);
+            *pflValue3 = ALfp2float(Source->vVelocity[2]);
+            break;
+
+        case AL_DIRECTION:
+            *pflValue1 = ALfp2float(Source->vOrientation[0]);
+            *pflValue2 = ALfp2float(Source->vOrientation[1]);
+            *pflValue3 = ALfp2float(Source->vOrientation[2]);
+            break;
+
+        default:
+            alSetError(pContext, AL_INVALID_ENUM);
+            break;
+    }
+}
+
 AL_API ALvoid AL_APIENTRY alGetSource3f(ALuint source, ALenum eParam, ALfloat* pflValue1, ALfloat* pflValue2, ALfloat* pflValue3)
 {
     ALCcontext    *pContext;
@@ -937,32 +1094,7 @@ AL_API ALvoid AL_APIENTRY alGetSource3f(ALuint source, ALenum eParam, ALfloat* p
     if(pflValue1 && pflValue2 && pflValue3)
     {
         if((Source=LookupSource(pContext->SourceMap, source)) != NULL)
-        {
-            switch(eParam)
-            {
-                case AL_POSITION:
-                    *pflValue1 = ALfp2float(Source->vPosition[0]);
-                    *pflValue2 = ALfp2float(Source->vPosition[1]);
-                    *pflValue3 = ALfp2float(Source->vPosition[2]);
-                    break;
-
-                case AL_VELOCITY:
-                    *pflValue1 = ALfp2float(Source->vVelocity[0]);
-                    *pflValue2 = ALfp2float(Source->vVelocity[1]);
-                    *pflValue3 = ALfp2float(Source->vVelocity[2]);
-                    break;
-
-                case AL_DIRECTION:
-                    *pflValue1 = ALfp2float(Source->vOrientation[0]);
-                    *pflValue2 = ALfp2float(Source->vOrientation[1]);
-                    *pflValue3 = ALfp2float(Source->vOrientation[2]);
-                    break;
-
-                default:
-                    alSetError(pContext, AL_INVALID_ENUM);
-                    break;
-            }
-        }
+            GetSource3f(pContext, Source, eParam, pflValue1, pflValue2, pflValue3);
         else
             alSetError(pContext, AL_INVALID_NAME);
     }
@@ -973,305 +1105,475 @@ AL_API ALvoid AL_APIENTRY alGetSource3f(ALuint source, ALenum eParam, ALfloat* p
 }
 
 
+static ALvoid GetSourcefv(ALCcontext *pContext, ALsource *Source, ALenum eParam,
+                          ALfloat *pflValues)
+{
+    ALdfp    Offsets[2];
+    ALdfp    updateLen;
+
+    switch(eParam)
+    {
+        case AL_PITCH:
+        case AL_GAIN:
+        case AL_MIN_GAIN:
+        case AL_MAX_GAIN:
+        case AL_MAX_DISTANCE:
+        case AL_ROLLOFF_FACTOR:
+        case AL_DOPPLER_FACTOR:
+        case AL_CONE_OUTER_GAIN:
+        case AL_SEC_OFFSET:
+        case AL_SAMPLE_OFFSET:
+        case AL_BYTE_OFFSET:
+        case AL_CONE_INNER_ANGLE:
+        case AL_CONE_OUTER_ANGLE:
+        case AL_REFERENCE_DISTANCE:
+        case AL_CONE_OUTER_GAINHF:
+        case AL_AIR_ABSORPTION_FACTOR:
+        case AL_ROOM_ROLLOFF_FACTOR:
+            GetSourcef(pContext, Source, eParam, pflValues);
+            break;
+
+        case AL_POSITION:
+        case AL_VELOCITY:
+        case AL_DIRECTION:
+            GetSource3f(pContext, Source, eParam, pflValues+0, pflValues+1, pflValues+2);
+            break;
+
+        case AL_SAMPLE_RW_OFFSETS_SOFT:
+        case AL_BYTE_RW_OFFSETS_SOFT:
+            updateLen = ALdfpDiv(int2ALdfp(pContext->Device->UpdateSize),
+                                 int2ALdfp(pContext->Device->Frequency));
+            GetSourceOffset(Source, eParam, Offsets, updateLen);
+            pflValues[0] = (ALfloat)ALdfp2double(Offsets[0]);
+            pflValues[1] = (ALfloat)ALdfp2double(Offsets[1]);
+            break;
+
+        default:
+            alSetError(pContext, AL_INVALID_ENUM);
+            break;
+    }
+}
+
 AL_API ALvoid AL_APIENTRY alGetSourcefv(ALuint source, ALenum eParam, ALfloat *pflValues)
 {
     ALCcontext  *pContext;
     ALsource    *Source;
-    ALdfp    Offsets[2];
-    ALdfp    updateLen;
 
-    pContext = GetContextSuspended();
+    pContext = (IsOffsetQuery(eParam) ? GetContextLocked() :
+                GetContextSuspended());
     if(!pContext) return;
 
     if(pflValues)
     {
         if((Source=LookupSource(pContext->SourceMap, source)) != NULL)
-        {
-            switch(eParam)
-            {
-                case AL_PITCH:
-                case AL_GAIN:
-                case AL_MIN_GAIN:
-                case AL_MAX_GAIN:
-                case AL_MAX_DISTANCE:
-                case AL_ROLLOFF_FACTOR:
-                case AL_DOPPLER_FACTOR:
-                case AL_CONE_OUTER_GAIN:
-                case AL_SEC_OFFSET:
-                case AL_SAMPLE_OFFSET:
-                case AL_BYTE_OFFSET:
-                case AL_CONE_INNER_ANGLE:
-                case AL_CONE_OUTER_ANGLE:
-                case AL_REFERENCE_DISTANCE:
-                case AL_CONE_OUTER_GAINHF:
-                case AL_AIR_ABSORPTION_FACTOR:
-                case AL_ROOM_ROLLOFF_FACTOR:
-                    alGetSourcef(source, eParam, pflValues);
-                    break;
-
-                case AL_POSITION:
-                case AL_VELOCITY:
-                case AL_DIRECTION:
-                    alGetSource3f(source, eParam, pflValues+0, pflValues+1, pflValues+2);
-                    break;
-
-                case AL_SAMPLE_RW_OFFSETS_SOFT:
-                case AL_BYTE_RW_OFFSETS_SOFT:
-                    updateLen = ALdfpDiv(int2ALdfp(pContext->Device->UpdateSize),
-                                         int2ALdfp(pContext->Device->Frequency));
-                    GetSourceOffset(Source, eParam, Offsets, updateLen);
-                    pflValues[0] = (ALfloat)ALdfp2double(Offsets[0]);
-                    pflValues[1] = (ALfloat)ALdfp2double(Offsets[1]);
-                    break;
-
-                default:
-                    alSetError(pContext, AL_INVALID_ENUM);
-                    break;
-            }
-        }
+            GetSourcefv(pContext, Source, eParam, pflValues);
         else
             alSetError(pContext, AL_INVALID_NAME);
     }
     else
         alSetError(pContext, AL_INVALID_VALUE);
 
-    ProcessContext(pContext);
+    if(IsOffsetQuery(eParam))
+        UnlockContext(pContext);
+    else
+        ProcessContext(pContext);
 }
 
 
+static ALvoid GetSourcei(ALCcontext *pContext, ALsource *Source, ALenum eParam,
+                         ALint *plValue)
+{
+    ALdfp   Offsets[2];
+    ALdfp   updateLen;
+
+    switch(eParam)
+    {
+        case AL_MAX_DISTANCE:
+            *plValue = (ALint)ALfp2int(Source->flMaxDistance);
+            break;
+
+        case AL_ROLLOFF_FACTOR:
+            *plValue = (ALint)ALfp2int(Source->flRollOffFactor);
+            break;
+
+        case AL_REFERENCE_DISTANCE:
+            *plValue = (ALint)ALfp2int(Source->flRefDistance);
+            break;
+
+        case AL_SOURCE_RELATIVE:
+            *plValue = Source->bHeadRelative;
+            break;
+
+        case AL_CONE_INNER_ANGLE:
+            *plValue = (ALint)ALfp2int(Source->flInnerAngle);
+            break;
+
+        case AL_CONE_OUTER_ANGLE:
+            *plValue = (ALint)ALfp2int(Source->flOuterAngle);
+            break;
+
+        case AL_LOOPING:
+            *plValue = Source->bLooping;
+            break;
+
+        case AL_WAIT_FOR_BUFFERS_SOFT:
+            *plValue = Source->WaitForBuffers;
+            break;
+
+        case AL_BUFFER:
+            *plValue = (Source->Buffer ? Source->Buffer->buffer : 0);
+            break;
+
+        case AL_SOURCE_STATE:
+            *plValue = GetSourceState(Source);
+            break;
+
+        case AL_BUFFERS_QUEUED:
+            *plValue = Source->BuffersInQueue;
+            break;
+
+        case AL_BUFFERS_PROCESSED:
+            if(Source->bLooping || Source->lSourceType != AL_STREAMING)
+            {
+                /* Buffers on a looping source are in a perpetual state
+                 * of PENDING, so don't report any as PROCESSED */
+                *plValue = 0;
+            }
+            else
+                *plValue = Source->BuffersPlayed;
+            break;
+
+        case AL_SOURCE_TYPE:
+            *plValue = Source->lSourceType;
+            break;
+
+        case AL_SEC_OFFSET:
+        case AL_SAMPLE_OFFSET:
+        case AL_BYTE_OFFSET:
+            updateLen = ALdfpDiv(int2ALdfp(pContext->Device->UpdateSize),
+                                 int2ALdfp(pContext->Device->Frequency));
+            GetSourceOffset(Source, eParam, Offsets, updateLen);
+            *plValue = (ALint)ALfp2int(Offsets[0]);
+            break;
+
+        case AL_DIRECT_FILTER:
+            *plValue = Source->DirectFilter.filter;
+            break;
+
+        case AL_DIRECT_FILTER_GAINHF_AUTO:
+            *plValue = Source->DryGainHFAuto;
+            break;
+
+        case AL_AUXILIARY_SEND_FILTER_GAIN_AUTO:
+            *plValue = Source->WetGainAuto;
+            break;
+
+        case AL_AUXILIARY_SEND_FILTER_GAINHF_AUTO:
+            *plValue = Source->WetGainHFAuto;
+            break;
+
+        case AL_DOPPLER_FACTOR:
+            *plValue = (ALint)ALfp2int(Source->DopplerFactor);
+            break;
+
+        case AL_DISTANCE_MODEL:
+            *plValue = Source->DistanceModel;
+            break;
+
+        default:
+            alSetError(pContext, AL_INVALID_ENUM);
+            break;
+    }
+}
+
 AL_API ALvoid AL_APIENTRY alGetSourcei(ALuint source, ALenum eParam, ALint *plValue)
 {
     ALCcontext *pContext;
     ALsource   *Source;
-    ALdfp   Offsets[2];
-    ALdfp   updateLen;
 
-    pContext = GetContextSuspended();
+    pContext = (IsOffsetQuery(eParam) ? GetContextLocked() :
+                GetContextSuspended());
     if(!pContext) return;
 
     if(plValue)
     {
         if((Source=LookupSource(pContext->SourceMap, source)) != NULL)
-        {
-            switch(eParam)
-            {
-                case AL_MAX_DISTANCE:
-                    *plValue = (ALint)ALfp2int(Source->flMaxDistance);
-                    break;
+            GetSourcei(pContext, Source, eParam, plValue);
+        else
+            alSetError(pContext, AL_INVALID_NAME);
+    }
+    else
+        alSetError(pContext, AL_INVALID_VALUE);
 
-                case AL_ROLLOFF_FACTOR:
-                    *plValue = (ALint)ALfp2int(Source->flRollOffFactor);
-                    break;
+    if(IsOffsetQuery(eParam))
+        UnlockContext(pContext);
+    else
+        ProcessContext(pContext);
+}
 
-                case AL_REFERENCE_DISTANCE:
-                    *plValue = (ALint)ALfp2int(Source->flRefDistance);
-                    break;
 
-                case AL_SOURCE_RELATIVE:
-                    *plValue = Source->bHeadRelative;
-                    break;
+static ALvoid GetSource3i(ALCcontext *pContext, ALsource *Source, ALenum eParam,
+                          ALint *plValue1, ALint *plValue2, ALint *plValue3)
+{
+    switch(eParam)
+    {
+        case AL_POSITION:
+            *plValue1 = (ALint)ALfp2int(Source->vPosition[0]);
+            *plValue2 = (ALint)ALfp2int(Source->vPosition[1]);
+            *plValue3 = (ALint)ALfp2int(Source->vPosition[2]);
+            break;
 
-                case AL_CONE_INNER_ANGLE:
-                    *plValue = (ALint)ALfp2int(Source->flInnerAngle);
-                    break;
+        case AL_VELOCITY:
+            *plValue1 = (ALint)ALfp2int(Source->vVelocity[0]);
+            *plValue2 = (ALint)ALfp2int(Source->vVelocity[1]);
+            *plValue3 = (ALint)ALfp2int(Source->vVelocity[2]);
+            break;
 
-                case AL_CONE_OUTER_ANGLE:
-                    *plValue = (ALint)ALfp2int(Source->flOuterAngle);
-                    break;
+        case AL_DIRECTION:
+            *plValue1 = (ALint)ALfp2int(Source->vOrientation[0]);
+            *plValue2 = (ALint)ALfp2int(Source->vOrientation[1]);
+            *plValue3 = (ALint)ALfp2int(Source->vOrientation[2]);
+            break;
 
-                case AL_LOOPING:
-                    *plValue = Source->bLooping;
-                    break;
+        default:
+            alSetError(pContext, AL_INVALID_ENUM);
+            break;
+    }
+}
 
-                case AL_BUFFER:
-                    *plValue = (Source->Buffer ? Source->Buffer->buffer : 0);
-                    break;
+AL_API void AL_APIENTRY alGetSource3i(ALuint source, ALenum eParam, ALint* plValue1, ALint* plValue2, ALint* plValue3)
+{
+    ALCcontext  *pContext;
+    ALsource    *Source;
 
-                case AL_SOURCE_STATE:
-                    *plValue = Source->state;
-                    break;
+    pContext = GetContextSuspended();
+    if(!pContext) return;
 
-                case AL_BUFFERS_QUEUED:
-                    *plValue = Source->BuffersInQueue;
-                    break;
+    if(plValue1 && plValue2 && plValue3)
+    {
+        if((Source=LookupSource(pContext->SourceMap, source)) != NULL)
+            GetSource3i(pContext, Source, eParam, plValue1, plValue2, plValue3);
+        else
+            alSetError(pContext, AL_INVALID_NAME);
+    }
+    else
+        alSetError(pContext, AL_INVALID_VALUE);
 
-                case AL_BUFFERS_PROCESSED:
-                    if(Source->bLooping || Source->lSourceType != AL_STREAMING)
-                    {
-                        /* Buffers on a looping source are in a perpetual state
-                         * of PENDING, so don't report any as PROCESSED */
-                        *plValue = 0;
-                    }
-                    else
-                        *plValue = Source->BuffersPlayed;
-                    break;
+    ProcessContext(pContext);
+}
 
-                case AL_SOURCE_TYPE:
-                    *plValue = Source->lSourceType;
-                    break;
 
-                case AL_SEC_OFFSET:
-                case AL_SAMPLE_OFFSET:
-                case AL_BYTE_OFFSET:
-                    updateLen = ALdfpDiv(int2ALdfp(pContext->Device->UpdateSize),
-                                         int2ALdfp(pContext->Device->Frequency));
-                    GetSourceOffset(Source, eParam, Offsets, updateLen);
-                    *plValue = (ALint)ALfp2int(Offsets[0]);
-                    break;
+static ALvoid GetSourceiv(ALCcontext *pContext, ALsource *Source, ALenum eParam,
+                          ALint *plValues)
+{
+    ALdfp    Offsets[2];
+    ALdfp    updateLen;
 
-                case AL_DIRECT_FILTER:
-                    *plValue = Source->DirectFilter.filter;
-                    break;
+    switch(eParam)
+    {
+        case AL_SOURCE_RELATIVE:
+        case AL_CONE_INNER_ANGLE:
+        case AL_CONE_OUTER_ANGLE:
+        case AL_LOOPING:
+        case AL_WAIT_FOR_BUFFERS_SOFT:
+        case AL_BUFFER:
+        case AL_SOURCE_STATE:
+        case AL_BUFFERS_QUEUED:
+        case AL_BUFFERS_PROCESSED:
+        case AL_SEC_OFFSET:
+        case AL_SAMPLE_OFFSET:
+        case AL_BYTE_OFFSET:
+        case AL_MAX_DISTANCE:
+        case AL_ROLLOFF_FACTOR:
+        case AL_DOPPLER_FACTOR:
+        case AL_REFERENCE_DISTANCE:
+        case AL_SOURCE_TYPE:
+        case AL_DIRECT_FILTER:
+        case AL_DIRECT_FILTER_GAINHF_AUTO:
+        case AL_AUXILIARY_SEND_FILTER_GAIN_AUTO:
+        case AL_AUXILIARY_SEND_FILTER_GAINHF_AUTO:
+        case AL_DISTANCE_MODEL:
+            GetSourcei(pContext, Source, eParam, plValues);
+            break;
 
-                case AL_DIRECT_FILTER_GAINHF_AUTO:
-                    *plValue = Source->DryGainHFAuto;
-                    break;
+        case AL_POSITION:
+        case AL_VELOCITY:
+        case AL_DIRECTION:
+            GetSource3i(pContext, Source, eParam, plValues+0, plValues+1, plValues+2);
+            break;
 
-                case AL_AUXILIARY_SEND_FILTER_GAIN_AUTO:
-                    *plValue = Source->WetGainAuto;
-                    break;
+        case AL_SAMPLE_RW_OFFSETS_SOFT:
+        case AL_BYTE_RW_OFFSETS_SOFT:
+            updateLen = ALdfpDiv(int2ALdfp(pContext->Device->UpdateSize),
+                                 int2ALdfp(pContext->Device->Frequency));
+            GetSourceOffset(Source, eParam, Offsets, updateLen);
+            plValues[0] = (ALint)ALdfp2int(Offsets[0]);
+            plValues[1] = (ALint)ALdfp2int(Offsets[1]);
+            break;
 
-                case AL_AUXILIARY_SEND_FILTER_GAINHF_AUTO:
-                    *plValue = Source->WetGainHFAuto;
-                    break;
+        default:
+            alSetError(pContext, AL_INVALID_ENUM);
+            break;
+    }
+}
 
-                case AL_DOPPLER_FACTOR:
-                    *plValue = (ALint)ALfp2int(Source->DopplerFactor);
-                    break;
+AL_API void AL_APIENTRY alGetSourceiv(ALuint source, ALenum eParam, ALint* plValues)
+{
+    ALCcontext  *pContext;
+    ALsource    *Source;
 
-                case AL_DISTANCE_MODEL:
-                    *plValue = Source->DistanceModel;
-                    break;
+    pContext = (IsOffsetQuery(eParam) ? GetContextLocked() :
+                GetContextSuspended());
+    if(!pContext) return;
 
-                default:
-                    alSetError(pContext, AL_INVALID_ENUM);
-                    break;
-            }
-        }
+    if(plValues)
+    {
+        if((Source=LookupSource(pContext->SourceMap, source)) != NULL)
+            GetSourceiv(pContext, Source, eParam, plValues);
         else
             alSetError(pContext, AL_INVALID_NAME);
     }
     else
         alSetError(pContext, AL_INVALID_VALUE);
 
-    ProcessContext(pContext);
+    if(IsOffsetQuery(eParam))
+        UnlockContext(pContext);
+    else
+        ProcessContext(pContext);
 }
 
 
-AL_API void AL_APIENTRY alGetSource3i(ALuint source, ALenum eParam, ALint* plValue1, ALint* plValue2, ALint* plValue3)
+/* The number of values a source property takes in the array functions */
+static __inline ALsizei SourceValueCount(ALenum param)
 {
-    ALCcontext  *pContext;
-    ALsource    *Source;
+    switch(param)
+    {
+        case AL_POSITION:
+        case AL_VELOCITY:
+        case AL_DIRECTION:
+            return 3;
 
-    pContext = GetContextSuspended();
-    if(!pContext) return;
+        case AL_SAMPLE_RW_OFFSETS_SOFT:
+        case AL_BYTE_RW_OFFSETS_SOFT:
+            return 2;
+    }
+    return 1;
+}
 
-    if(plValue1 && plValue2 && plValue3)
+/* Checks the arguments of the multi-source functions, and that all the
+ * sources are valid so either all of them or none are touched */
+static ALboolean CheckSourceArray(ALCcontext *Context, ALsizei n,
+                                  const ALuint *sources, const ALvoid *values)
+{
+    ALsizei i;
+
+    if(n < 0 || (n > 0 && (!sources || !values)))
     {
-        if((Source=LookupSource(pContext->SourceMap, source)) != NULL)
+        alSetError(Context, AL_INVALID_VALUE);
+        return AL_FALSE;
+    }
+    for(i = 0;i < n;i++)
+    {
+        if(!LookupSource(Context->SourceMap, sources[i]))
         {
-            switch(eParam)
-            {
-                case AL_POSITION:
-                    *plValue1 = (ALint)ALfp2int(Source->vPosition[0]);
-                    *plValue2 = (ALint)ALfp2int(Source->vPosition[1]);
-                    *plValue3 = (ALint)ALfp2int(Source->vPosition[2]);
-                    break;
+            alSetError(Context, AL_INVALID_NAME);
+            return AL_FALSE;
+        }
+    }
+    return AL_TRUE;
+}
 
-                case AL_VELOCITY:
-                    *plValue1 = (ALint)ALfp2int(Source->vVelocity[0]);
-                    *plValue2 = (ALint)ALfp2int(Source->vVelocity[1]);
-                    *plValue3 = (ALint)ALfp2int(Source->vVelocity[2]);
-                    break;
+/*
+    alSourcesfvSOFT
 
-                case AL_DIRECTION:
-                    *plValue1 = (ALint)ALfp2int(Source->vOrientation[0]);
-                    *plValue2 = (ALint)ALfp2int(Source->vOrientation[1]);
-                    *plValue3 = (ALint)ALfp2int(Source->vOrientation[2]);
-                    break;
+    Sets a float property on n sources at once. values holds each source's
+    value(s) in turn, eg. n*3 floats for AL_POSITION.
+*/
+AL_API ALvoid AL_APIENTRY alSourcesfvSOFT(ALsizei n, const ALuint *sources, ALenum eParam, const ALfloat *pflValues)
+{
+    ALCcontext *pContext;
+    ALsizei    count, i;
 
-                default:
-                    alSetError(pContext, AL_INVALID_ENUM);
-                    break;
-            }
+    pContext = (IsOffsetParam(eParam) ? GetContextLocked() :
+                GetContextSuspended());
+    if(!pContext) return;
+
+    if(CheckSourceArray(pContext, n, sources, pflValues))
+    {
+        count = SourceValueCount(eParam);
+        for(i = 0;i < n;i++)
+        {
+            ALsource *Source = (ALsource*)ALTHUNK_LOOKUPENTRY(sources[i]);
+            SetSourcefv(pContext, Source, eParam, &pflValues[i*count]);
         }
-        else
-            alSetError(pContext, AL_INVALID_NAME);
     }
-    else
-        alSetError(pContext, AL_INVALID_VALUE);
 
-    ProcessContext(pContext);
+    if(IsOffsetParam(eParam))
+        UnlockContext(pContext);
+    else
+        ProcessContext(pContext);
 }
 
+/*
+    alGetSourcesfvSOFT
 
-AL_API void AL_APIENTRY alGetSourceiv(ALuint source, ALenum eParam, ALint* plValues)
+    Gets a float property of n sources at once, laid out as alSourcesfvSOFT
+    takes them.
+*/
+AL_API ALvoid AL_APIENTRY alGetSourcesfvSOFT(ALsizei n, const ALuint *sources, ALenum eParam, ALfloat *pflValues)
 {
-    ALCcontext  *pContext;
-    ALsource    *Source;
-    ALdfp    Offsets[2];
-    ALdfp    updateLen;
+    ALCcontext *pContext;
+    ALsizei    count, i;
 
-    pContext = GetContextSuspended();
+    pContext = (IsOffsetQuery(eParam) ? GetContextLocked() :
+                GetContextSuspended());
     if(!pContext) return;
 
-    if(plValues)
+    if(CheckSourceArray(pContext, n, sources, pflValues))
     {
-        if((Source=LookupSource(pContext->SourceMap, source)) != NULL)
+        count = SourceValueCount(eParam);
+        for(i = 0;i < n;i++)
         {
-            switch(eParam)
-            {
-                case AL_SOURCE_RELATIVE:
-                case AL_CONE_INNER_ANGLE:
-                case AL_CONE_OUTER_ANGLE:
-                case AL_LOOPING:
-                case AL_BUFFER:
-                case AL_SOURCE_STATE:
-                case AL_BUFFERS_QUEUED:
-                case AL_BUFFERS_PROCESSED:
-                case AL_SEC_OFFSET:
-                case AL_SAMPLE_OFFSET:
-                case AL_BYTE_OFFSET:
-                case AL_MAX_DISTANCE:
-                case AL_ROLLOFF_FACTOR:
-                case AL_DOPPLER_FACTOR:
-                case AL_REFERENCE_DISTANCE:
-                case AL_SOURCE_TYPE:
-                case AL_DIRECT_FILTER:
-                case AL_DIRECT_FILTER_GAINHF_AUTO:
-                case AL_AUXILIARY_SEND_FILTER_GAIN_AUTO:
-                case AL_AUXILIARY_SEND_FILTER_GAINHF_AUTO:
-                case AL_DISTANCE_MODEL:
-                    alGetSourcei(source, eParam, plValues);
-                    break;
+            ALsource *Source = (ALsource*)ALTHUNK_LOOKUPENTRY(sources[i]);
+            GetSourcefv(pContext, Source, eParam, &pflValues[i*count]);
+        }
+    }
 
-                case AL_POSITION:
-                case AL_VELOCITY:
-                case AL_DIRECTION:
-                    alGetSource3i(source, eParam, plValues+0, plValues+1, plValues+2);
-                    break;
+    if(IsOffsetQuery(eParam))
+        UnlockContext(pContext);
+    else
+        ProcessContext(pContext);
+}
 
-                case AL_SAMPLE_RW_OFFSETS_SOFT:
-                case AL_BYTE_RW_OFFSETS_SOFT:
-                    updateLen = ALdfpDiv(int2ALdfp(pContext->Device->UpdateSize),
-                                         int2ALdfp(pContext->Device->Frequency));
-                    GetSourceOffset(Source, eParam, Offsets, updateLen);
-                    plValues[0] = (ALint)ALdfp2int(Offsets[0]);
-                    plValues[1] = (ALint)ALdfp2int(Offsets[1]);
-                    break;
+/*
+    alGetSourcesivSOFT
 
-                default:
-                    alSetError(pContext, AL_INVALID_ENUM);
-                    break;
-            }
+    Gets an integer property of n sources at once, eg. AL_SOURCE_STATE or
+    AL_SAMPLE_OFFSET for every playing voice.
+*/
+AL_API ALvoid AL_APIENTRY alGetSourcesivSOFT(ALsizei n, const ALuint *sources, ALenum eParam, ALint *plValues)
+{
+    ALCcontext *pContext;
+    ALsizei    count, i;
+
+    pContext = (IsOffsetQuery(eParam) ? GetContextLocked() :
+                GetContextSuspended());
+    if(!pContext) return;
+
+    if(CheckSourceArray(pContext, n, sources, plValues))
+    {
+        count = SourceValueCount(eParam);
+        for(i = 0;i < n;i++)
+        {
+            ALsource *Source = (ALsource*)ALTHUNK_LOOKUPENTRY(sources[i]);
+            GetSourceiv(pContext, Source, eParam, &plValues[i*count]);
         }
-        else
-            alSetError(pContext, AL_INVALID_NAME);
     }
-    else
-        alSetError(pContext, AL_INVALID_VALUE);
 
-    ProcessContext(pContext);
+    if(IsOffsetQuery(eParam))
+        UnlockContext(pContext);
+    else
+        ProcessContext(pContext);
 }
 
 
@@ -1284,8 +1586,7 @@ AL_API ALvoid AL_APIENTRY alSourcePlayv(ALsizei n, const ALuint *sources)
 {
     ALCcontext       *Context;
     ALsource         *Source;
-    ALbufferlistitem *BufferList;
-    ALsizei          i, j;
+    ALsizei          i;
 
     Context = GetContextSuspended();
     if(!Context) return;
@@ -1311,97 +1612,18 @@ AL_API ALvoid AL_APIENTRY alSourcePlayv(ALsizei n, const ALuint *sources)
         }
     }
 
-    
-    while(Context->MaxActiveSources-Context->ActiveSourceCount < n)
-    {
-        void *temp = NULL;
-        ALsizei newcount;
-
-        newcount = Context->MaxActiveSources << 1;
-        if(newcount > 0)
-            temp = realloc(Context->ActiveSources,
-                           sizeof(*Context->ActiveSources) * newcount);
-        if(!temp)
-        {
-            alSetError(Context, AL_OUT_OF_MEMORY);
-            goto done;
-        }
-
-        Context->ActiveSources = temp;
-        Context->MaxActiveSources = newcount;
-    }
-
-    
     for(i = 0;i < n;i++)
     {
         Source = (ALsource*)ALTHUNK_LOOKUPENTRY(sources[i]);
 
-#ifdef MAX_SOURCES_LOW
-        if (Context->ActiveSourceCount >= (alc_max_sources - Context->PrioritySlots) && Source->priority < 127) {
-            LOGV("Skipping starting source %d due to lack of CPU time.", sources[i]);
-            continue;
-        }
-#endif
-
-        // Check that there is a queue containing at least one non-null, non zero length AL Buffer
-        BufferList = Source->queue;
-        while(BufferList)
-        {
-            if(BufferList->buffer != NULL && BufferList->buffer->size)
-                break;
-            BufferList = BufferList->next;
-        }
-
-        if(!BufferList)
-        {
-            Source->state = AL_STOPPED;
-            Source->BuffersPlayed = Source->BuffersInQueue;
-            Source->position = 0;
-            Source->position_fraction = 0;
-            Source->lOffset = 0;
-            continue;
-        }
-
-        if(Source->state != AL_PAUSED)
-        {
-            Source->state = AL_PLAYING;
-            Source->position = 0;
-            Source->position_fraction = 0;
-            Source->BuffersPlayed = 0;
-
-            Source->Buffer = Source->queue->buffer;
-        }
-        else
-            Source->state = AL_PLAYING;
-
-        // Check if an Offset has been set
-        if(Source->lOffset)
-            ApplyOffset(Source);
-
-        // If device is disconnected, go right to stopped
-        if(!Context->Device->Connected)
-        {
-            Source->state = AL_STOPPED;
-            Source->BuffersPlayed = Source->BuffersInQueue;
-            Source->position = 0;
-            Source->position_fraction = 0;
-        }
-        else
-        {
-            for(j = 0;j < Context->ActiveSourceCount;j++)
-            {
-                if(Context->ActiveSources[j] == Source)
-                    break;
-            }
-            if(j == Context->ActiveSourceCount)
-                Context->ActiveSources[Context->ActiveSourceCount++] = Source;
-        }
+        // Without anything to play, or with the device disconnected, the
+        // source goes right to stopped
+        PostSourceCommand(Context, Source, AL_PLAYING);
+        Source->AppState = ((HasPlayableBuffer(Source) &&
+                             Context->Device->Connected) ? AL_PLAYING :
+                                                           AL_STOPPED);
     }
-
-#ifdef MAX_SOURCES_LOW
-    //Apportable Need to give the ALC platform code a hint for setting Source limit based on performance
-    alc_active_sources = Context->ActiveSourceCount;
-#endif
+    FlushSourceCommands(Context);
 
 done:
     ProcessContext(Context);
@@ -1445,9 +1667,13 @@ AL_API ALvoid AL_APIENTRY alSourcePausev(ALsizei n, const ALuint *sources)
     for(i = 0;i < n;i++)
     {
         Source = (ALsource*)ALTHUNK_LOOKUPENTRY(sources[i]);
-        if(Source->state == AL_PLAYING)
-            Source->state = AL_PAUSED;
+        if(GetSourceState(Source) == AL_PLAYING)
+        {
+            PostSourceCommand(Context, Source, AL_PAUSED);
+            Source->AppState = AL_PAUSED;
+        }
     }
+    FlushSourceCommands(Context);
 
 done:
     ProcessContext(Context);
@@ -1491,13 +1717,14 @@ AL_API ALvoid AL_APIENTRY alSourceStopv(ALsizei n, const ALuint *sources)
     for(i = 0;i < n;i++)
     {
         Source = (ALsource*)ALTHUNK_LOOKUPENTRY(sources[i]);
-        if(Source->state != AL_INITIAL)
-        {
-            Source->state = AL_STOPPED;
-            Source->BuffersPlayed = Source->BuffersInQueue;
-        }
-        Source->lOffset = 0;
+        // A source that was never played stays initial
+        if(GetSourceState(Source) != AL_INITIAL)
+            Source->AppState = AL_STOPPED;
+        else
+            Source->AppState = AL_INITIAL;
+        PostSourceCommand(Context, Source, AL_STOPPED);
     }
+    FlushSourceCommands(Context);
 
 done:
     ProcessContext(Context);
@@ -1541,17 +1768,10 @@ AL_API ALvoid AL_APIENTRY alSourceRewindv(ALsizei n, const ALuint *sources)
     for(i = 0;i < n;i++)
     {
         Source = (ALsource*)ALTHUNK_LOOKUPENTRY(sources[i]);
-        if(Source->state != AL_INITIAL)
-        {
-            Source->state = AL_INITIAL;
-            Source->position = 0;
-            Source->position_fraction = 0;
-            Source->BuffersPlayed = 0;
-            if(Source->queue)
-                Source->Buffer = Source->queue->buffer;
-        }
-        Source->lOffset = 0;
+        PostSourceCommand(Context, Source, AL_INITIAL);
+        Source->AppState = AL_INITIAL;
     }
+    FlushSourceCommands(Context);
 
 done:
     ProcessContext(Context);
@@ -1572,7 +1792,7 @@ AL_API ALvoid AL_APIENTRY alSourceQueueBuffers(ALuint source, ALsizei n, const A
     if(n == 0)
         return;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     if(n < 0)
@@ -1624,6 +1844,12 @@ AL_API ALvoid AL_APIENTRY alSourceQueueBuffers(ALuint source, ALsizei n, const A
             alSetError(Context, AL_INVALID_NAME);
             goto done;
         }
+        // Callback buffers stream by themselves, and only as AL_BUFFER
+        if(buffer->Callback)
+        {
+            alSetError(Context, AL_INVALID_OPERATION);
+            goto done;
+        }
 
         if(BufferFmt == NULL)
         {
@@ -1637,6 +1863,7 @@ AL_API ALvoid AL_APIENTRY alSourceQueueBuffers(ALuint source, ALsizei n, const A
             Source->NeedsUpdate = AL_TRUE;
         }
         else if(BufferFmt->Frequency != buffer->Frequency ||
+                BufferFmt->OriginalFrequency != buffer->OriginalFrequency ||
                 BufferFmt->OriginalChannels != buffer->OriginalChannels ||
                 BufferFmt->OriginalType != buffer->OriginalType)
         {
@@ -1697,7 +1924,7 @@ AL_API ALvoid AL_APIENTRY alSourceQueueBuffers(ALuint source, ALsizei n, const A
     Source->BuffersInQueue += n;
 
 done:
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 
@@ -1713,7 +1940,7 @@ AL_API ALvoid AL_APIENTRY alSourceUnqueueBuffers( ALuint source, ALsizei n, ALui
     if(n == 0)
         return;
 
-    Context = GetContextSuspended();
+    Context = GetContextLocked();
     if(!Context) return;
 
     if(n < 0)
@@ -1768,7 +1995,7 @@ AL_API ALvoid AL_APIENTRY alSourceUnqueueBuffers( ALuint source, ALsizei n, ALui
     Source->BuffersPlayed -= n;
 
 done:
-    ProcessContext(Context);
+    UnlockContext(Context);
 }
 
 
@@ -1790,6 +2017,7 @@ static ALvoid InitSourceParams(ALsource *Source)
     Source->flMaxDistance = int2ALfp(FLT_MAX);
     Source->flRollOffFactor = int2ALfp(1);
     Source->bLooping = AL_FALSE;
+    Source->WaitForBuffers = AL_TRUE;
     Source->flGain = int2ALfp(1);
     Source->flMinGain = int2ALfp(0);
     Source->flMaxGain = int2ALfp(1);
@@ -1808,6 +2036,9 @@ static ALvoid InitSourceParams(ALsource *Source)
     Source->Resampler = DefaultResampler;
 
     Source->state = AL_INITIAL;
+    Source->AppState = AL_INITIAL;
+    Source->PendingCmds = 0;
+    Source->Starting = AL_FALSE;
     Source->lSourceType = AL_UNDETERMINED;
 
     Source->NeedsUpdate = AL_TRUE;
@@ -1879,7 +2110,11 @@ static ALvoid GetSourceOffset(ALsource *Source, ALenum name, ALdfp *offset, ALdf
     else
         writePos = readPos;
 
-    if(Source->bLooping)
+    if(Buffer->Callback)
+    {
+        // A callback stream has no end to wrap at
+    }
+    else if(Source->bLooping)
     {
         readPos %= TotalBufferDataSize;
         writePos %= TotalBufferDataSize;
@@ -1901,8 +2136,8 @@ static ALvoid GetSourceOffset(ALsource *Source, ALenum name, ALdfp *offset, ALdf
             break;
         case AL_SAMPLE_OFFSET:
         case AL_SAMPLE_RW_OFFSETS_SOFT:
-            offset[0] = int2ALdfp(readPos / (Channels * Bytes));
-            offset[1] = int2ALdfp(writePos / (Channels * Bytes));
+            offset[0] = int2ALdfp(FramesToOriginal(Buffer, readPos / (Channels * Bytes)));
+            offset[1] = int2ALdfp(FramesToOriginal(Buffer, writePos / (Channels * Bytes)));
             break;
         case AL_BYTE_OFFSET:
         case AL_BYTE_RW_OFFSETS_SOFT:
@@ -1925,9 +2160,12 @@ static ALvoid GetSourceOffset(ALsource *Source, ALenum name, ALdfp *offset, ALdf
             }
             else
             {
-                ALuint OrigBytes = BytesFromUserFmt(OriginalType);
-                offset[0] = int2ALdfp(readPos / Bytes * OrigBytes);
-                offset[1] = int2ALdfp(writePos / Bytes * OrigBytes);
+                ALuint OrigFrameSize = FrameSizeFromUserFmt(Buffer->OriginalChannels,
+                                                            OriginalType);
+                offset[0] = int2ALdfp(FramesToOriginal(Buffer, readPos / (Channels * Bytes)) *
+                                      OrigFrameSize);
+                offset[1] = int2ALdfp(FramesToOriginal(Buffer, writePos / (Channels * Bytes)) *
+                                      OrigFrameSize);
             }
             break;
     }
@@ -2039,12 +2277,16 @@ static ALint GetByteOffset(ALsource *Source)
             ByteOffset *= 65;
         }
         else
+        {
             ByteOffset /= FrameSizeFromUserFmt(Buffer->OriginalChannels, Buffer->OriginalType);
+            ByteOffset = FramesFromOriginal(Buffer, ByteOffset);
+        }
         ByteOffset *= FrameSizeFromFmt(Buffer->FmtChannels, Buffer->FmtType);
         break;
 
     case AL_SAMPLE_OFFSET:
-        ByteOffset = Source->lOffset * FrameSizeFromFmt(Buffer->FmtChannels, Buffer->FmtType);
+        ByteOffset = FramesFromOriginal(Buffer, Source->lOffset) *
+                     FrameSizeFromFmt(Buffer->FmtChannels, Buffer->FmtType);
         break;
 
     case AL_SEC_OFFSET:
@@ -2060,6 +2302,192 @@ static ALint GetByteOffset(ALsource *Source)
 }
 
 
+/*
+    PostSourceCommand
+
+    Queues a state change for the mixer to apply. Called with the context
+    locked, which leaves only one writer. The caller sets the source's
+    AppState to what the app should see until then; anything that depends on
+    the source's actual state is decided as the change is applied, since the
+    mixer may stop the source meanwhile. While updates are deferred, the
+    change is held back until they're processed.
+*/
+static ALvoid PostSourceCommand(ALCcontext *Context, ALsource *Source,
+                                ALenum State)
+{
+    ALCdevice *Device = Context->Device;
+    ALuint pos = Context->SourceCmdQueued;
+    ALsourcecmd *cmd;
+
+    // Full. Catch up on the mixer's behalf if it isn't busy, otherwise give
+    // it time to get to them. Nothing waits on the context's lock with the
+    // device held, so whoever has the device will let it go. Held back
+    // changes have to go through early to make room.
+    while(pos - __sync_fetch_and_add(&Context->SourceCmdRead, 0) >= SOURCE_CMD_QUEUE_SIZE)
+    {
+        PublishSourceCommands(Context);
+        if(TryEnterCriticalSection(&Device->Mutex))
+        {
+            ProcessSourceCommands(Context);
+            UnlockDevice(Device);
+        }
+        else
+            Sleep(1);
+    }
+
+    cmd = &Context->SourceCmds[pos&(SOURCE_CMD_QUEUE_SIZE-1)];
+    cmd->Source = Source;
+    cmd->State = State;
+
+    // Counted before it's published, so the mixer can't take it off first
+    __sync_fetch_and_add(&Source->PendingCmds, 1);
+    Context->SourceCmdQueued = pos+1;
+    if(!Context->DeferUpdates)
+        PublishSourceCommands(Context);
+}
+
+/*
+    PublishSourceCommands
+
+    Hands the queued state changes to the mixer. Called with the context
+    locked.
+*/
+ALvoid PublishSourceCommands(ALCcontext *Context)
+{
+    ALuint pos = Context->SourceCmdWrite;
+
+    __sync_fetch_and_add(&Context->SourceCmdWrite, Context->SourceCmdQueued-pos);
+}
+
+/*
+    FlushSourceCommands
+
+    Applies the queued state changes now if the mixer isn't in the middle of
+    an update. If it is, it'll get to them before it mixes again.
+*/
+static ALvoid FlushSourceCommands(ALCcontext *Context)
+{
+    ALCdevice *Device = Context->Device;
+
+    if(TryEnterCriticalSection(&Device->Mutex))
+    {
+        ProcessSourceCommands(Context);
+        UnlockDevice(Device);
+    }
+}
+
+/*
+    ProcessSourceCommands
+
+    Applies the context's queued source state changes, in the order they were
+    made. Called with the device held.
+*/
+ALvoid ProcessSourceCommands(ALCcontext *Context)
+{
+    ALuint start = __sync_fetch_and_add(&Context->SourceCmdRead, 0);
+    ALuint end = __sync_fetch_and_add(&Context->SourceCmdWrite, 0);
+    ALuint pos = start;
+    ALsizei j;
+
+    while(pos != end)
+    {
+        const ALsourcecmd *cmd = &Context->SourceCmds[pos&(SOURCE_CMD_QUEUE_SIZE-1)];
+        ALsource *Source = cmd->Source;
+
+        // Dropped when the source was deleted
+        if(!Source)
+        {
+            pos++;
+            continue;
+        }
+
+        switch(cmd->State)
+        {
+            case AL_PLAYING:
+                // Nothing to play, go right to stopped
+                if(!HasPlayableBuffer(Source))
+                {
+                    Source->state = AL_STOPPED;
+                    Source->BuffersPlayed = Source->BuffersInQueue;
+                    Source->position = 0;
+                    Source->position_fraction = 0;
+                    Source->lOffset = 0;
+                    break;
+                }
+
+                // Only a paused source picks up where it left off
+                if(Source->state != AL_PAUSED)
+                {
+                    Source->position = 0;
+                    Source->position_fraction = 0;
+                    Source->BuffersPlayed = 0;
+                    ResetCallbackData(Source);
+
+                    Source->Buffer = Source->queue->buffer;
+                }
+                Source->state = AL_PLAYING;
+                Source->Starting = AL_TRUE;
+
+                // Check if an Offset has been set
+                if(Source->lOffset)
+                    ApplyOffset(Source);
+
+                // If device is disconnected, go right to stopped
+                if(!Context->Device->Connected)
+                {
+                    Source->state = AL_STOPPED;
+                    Source->BuffersPlayed = Source->BuffersInQueue;
+                    Source->position = 0;
+                    Source->position_fraction = 0;
+                    break;
+                }
+
+                for(j = 0;j < Context->ActiveSourceCount;j++)
+                {
+                    if(Context->ActiveSources[j] == Source)
+                        break;
+                }
+                if(j == Context->ActiveSourceCount)
+                    Context->ActiveSources[Context->ActiveSourceCount++] = Source;
+                break;
+
+            case AL_PAUSED:
+                if(Source->state == AL_PLAYING)
+                    Source->state = AL_PAUSED;
+                break;
+
+            case AL_STOPPED:
+                if(Source->state != AL_INITIAL)
+                {
+                    Source->state = AL_STOPPED;
+                    Source->BuffersPlayed = Source->BuffersInQueue;
+                    Source->position = 0;
+                    Source->position_fraction = 0;
+                }
+                Source->lOffset = 0;
+                break;
+
+            case AL_INITIAL:
+                if(Source->state != AL_INITIAL)
+                {
+                    Source->state = AL_INITIAL;
+                    Source->position = 0;
+                    Source->position_fraction = 0;
+                    Source->BuffersPlayed = 0;
+                    if(Source->queue)
+                        Source->Buffer = Source->queue->buffer;
+                }
+                Source->lOffset = 0;
+                break;
+        }
+        __sync_fetch_and_sub(&Source->PendingCmds, 1);
+        pos++;
+    }
+    // Hands the entries back to the writer
+    __sync_fetch_and_add(&Context->SourceCmdRead, end-start);
+}
+
+
 ALvoid ReleaseALSources(ALCcontext *Context)
 {
     ALsizei pos;
@@ -2087,6 +2515,8 @@ ALvoid ReleaseALSources(ALCcontext *Context)
             temp->Send[j].Slot = NULL;
         }
 
+        free(temp->CallbackData);
+
         // Release source structure
         ALTHUNK_REMOVEENTRY(temp->source);
         memset(temp, 0, sizeof(ALsource));
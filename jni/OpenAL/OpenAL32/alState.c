@@ -62,14 +62,7 @@ AL_API ALvoid AL_APIENTRY alEnable(ALenum capability)
     }
 
     if(updateSources)
-    {
-        ALsizei pos;
-        for(pos = 0;pos < Context->SourceMap.size;pos++)
-        {
-            ALsource *source = Context->SourceMap.array[pos].value;
-            source->NeedsUpdate = AL_TRUE;
-        }
-    }
+        Context->UpdateGen++;
 
     ProcessContext(Context);
 }
@@ -95,14 +88,7 @@ AL_API ALvoid AL_APIENTRY alDisable(ALenum capability)
     }
 
     if(updateSources)
-    {
-        ALsizei pos;
-        for(pos = 0;pos < Context->SourceMap.size;pos++)
-        {
-            ALsource *source = Context->SourceMap.array[pos].value;
-            source->NeedsUpdate = AL_TRUE;
-        }
-    }
+        Context->UpdateGen++;
 
     ProcessContext(Context);
 }
@@ -161,6 +147,11 @@ AL_API ALboolean AL_APIENTRY alGetBoolean(ALenum pname)
                 value = AL_TRUE;
             break;
 
+        case AL_DEFERRED_UPDATES_SOFT:
+            if(Context->DeferUpdates)
+                value = AL_TRUE;
+            break;
+
         default:
             alSetError(Context, AL_INVALID_ENUM);
             break;
@@ -197,6 +188,10 @@ AL_API ALdouble AL_APIENTRY alGetDouble(ALenum pname)
             value = (double)ALfp2float(Context->flSpeedOfSound);
             break;
 
+        case AL_DEFERRED_UPDATES_SOFT:
+            value = (ALdouble)Context->DeferUpdates;
+            break;
+
         default:
             alSetError(Context, AL_INVALID_ENUM);
             break;
@@ -233,6 +228,10 @@ AL_API ALfloat AL_APIENTRY alGetFloat(ALenum pname)
             value = ALfp2float(Context->flSpeedOfSound);
             break;
 
+        case AL_DEFERRED_UPDATES_SOFT:
+            value = (ALfloat)Context->DeferUpdates;
+            break;
+
         default:
             alSetError(Context, AL_INVALID_ENUM);
             break;
@@ -269,6 +268,10 @@ AL_API ALint AL_APIENTRY alGetInteger(ALenum pname)
             value = (ALint)ALfp2int(Context->flSpeedOfSound);
             break;
 
+        case AL_DEFERRED_UPDATES_SOFT:
+            value = (ALint)Context->DeferUpdates;
+            break;
+
         case AL_SAMPLE_SOURCE_EXT:
             if(Context->SampleSource)
                 value = (ALint)Context->SampleSource->databuffer;
@@ -320,6 +323,10 @@ AL_API ALvoid AL_APIENTRY alGetBooleanv(ALenum pname,ALboolean *data)
                 *data = (ALboolean)((Context->flSpeedOfSound != int2ALfp(0)) ? AL_TRUE : AL_FALSE);
                 break;
 
+            case AL_DEFERRED_UPDATES_SOFT:
+                *data = Context->DeferUpdates;
+                break;
+
             default:
                 alSetError(Context, AL_INVALID_ENUM);
                 break;
@@ -361,6 +368,10 @@ AL_API ALvoid AL_APIENTRY alGetDoublev(ALenum pname,ALdouble *data)
                 *data = (double)ALfp2float(Context->flSpeedOfSound);
                 break;
 
+            case AL_DEFERRED_UPDATES_SOFT:
+                *data = (ALdouble)Context->DeferUpdates;
+                break;
+
             default:
                 alSetError(Context, AL_INVALID_ENUM);
                 break;
@@ -402,6 +413,10 @@ AL_API ALvoid AL_APIENTRY alGetFloatv(ALenum pname,ALfloat *data)
                 *data = ALfp2float(Context->flSpeedOfSound);
                 break;
 
+            case AL_DEFERRED_UPDATES_SOFT:
+                *data = (ALfloat)Context->DeferUpdates;
+                break;
+
             default:
                 alSetError(Context, AL_INVALID_ENUM);
                 break;
@@ -443,6 +458,10 @@ AL_API ALvoid AL_APIENTRY alGetIntegerv(ALenum pname,ALint *data)
                 *data = (ALint)ALfp2int(Context->flSpeedOfSound);
                 break;
 
+            case AL_DEFERRED_UPDATES_SOFT:
+                *data = (ALint)Context->DeferUpdates;
+                break;
+
             case AL_SAMPLE_SOURCE_EXT:
                 if(Context->SampleSource)
                     *data = (ALint)Context->SampleSource->databuffer;
@@ -551,14 +570,7 @@ AL_API ALvoid AL_APIENTRY alDopplerFactor(ALfloat value)
     // Force updating the sources for these parameters, since even head-
     // relative sources are affected
     if(updateSources)
-    {
-        ALsizei pos;
-        for(pos = 0;pos < Context->SourceMap.size;pos++)
-        {
-            ALsource *source = Context->SourceMap.array[pos].value;
-            source->NeedsUpdate = AL_TRUE;
-        }
-    }
+        Context->UpdateGen++;
 
     ProcessContext(Context);
 }
@@ -580,14 +592,7 @@ AL_API ALvoid AL_APIENTRY alDopplerVelocity(ALfloat value)
         alSetError(Context, AL_INVALID_VALUE);
 
     if(updateSources)
-    {
-        ALsizei pos;
-        for(pos = 0;pos < Context->SourceMap.size;pos++)
-        {
-            ALsource *source = Context->SourceMap.array[pos].value;
-            source->NeedsUpdate = AL_TRUE;
-        }
-    }
+        Context->UpdateGen++;
 
     ProcessContext(Context);
 }
@@ -609,14 +614,7 @@ AL_API ALvoid AL_APIENTRY alSpeedOfSound(ALfloat flSpeedOfSound)
         alSetError(pContext, AL_INVALID_VALUE);
 
     if(updateSources)
-    {
-        ALsizei pos;
-        for(pos = 0;pos < pContext->SourceMap.size;pos++)
-        {
-            ALsource *source = pContext->SourceMap.array[pos].value;
-            source->NeedsUpdate = AL_TRUE;
-        }
-    }
+        pContext->UpdateGen++;
 
     ProcessContext(pContext);
 }
@@ -648,14 +646,36 @@ AL_API ALvoid AL_APIENTRY alDistanceModel(ALenum value)
     }
 
     if(updateSources)
-    {
-        ALsizei pos;
-        for(pos = 0;pos < Context->SourceMap.size;pos++)
-        {
-            ALsource *source = Context->SourceMap.array[pos].value;
-            source->NeedsUpdate = AL_TRUE;
-        }
-    }
+        Context->UpdateGen++;
+
+    ProcessContext(Context);
+}
+
+AL_API ALvoid AL_APIENTRY alDeferUpdatesSOFT(void)
+{
+    ALCcontext *Context;
+
+    Context = GetContextSuspended();
+    if(!Context) return;
+
+    // The mixer keeps using the sources' current parameters until the app
+    // is done changing them
+    Context->DeferUpdates = AL_TRUE;
+
+    ProcessContext(Context);
+}
+
+AL_API ALvoid AL_APIENTRY alProcessUpdatesSOFT(void)
+{
+    ALCcontext *Context;
+
+    Context = GetContextSuspended();
+    if(!Context) return;
+
+    // Everything set since alDeferUpdatesSOFT is picked up together, on the
+    // mixer's next update
+    Context->DeferUpdates = AL_FALSE;
+    PublishSourceCommands(Context);
 
     ProcessContext(Context);
 }
@@ -21,91 +21,155 @@
 #include "config.h"
 
 #include <stdlib.h>
+#include <string.h>
 
 #include "alMain.h"
 #include "alThunk.h"
 
+/* Names are an index into the table plus a generation, so a name held on to
+ * after its object is deleted won't find whatever takes its slot next. The
+ * table grows a page at a time and pages never move, which lets lookups go
+ * without the lock; only adding and removing entries take it. */
+#define THUNK_PAGE_BITS   10
+#define THUNK_PAGE_SIZE   (1<<THUNK_PAGE_BITS)
+#define THUNK_INDEX_BITS  20
+#define THUNK_INDEX_MASK  ((1<<THUNK_INDEX_BITS)-1)
+#define THUNK_MAX_PAGES   (1<<(THUNK_INDEX_BITS-THUNK_PAGE_BITS))
+
 typedef struct {
-    ALvoid *ptr;
-    ALboolean InUse;
+    ALvoid *volatile ptr;
+    // The entry's name while in use, 0 when free
+    volatile ALuint name;
+
+    ALuint generation;
+    // Index+1 of the next free entry, 0 for none
+    ALuint nextFree;
 } ThunkEntry;
 
-static ThunkEntry *g_ThunkArray;
-static ALuint      g_ThunkArraySize;
+static ThunkEntry *volatile g_ThunkPages[THUNK_MAX_PAGES];
+static ALuint g_ThunkArraySize;
+static ALuint g_ThunkFreeList;
 
 static CRITICAL_SECTION g_ThunkLock;
 
+static __inline ThunkEntry *GetEntry(ALuint index)
+{
+    ThunkEntry *page = g_ThunkPages[index>>THUNK_PAGE_BITS];
+    return (page ? &page[index&(THUNK_PAGE_SIZE-1)] : NULL);
+}
+
 void alThunkInit(void)
 {
     InitializeCriticalSection(&g_ThunkLock);
-    g_ThunkArraySize = 1;
-    g_ThunkArray = calloc(1, g_ThunkArraySize * sizeof(ThunkEntry));
+    memset((void*)g_ThunkPages, 0, sizeof(g_ThunkPages));
+    g_ThunkArraySize = 0;
+    g_ThunkFreeList = 0;
 }
 
 void alThunkExit(void)
 {
-    free(g_ThunkArray);
-    g_ThunkArray = NULL;
+    ALuint i;
+
+    for(i = 0;i < THUNK_MAX_PAGES;i++)
+    {
+        free(g_ThunkPages[i]);
+        g_ThunkPages[i] = NULL;
+    }
     g_ThunkArraySize = 0;
+    g_ThunkFreeList = 0;
     DeleteCriticalSection(&g_ThunkLock);
 }
 
 ALuint alThunkAddEntry(ALvoid *ptr)
 {
+    ThunkEntry *entry;
     ALuint index;
+    ALuint name;
 
     EnterCriticalSection(&g_ThunkLock);
 
-    for(index = 0;index < g_ThunkArraySize;index++)
+    if(g_ThunkFreeList)
     {
-        if(g_ThunkArray[index].InUse == AL_FALSE)
-            break;
+        index = g_ThunkFreeList-1;
+        entry = GetEntry(index);
+        g_ThunkFreeList = entry->nextFree;
     }
-
-    if(index == g_ThunkArraySize)
+    else
     {
-        ThunkEntry *NewList;
-
-        NewList = realloc(g_ThunkArray, g_ThunkArraySize*2 * sizeof(ThunkEntry));
-        if(!NewList)
+        index = g_ThunkArraySize;
+        if(index >= THUNK_INDEX_MASK)
         {
             LeaveCriticalSection(&g_ThunkLock);
-            AL_PRINT("Realloc failed to increase to %u enties!\n", g_ThunkArraySize*2);
+            AL_PRINT("Out of thunk entries (%u in use)\n", index);
             return 0;
         }
-        memset(&NewList[g_ThunkArraySize], 0, g_ThunkArraySize*sizeof(ThunkEntry));
-        g_ThunkArraySize *= 2;
-        g_ThunkArray = NewList;
+        if((index&(THUNK_PAGE_SIZE-1)) == 0)
+        {
+            ThunkEntry *page = calloc(THUNK_PAGE_SIZE, sizeof(ThunkEntry));
+            if(!page)
+            {
+                LeaveCriticalSection(&g_ThunkLock);
+                AL_PRINT("Failed to allocate thunk page for %u enties!\n", index+THUNK_PAGE_SIZE);
+                return 0;
+            }
+            g_ThunkPages[index>>THUNK_PAGE_BITS] = page;
+        }
+        g_ThunkArraySize++;
+        entry = GetEntry(index);
     }
 
-    g_ThunkArray[index].ptr = ptr;
-    g_ThunkArray[index].InUse = AL_TRUE;
+    // The index is stored +1 so no name is ever 0
+    name = (entry->generation<<THUNK_INDEX_BITS) | (index+1);
+    entry->ptr = ptr;
+    entry->nextFree = 0;
+    // The pointer has to be visible before the name is
+    __sync_synchronize();
+    entry->name = name;
 
     LeaveCriticalSection(&g_ThunkLock);
 
-    return index+1;
+    return name;
 }
 
-void alThunkRemoveEntry(ALuint index)
+void alThunkRemoveEntry(ALuint name)
 {
+    ALuint index = (name&THUNK_INDEX_MASK) - 1;
+    ThunkEntry *entry;
+
     EnterCriticalSection(&g_ThunkLock);
 
-    if(index > 0 && index <= g_ThunkArraySize)
-        g_ThunkArray[index-1].InUse = AL_FALSE;
+    if(index < g_ThunkArraySize && (entry=GetEntry(index))->name == name)
+    {
+        entry->name = 0;
+        __sync_synchronize();
+        entry->ptr = NULL;
+
+        entry->generation = (entry->generation+1) &
+                            ((1<<(32-THUNK_INDEX_BITS))-1);
+        entry->nextFree = g_ThunkFreeList;
+        g_ThunkFreeList = index+1;
+    }
 
     LeaveCriticalSection(&g_ThunkLock);
 }
 
-ALvoid *alThunkLookupEntry(ALuint index)
+ALvoid *alThunkLookupEntry(ALuint name)
 {
-    ALvoid *ptr = NULL;
-
-    EnterCriticalSection(&g_ThunkLock);
-
-    if(index > 0 && index <= g_ThunkArraySize)
-        ptr = g_ThunkArray[index-1].ptr;
+    ALuint index = (name&THUNK_INDEX_MASK) - 1;
+    ThunkEntry *entry;
+    ALvoid *ptr;
 
-    LeaveCriticalSection(&g_ThunkLock);
+    if(index >= THUNK_MAX_PAGES*THUNK_PAGE_SIZE || !(entry=GetEntry(index)))
+        return NULL;
+
+    if(entry->name != name)
+        return NULL;
+    __sync_synchronize();
+    ptr = entry->ptr;
+    // Removed in the meantime, and maybe reused
+    __sync_synchronize();
+    if(entry->name != name)
+        return NULL;
 
     return ptr;
 }
@@ -31,10 +31,14 @@ OBJECTS += \
  Alc/alcRing.o              \
  Alc/alcThread.o            \
  Alc/ALu.o                  \
+ Alc/fpmath.o               \
  Alc/bs2b.o                 \
  Alc/null.o                 \
  Alc/panning.o              \
  Alc/mixer.o                \
+ Alc/mixer_neon.o           \
+ Alc/mixer_sse.o            \
+ Alc/mixthreads.o           \
 
 endif
 
@@ -158,6 +158,63 @@ AL_API ALvoid AL_APIENTRY alBufferSubDataSOFT(ALuint buffer,ALenum format,const
 #define AL_LOOP_POINTS_SOFT                      0x2015
 #endif
 
+#ifndef AL_SOFT_callback_buffer
+#define AL_SOFT_callback_buffer 1
+typedef ALsizei (AL_APIENTRY*ALBUFFERCALLBACKTYPESOFT)(ALvoid *userptr, ALvoid *sampledata, ALsizei numbytes);
+typedef ALvoid (AL_APIENTRY*PFNALBUFFERCALLBACKSOFTPROC)(ALuint,ALenum,ALsizei,ALBUFFERCALLBACKTYPESOFT,ALvoid*);
+#ifdef AL_ALEXT_PROTOTYPES
+AL_API ALvoid AL_APIENTRY alBufferCallbackSOFT(ALuint buffer,ALenum format,ALsizei freq,ALBUFFERCALLBACKTYPESOFT callback,ALvoid *userptr);
+#endif
+#endif
+
+#ifndef AL_SOFT_mapped_buffer
+#define AL_SOFT_mapped_buffer 1
+typedef ALvoid (AL_APIENTRY*PFNALBUFFERMAPFILESOFTPROC)(ALuint,ALenum,ALint,ALsizei,ALsizei,ALsizei);
+typedef ALvoid (AL_APIENTRY*PFNALBUFFERMAPPATHSOFTPROC)(ALuint,ALenum,const ALchar*,ALsizei,ALsizei,ALsizei);
+#ifdef AL_ALEXT_PROTOTYPES
+AL_API ALvoid AL_APIENTRY alBufferMapFileSOFT(ALuint buffer,ALenum format,ALint fd,ALsizei offset,ALsizei length,ALsizei freq);
+AL_API ALvoid AL_APIENTRY alBufferMapPathSOFT(ALuint buffer,ALenum format,const ALchar *path,ALsizei offset,ALsizei length,ALsizei freq);
+#endif
+#endif
+
+#ifndef AL_SOFT_async_buffer
+#define AL_SOFT_async_buffer 1
+#define AL_BUFFER_READY_SOFT                     0x2016
+#define AL_WAIT_FOR_BUFFERS_SOFT                 0x2017
+typedef ALvoid (AL_APIENTRY*PFNALBUFFERDATAASYNCSOFTPROC)(ALuint,ALenum,const ALvoid*,ALsizei,ALsizei);
+#ifdef AL_ALEXT_PROTOTYPES
+AL_API ALvoid AL_APIENTRY alBufferDataAsyncSOFT(ALuint buffer,ALenum format,const ALvoid *data,ALsizei size,ALsizei freq);
+#endif
+#endif
+
+#ifndef AL_SOFT_buffer_preresample
+#define AL_SOFT_buffer_preresample 1
+#define AL_BUFFER_PRERESAMPLE_SOFT               0x2018
+#endif
+
+#ifndef AL_SOFT_deferred_updates
+#define AL_SOFT_deferred_updates 1
+#define AL_DEFERRED_UPDATES_SOFT                 0xC002
+typedef ALvoid (AL_APIENTRY*PFNALDEFERUPDATESSOFTPROC)(void);
+typedef ALvoid (AL_APIENTRY*PFNALPROCESSUPDATESSOFTPROC)(void);
+#ifdef AL_ALEXT_PROTOTYPES
+AL_API ALvoid AL_APIENTRY alDeferUpdatesSOFT(void);
+AL_API ALvoid AL_APIENTRY alProcessUpdatesSOFT(void);
+#endif
+#endif
+
+#ifndef AL_SOFT_source_arrays
+#define AL_SOFT_source_arrays 1
+typedef ALvoid (AL_APIENTRY*PFNALSOURCESFVSOFTPROC)(ALsizei,const ALuint*,ALenum,const ALfloat*);
+typedef ALvoid (AL_APIENTRY*PFNALGETSOURCESFVSOFTPROC)(ALsizei,const ALuint*,ALenum,ALfloat*);
+typedef ALvoid (AL_APIENTRY*PFNALGETSOURCESIVSOFTPROC)(ALsizei,const ALuint*,ALenum,ALint*);
+#ifdef AL_ALEXT_PROTOTYPES
+AL_API ALvoid AL_APIENTRY alSourcesfvSOFT(ALsizei n,const ALuint *sources,ALenum param,const ALfloat *values);
+AL_API ALvoid AL_APIENTRY alGetSourcesfvSOFT(ALsizei n,const ALuint *sources,ALenum param,ALfloat *values);
+AL_API ALvoid AL_APIENTRY alGetSourcesivSOFT(ALsizei n,const ALuint *sources,ALenum param,ALint *values);
+#endif
+#endif
+
 #ifdef __cplusplus
 }
 #endif
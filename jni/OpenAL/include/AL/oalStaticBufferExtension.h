@@ -0,0 +1,27 @@
+#ifndef __OAL_STATIC_BUFFER_EXTENSION_H__
+#define __OAL_STATIC_BUFFER_EXTENSION_H__
+
+#include "al.h"
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+/* AL_EXT_STATIC_BUFFER
+ *
+ * Source compatible with Apple's extension of the same name. The buffer
+ * references the application's memory instead of copying it, which must then
+ * stay valid until the buffer is deleted or given new data. 8-bit, 16-bit and
+ * float formats are used in place; anything else is converted into a copy as
+ * with alBufferData. Retrieve the function with alGetProcAddress by passing
+ * "alBufferDataStatic".
+ */
+typedef ALvoid (AL_APIENTRY *alBufferDataStaticProcPtr) (const ALint bid, ALenum format, ALvoid *data, ALsizei size, ALsizei freq);
+
+AL_API ALvoid AL_APIENTRY alBufferDataStatic(const ALint bid, ALenum format, ALvoid *data, ALsizei size, ALsizei freq);
+
+#if defined(__cplusplus)
+}  /* extern "C" */
+#endif
+
+#endif
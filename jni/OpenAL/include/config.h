@@ -30,6 +30,17 @@
 #ifndef MAX_SOURCES_HIGH
 #define MAX_SOURCES_HIGH 64
 #endif
+
+// Vector mixers, checked for at runtime. ARMv7 builds compile mixer_neon.c
+// with NEON enabled
+#if defined(__ARM_ARCH_7A__)
+#define HAVE_NEON 1
+#endif
+#endif
+
+/* Define if we have SSE2 intrinsics */
+#if defined(__SSE2__)
+#define HAVE_SSE2 1
 #endif
 
 /* Define if we have the ALSA backend */
@@ -62,6 +73,9 @@
 /* Define if we have the stat function */
 #define HAVE_STAT 1
 
+/* Define if we have the mmap function */
+#define HAVE_MMAP 1
+
 /* Define if we have the powf function */
 #define HAVE_POWF 1
 
@@ -122,4 +136,10 @@
 /* Define if we have pthread_setschedparam() */
 #define HAVE_PTHREAD_SETSCHEDPARAM 1
 
+/* Define if we have malloc.h (for memalign) */
+#define HAVE_MALLOC_H 1
+
+/* Define if we have posix_memalign() */
+/* #cmakedefine HAVE_POSIX_MEMALIGN */
+
 #endif
@@ -0,0 +1 @@
+#include "AL/oalStaticBufferExtension.h"